@@ -0,0 +1,38 @@
+#!/bin/sh
+# Runs every benchmark script with each given interpreter and prints
+# the best wall-clock time out of RUNS runs
+# Usage: bench.sh <interpreter> [<interpreter>...]
+
+RUNS=${RUNS:-5}
+BENCH_DIR=$(dirname "$0")
+
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 <interpreter> [<interpreter>...]"
+    exit 1
+fi
+
+printf "%-16s" "script"
+for interpreter in "$@"; do
+    printf "%16s" "$(basename "$(dirname "$interpreter")")"
+done
+printf "\n"
+
+for script in "$BENCH_DIR"/*.pipou; do
+    printf "%-16s" "$(basename "$script" .pipou)"
+    for interpreter in "$@"; do
+        best=""
+        i=0
+        while [ $i -lt "$RUNS" ]; do
+            start=$(date +%s%N)
+            "$interpreter" "$script" > /dev/null || exit 1
+            end=$(date +%s%N)
+            elapsed=$(( (end - start) / 1000000 ))
+            if [ -z "$best" ] || [ $elapsed -lt "$best" ]; then
+                best=$elapsed
+            fi
+            i=$((i + 1))
+        done
+        printf "%13s ms" "$best"
+    done
+    printf "\n"
+done
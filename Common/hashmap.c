@@ -10,39 +10,31 @@
 #include "hashmap.h"
 #include "Common/include/error.h"
 #include "nanbox.h"
+#include "symbol.h"
 
 #define DEFAULT_INITIAL_CAPACITY 16
 #define LOAD_FACTOR 0.75
 
+pool_t hashmap_entry_pool = POOL_INITIALIZER("hashmap entries");
+
 /********************** HashMapEntry Functions ******************************/
 
 static hashmap_entry_t * HashMapEntry_New(char * key, nanbox_t value) {
-    hashmap_entry_t * entry = (hashmap_entry_t *)malloc(sizeof(hashmap_entry_t));
-    if (entry) {
-        entry->key = key;
-        entry->value = value;
-        entry->next = NULL;
-    } else {
-        Err_Throw(Err_New("Cannot allocate HashMap entry"));
-    }
+    hashmap_entry_t * entry = (hashmap_entry_t *)Pool_AllocBlock(&hashmap_entry_pool,
+                                                                 sizeof(hashmap_entry_t));
+    entry->key = key;
+    entry->value = value;
+    entry->next = NULL;
     return entry;
 }
 
 static void HashMapEntry_Free(hashmap_entry_t * entry) {
     if (!entry) Err_Throw(Err_New("NULL pointer to HashMap entry"));
-    free(entry);
+    Pool_FreeBlock(&hashmap_entry_pool, entry, sizeof(hashmap_entry_t));
 }
 
 /********************** HashMap Functions ******************************/
 
-static size_t HashMap_HashString(char * str) {
-    size_t hash = 5381, c;
-
-    while ((c = *str++)) hash = ((hash << 5) + hash) ^ c;
-
-    return hash;
-}
-
 static bool HashMap_OptimalSize(double count, double entries_count) {
     return count / entries_count <= LOAD_FACTOR;
 }
@@ -116,18 +108,36 @@ void HashMap_Free(hashmap_t * hashmap) {
     free(hashmap);
 }
 
+/**
+ * Retrieves the entry that stores a key, it stays valid until the key is
+ * removed or the hashmap grows
+ * @param[in] hashmap The hashmap to work on
+ * @param[in] key     The key of the (key, val) pair (a symbol)
+ * @retval The entry
+ * @retval NULL if the key is not in the hashmap
+ */
+hashmap_entry_t * HashMap_GetEntry(hashmap_t * hashmap, char * key) {
+    size_t index = Symbol_Hash(key) % hashmap->entries_count;
+    hashmap_entry_t * entry = hashmap->entries[index];
+
+    while (entry && entry->key != key) {
+        entry = entry->next;
+    }
+    return entry;
+}
+
 /**
  * @param[in]  hashmap The hashmap to work on
- * @param[in]  key     The key of the (key, val) pair
+ * @param[in]  key     The key of the (key, val) pair (a symbol)
  * @param[out] value   The stored value
  */
 bool HashMap_Get(hashmap_t * hashmap, char * key, nanbox_t * value) {
     bool found = false;
-    size_t index = HashMap_HashString(key) % hashmap->entries_count;
+    size_t index = Symbol_Hash(key) % hashmap->entries_count;
     hashmap_entry_t * entry = hashmap->entries[index];
     
     while (entry && !found) {
-        if (strcmp(key, entry->key) == 0) {
+        if (entry->key == key) {
             found = true;
             *value = entry->value;
         } else {
@@ -139,7 +149,7 @@ bool HashMap_Get(hashmap_t * hashmap, char * key, nanbox_t * value) {
 
 /**
  * @param[in] hashmap The hashmap to work on
- * @param[in] key     The key of the (key, val) pair
+ * @param[in] key     The key of the (key, val) pair (a symbol)
  * @param     value   The value to store
  */
 void HashMap_Set(hashmap_t * hashmap, char * key, nanbox_t value) {
@@ -149,13 +159,13 @@ void HashMap_Set(hashmap_t * hashmap, char * key, nanbox_t value) {
     if (!HashMap_OptimalSize(hashmap->count + 1, hashmap->entries_count)) {
         HashMap_Grow(hashmap);
     }
-    size_t index = HashMap_HashString(key) % hashmap->entries_count;
+    size_t index = Symbol_Hash(key) % hashmap->entries_count;
     cur = hashmap->entries[index];
     got_entries = !!cur;
     
     if (got_entries) {
         while (cur && !found) {
-            if (strcmp(key, cur->key) == 0) {
+            if (cur->key == key) {
                 found = true;
                 cur->value = value;
             } else {
@@ -175,12 +185,12 @@ void HashMap_Set(hashmap_t * hashmap, char * key, nanbox_t value) {
 
 void HashMap_Remove(hashmap_t * hashmap, char * key) {
     bool found = false;
-    size_t index = HashMap_HashString(key) % hashmap->entries_count;
+    size_t index = Symbol_Hash(key) % hashmap->entries_count;
     hashmap_entry_t * prev, * entry;
     prev = entry = hashmap->entries[index];
     
     while (entry && !found) {
-        if (strcmp(key, entry->key) == 0) {
+        if (entry->key == key) {
             found = true;
             if (prev == entry) {
                 hashmap->entries[index] = entry->next;
@@ -199,7 +209,7 @@ void HashMap_Remove(hashmap_t * hashmap, char * key) {
 /**
  * Checks if a (key, val) pair is present in a hashmap
  * @param[in] hashmap The hashmap to work on
- * @param[in] key     The key of the (key, val) pair
+ * @param[in] key     The key of the (key, val) pair (a symbol)
  * @returns           Whether the (key, val) pair is present
  */
 bool HashMap_Contains(hashmap_t * hashmap, char * key) {
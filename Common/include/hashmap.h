@@ -1,12 +1,15 @@
 /**
  * @file hashmap.h
  * Hash map implementation using NaN-boxing
+ * Keys are symbols (see Symbol_Intern) so they are compared by address
+ * and hashed once
  */
 #pragma once
 #include <sys/types.h>
 #include <stdbool.h>
 #include "nanbox.h"
 #include "vector.h"
+#include "pool.h"
 
 typedef struct hashmap_entry_s hashmap_entry_t;
 
@@ -26,6 +29,9 @@ typedef struct {
     size_t entries_count;
 } hashmap_t;
 
+/** Pool of the hashmap entries */
+extern pool_t hashmap_entry_pool;
+
 /**
  * Allocates an hashmap with a default capacity of 16
  * @returns The allocated hashmap
@@ -49,14 +55,24 @@ void HashMap_Free(hashmap_t * hashmap);
 
 /**
  * @param[in]  hashmap The hashmap to work on
- * @param[in]  key     The key of the (key, val) pair
+ * @param[in]  key     The key of the (key, val) pair (a symbol)
  * @param[out] value   The stored value
  */
 bool HashMap_Get(hashmap_t * hashmap, char * key, nanbox_t * value);
 
+/**
+ * Retrieves the entry that stores a key, it stays valid until the key is
+ * removed or the hashmap grows
+ * @param[in] hashmap The hashmap to work on
+ * @param[in] key     The key of the (key, val) pair (a symbol)
+ * @retval The entry
+ * @retval NULL if the key is not in the hashmap
+ */
+hashmap_entry_t * HashMap_GetEntry(hashmap_t * hashmap, char * key);
+
 /**
  * @param[in] hashmap The hashmap to work on
- * @param[in] key     The key of the (key, val) pair
+ * @param[in] key     The key of the (key, val) pair (a symbol)
  * @param     value   The value to store
  */
 void HashMap_Set(hashmap_t * hashmap, char * key, nanbox_t value);
@@ -64,14 +80,14 @@ void HashMap_Set(hashmap_t * hashmap, char * key, nanbox_t value);
 /**
  * Removes a (key, value) pair from a hashmap
  * @param[in] hashmap The hashmap to work on
- * @param[in] key     The key of the (key, val) pair
+ * @param[in] key     The key of the (key, val) pair (a symbol)
  */
 void HashMap_Remove(hashmap_t * hashmap, char * key);
 
 /**
  * Checks if a (key, val) pair is present in a hashmap
  * @param[in] hashmap The hashmap to work on
- * @param[in] key     The key of the (key, val) pair
+ * @param[in] key     The key of the (key, val) pair (a symbol)
  * @returns           Whether the (key, val) pair is present
  */
 bool HashMap_Contains(hashmap_t * hashmap, char * key);
@@ -0,0 +1,94 @@
+/**
+ * @file pool.h
+ * Size-class pool allocator: the small blocks are carved out of slabs and
+ * recycled through a free list per size class. A subsystem opts in by
+ * owning a pool and allocating its small structs from it
+ */
+#pragma once
+#include <stddef.h>
+
+/** The block sizes are rounded up to a multiple of this size */
+#define POOL_GRANULARITY 8
+
+/** Bigger blocks are allocated with malloc */
+#define POOL_MAX_BLOCK_SIZE 256
+
+#define POOL_CLASSES_COUNT (POOL_MAX_BLOCK_SIZE / POOL_GRANULARITY)
+
+/** Size of the slabs the blocks are carved out of, in bytes */
+#define POOL_SLAB_SIZE (16 * 1024)
+
+typedef struct pool_slab_s pool_slab_t;
+
+/**
+ * Statistics of a pool
+ */
+typedef struct {
+    /** Number of blocks allocated since the pool was created */
+    size_t allocations;
+    /** Number of blocks in use */
+    size_t live_blocks;
+    /** Size of the blocks in use, in bytes */
+    size_t live_bytes;
+    /** Number of blocks in use that were too big for the size classes */
+    size_t large_blocks;
+    /** Number of slabs */
+    size_t slabs;
+    /** Size of the slabs, in bytes */
+    size_t slab_bytes;
+} pool_stats_t;
+
+/**
+ * Blocks of a size class
+ */
+typedef struct {
+    /** Free blocks, each one starts with the address of the next one */
+    void * free_list;
+    /** Blocks of the last slab that were never allocated */
+    char * slab_top;
+    char * slab_end;
+} pool_class_t;
+
+/**
+ * Represents a pool, a zeroed pool is empty and ready to use
+ * (see POOL_INITIALIZER)
+ */
+typedef struct {
+    /** Name of the subsystem that owns the pool */
+    const char * name;
+    pool_class_t classes[POOL_CLASSES_COUNT];
+    /** Slabs of all the size classes */
+    pool_slab_t * slabs;
+    pool_stats_t stats;
+} pool_t;
+
+#define POOL_INITIALIZER(pool_name) { .name = (pool_name) }
+
+/**
+ * Allocates a block from a pool
+ * @param[in] pool The pool
+ * @param     size The size of the block
+ * @returns        The block
+ */
+void * Pool_AllocBlock(pool_t * pool, size_t size);
+
+/**
+ * Gives a block back to the pool it was allocated from
+ * @param[in] pool  The pool
+ * @param[in] block The block
+ * @param     size  The size given to Pool_AllocBlock
+ */
+void Pool_FreeBlock(pool_t * pool, void * block, size_t size);
+
+/**
+ * Frees the slabs of a pool, the blocks allocated from them must not be used anymore
+ * @param[in] pool The pool
+ */
+void Pool_Clear(pool_t * pool);
+
+/**
+ * Returns the statistics of a pool
+ * @param[in] pool The pool
+ * @returns        The statistics
+ */
+pool_stats_t Pool_GetStats(pool_t * pool);
@@ -0,0 +1,49 @@
+/**
+ * @file symbol.h
+ * Process-wide table of interned names
+ */
+#pragma once
+#include <sys/types.h>
+#include <stddef.h>
+
+typedef struct symbol_entry_s symbol_entry_t;
+
+/**
+ * Interned name, the symbol is the address of its characters
+ */
+typedef struct symbol_entry_s {
+    /** Next symbol in case of hash collision */
+    symbol_entry_t * next;
+    size_t hash;
+    char name[];
+} symbol_entry_t;
+
+/**
+ * Returns the unique copy of a name, two names are equal if and only if
+ * their symbols are the same pointer
+ * @param[in] name The name (a copy will be performed on its first use)
+ * @returns        The symbol (lives as long as the process, do not free it)
+ */
+char * Symbol_Intern(char * name);
+
+/**
+ * Returns the hash of a symbol, computed once when it was interned
+ * @param[in] symbol A symbol returned by Symbol_Intern
+ * @returns          The hash
+ */
+static inline size_t Symbol_Hash(char * symbol) {
+    return ((symbol_entry_t *)(symbol - offsetof(symbol_entry_t, name)))->hash;
+}
+
+/**
+ * Hashes a string
+ * @param[in] str The string
+ * @returns       The hash
+ */
+size_t Symbol_HashString(char * str);
+
+/**
+ * Returns the number of interned symbols
+ * @returns The number of symbols
+ */
+size_t Symbol_Count(void);
@@ -5,6 +5,7 @@
 #pragma once
 #include <sys/types.h>
 #include "nanbox.h"
+#include "pool.h"
 
 /**
  * Represents a vector
@@ -24,6 +25,9 @@ typedef struct {
     size_t increment_length;
 } vector_t;
 
+/** Pool of the vectors */
+extern pool_t vector_pool;
+
 /**
  * Allocates a new vector
  * @returns A pointer to the newly allocated vector
@@ -0,0 +1,118 @@
+/**
+ * @file pool.c
+ * Size-class pool allocator: the small blocks are carved out of slabs and
+ * recycled through a free list per size class. A subsystem opts in by
+ * owning a pool and allocating its small structs from it
+ */
+#include <stdlib.h>
+#include "pool.h"
+#include "Common/include/error.h"
+
+/** Header of a slab, its blocks follow */
+struct pool_slab_s {
+    pool_slab_t * next;
+};
+
+#define POOL_CLASS(size) (((size) + POOL_GRANULARITY - 1) / POOL_GRANULARITY - 1)
+#define POOL_CLASS_SIZE(class) (((class) + 1) * POOL_GRANULARITY)
+
+#ifndef POOL_MALLOC
+/**
+ * Allocates a slab for a size class
+ */
+static void Pool_Grow(pool_t * pool, pool_class_t * class) {
+    pool_slab_t * slab = (pool_slab_t *)malloc(POOL_SLAB_SIZE);
+
+    if (!slab) Err_Throw(Err_New("Cannot allocate pool slab"));
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->stats.slabs++;
+    pool->stats.slab_bytes += POOL_SLAB_SIZE;
+    class->slab_top = (char *)(slab + 1);
+    class->slab_end = (char *)slab + POOL_SLAB_SIZE;
+}
+#endif
+
+/**
+ * Allocates a block from a pool
+ * @param[in] pool The pool
+ * @param     size The size of the block
+ * @returns        The block
+ */
+void * Pool_AllocBlock(pool_t * pool, size_t size) {
+    void * block;
+
+    pool->stats.allocations++;
+    pool->stats.live_blocks++;
+    pool->stats.live_bytes += size;
+    if (size > POOL_MAX_BLOCK_SIZE) pool->stats.large_blocks++;
+#ifndef POOL_MALLOC
+    if (size > 0 && size <= POOL_MAX_BLOCK_SIZE) {
+        pool_class_t * class = &pool->classes[POOL_CLASS(size)];
+
+        if (class->free_list) {
+            block = class->free_list;
+            class->free_list = *(void **)block;
+            return block;
+        }
+        if ((size_t)(class->slab_end - class->slab_top) < POOL_CLASS_SIZE(POOL_CLASS(size))) {
+            Pool_Grow(pool, class);
+        }
+        block = class->slab_top;
+        class->slab_top += POOL_CLASS_SIZE(POOL_CLASS(size));
+        return block;
+    }
+#endif
+    block = malloc(size);
+    if (!block) Err_Throw(Err_New("Cannot allocate pool block"));
+    return block;
+}
+
+/**
+ * Gives a block back to the pool it was allocated from
+ * @param[in] pool  The pool
+ * @param[in] block The block
+ * @param     size  The size given to Pool_AllocBlock
+ */
+void Pool_FreeBlock(pool_t * pool, void * block, size_t size) {
+    pool->stats.live_blocks--;
+    pool->stats.live_bytes -= size;
+    if (size > POOL_MAX_BLOCK_SIZE) pool->stats.large_blocks--;
+#ifndef POOL_MALLOC
+    if (size > 0 && size <= POOL_MAX_BLOCK_SIZE) {
+        pool_class_t * class = &pool->classes[POOL_CLASS(size)];
+
+        *(void **)block = class->free_list;
+        class->free_list = block;
+        return;
+    }
+#endif
+    free(block);
+}
+
+/**
+ * Frees the slabs of a pool, the blocks allocated from them must not be used anymore
+ * @param[in] pool The pool
+ */
+void Pool_Clear(pool_t * pool) {
+    while (pool->slabs) {
+        pool_slab_t * slab = pool->slabs;
+
+        pool->slabs = slab->next;
+        free(slab);
+    }
+    for (size_t i = 0; i < POOL_CLASSES_COUNT; i++) {
+        pool->classes[i].free_list = NULL;
+        pool->classes[i].slab_top = pool->classes[i].slab_end = NULL;
+    }
+    pool->stats.slabs = pool->stats.slab_bytes = 0;
+}
+
+/**
+ * Returns the statistics of a pool
+ * @param[in] pool The pool
+ * @returns        The statistics
+ */
+pool_stats_t Pool_GetStats(pool_t * pool) {
+    return pool->stats;
+}
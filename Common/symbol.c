@@ -0,0 +1,86 @@
+/**
+ * @file symbol.c
+ * Process-wide table of interned names
+ */
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symbol.h"
+#include "Common/include/error.h"
+
+#define DEFAULT_INITIAL_CAPACITY 256
+#define LOAD_FACTOR 0.75
+
+static symbol_entry_t ** symbols = NULL;
+static size_t symbols_count = 0;
+static size_t symbols_capacity = 0;
+
+static void Symbol_Grow(void) {
+    size_t new_capacity = symbols_capacity ? symbols_capacity * 2 : DEFAULT_INITIAL_CAPACITY;
+    symbol_entry_t ** new_symbols = (symbol_entry_t **)calloc(new_capacity, sizeof(symbol_entry_t *));
+    symbol_entry_t * cur, * next;
+
+    if (!new_symbols) Err_Throw(Err_New("Cannot grow symbols table"));
+    for (size_t i = 0; i < symbols_capacity; i++) {
+        for (cur = symbols[i]; cur; cur = next) {
+            next = cur->next;
+            cur->next = new_symbols[cur->hash % new_capacity];
+            new_symbols[cur->hash % new_capacity] = cur;
+        }
+    }
+    free(symbols);
+    symbols = new_symbols;
+    symbols_capacity = new_capacity;
+}
+
+/**
+ * Hashes a string
+ * @param[in] str The string
+ * @returns       The hash
+ */
+size_t Symbol_HashString(char * str) {
+    size_t hash = 5381, c;
+
+    while ((c = *str++)) hash = ((hash << 5) + hash) ^ c;
+
+    return hash;
+}
+
+/**
+ * Returns the unique copy of a name, two names are equal if and only if
+ * their symbols are the same pointer
+ * @param[in] name The name (a copy will be performed on its first use)
+ * @returns        The symbol (lives as long as the process, do not free it)
+ */
+char * Symbol_Intern(char * name) {
+    size_t hash = Symbol_HashString(name);
+    size_t length;
+    symbol_entry_t * entry;
+
+    if (symbols_capacity) {
+        for (entry = symbols[hash % symbols_capacity]; entry; entry = entry->next) {
+            if (entry->hash == hash && strcmp(entry->name, name) == 0) return entry->name;
+        }
+    }
+    if ((double)(symbols_count + 1) > symbols_capacity * LOAD_FACTOR) {
+        Symbol_Grow();
+    }
+
+    length = strlen(name);
+    entry = (symbol_entry_t *)malloc(sizeof(symbol_entry_t) + length + 1);
+    if (!entry) Err_Throw(Err_New("Cannot allocate symbol"));
+    entry->hash = hash;
+    memcpy(entry->name, name, length + 1);
+    entry->next = symbols[hash % symbols_capacity];
+    symbols[hash % symbols_capacity] = entry;
+    symbols_count++;
+    return entry->name;
+}
+
+/**
+ * Returns the number of interned symbols
+ * @returns The number of symbols
+ */
+size_t Symbol_Count(void) {
+    return symbols_count;
+}
@@ -11,6 +11,8 @@
 
 #define INCREMENT_LENGTH 50
 
+pool_t vector_pool = POOL_INITIALIZER("vectors");
+
 /**
  * Tests if an index is in the bounds of a vector
  * @private
@@ -55,15 +57,11 @@ static void Vec_Grow(vector_t * vector) {
  * @returns A pointer to the newly allocated vector
  */
 vector_t * Vec_New() {
-    vector_t * vector = (vector_t *)malloc(sizeof(vector_t));
+    vector_t * vector = (vector_t *)Pool_AllocBlock(&vector_pool, sizeof(vector_t));
 
-    if (vector) {
-        vector->length = vector->max_length = 0;
-        vector->buffer = NULL;
-        vector->increment_length = INCREMENT_LENGTH;
-    } else {
-        Err_Throw(Err_New("Cannot allocate vector"));
-    }
+    vector->length = vector->max_length = 0;
+    vector->buffer = NULL;
+    vector->increment_length = INCREMENT_LENGTH;
     return vector;
 }
 
@@ -86,7 +84,7 @@ vector_t * Vec_NewWithIncrementLength(size_t increment_length) {
 void Vec_Free(vector_t * vector) {
     if (vector) {
         if (vector->buffer) free(vector->buffer);
-        free(vector);
+        Pool_FreeBlock(&vector_pool, vector, sizeof(vector_t));
     }
 }
 
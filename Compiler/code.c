@@ -0,0 +1,375 @@
+/**
+ * @file code.c
+ * Compiled code implementation
+ */
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "code.h"
+#include "opcodes.h"
+#include "object.h"
+#include "stringobject.h"
+#include "vector.h"
+#include "nanbox.h"
+#include "str.h"
+#include "symbol.h"
+#include "Common/include/error.h"
+
+#define INITIAL_CAPACITY 64
+
+static void Code_FreeInnerCode(nanbox_t inner) {
+    Code_Free(nanbox_to_pointer(inner));
+}
+
+static void Code_EmitByte(code_t * code, uint8_t byte) {
+    if (code->length == code->capacity) {
+        size_t new_capacity = code->capacity ? code->capacity * 2 : INITIAL_CAPACITY;
+        uint8_t * buf = realloc(code->bytecode, new_capacity);
+        if (!buf) Err_Throw(Err_New("Cannot grow bytecode"));
+        code->bytecode = buf;
+        code->capacity = new_capacity;
+    }
+    code->bytecode[code->length++] = byte;
+}
+
+/**
+ * Allocates a new code unit
+ * @param     kind The kind of code
+ * @param[in] name The name of the unit (a copy will be performed)
+ * @returns        The newly allocated code unit
+ */
+code_t * Code_New(code_kind_t kind, char * name) {
+    code_t * code = (code_t *)malloc(sizeof(code_t));
+
+    if (code) {
+        code->kind = kind;
+        code->name = strdup(name);
+        code->bytecode = NULL;
+        code->length = 0;
+        code->capacity = 0;
+        code->constants = Vec_NewWithIncrementLength(8);
+        code->names = Vec_NewWithIncrementLength(8);
+        code->codes = Vec_NewWithIncrementLength(4);
+        code->params_count = 0;
+        code->locals_count = 0;
+        code->needs_context = false;
+        code->frame_blocks_count = 0;
+        code->captured_depth = 0;
+        code->caches = NULL;
+        code->caches_count = 0;
+        code->lines = Vec_NewWithIncrementLength(16);
+        code->filename = NULL;
+    } else {
+        Err_Throw(Err_New("Cannot allocate code"));
+    }
+    return code;
+}
+
+/**
+ * Frees a code unit, its constants and its inner code units
+ * @param[in] code The code unit to free
+ */
+void Code_Free(code_t * code) {
+    if (!code) Err_Throw(Err_New("NULL pointer to code"));
+    Vec_Free(code->constants);
+    Vec_Free(code->names);
+    Vec_ForEach(code->codes, Code_FreeInnerCode);
+    Vec_Free(code->codes);
+    free(code->caches);
+    Vec_Free(code->lines);
+    free(code->filename);
+    free(code->bytecode);
+    free(code->name);
+    free(code);
+}
+
+/**
+ * Appends an instruction
+ * @param[in] code     The code unit
+ * @param     opcode   The instruction opcode
+ * @param     operands The operands (opcode_operands[opcode] of them)
+ * @returns            The offset of the instruction
+ */
+size_t Code_Emit(code_t * code, opcode_t opcode, ...) {
+    size_t offset = code->length;
+    va_list operands;
+
+    Code_EmitByte(code, opcode);
+    va_start(operands, opcode);
+    for (size_t i = 0; i < opcode_operands[opcode]; i++) {
+        unsigned int operand = va_arg(operands, unsigned int);
+        Code_EmitByte(code, operand & 0xff);
+        Code_EmitByte(code, (operand >> 8) & 0xff);
+    }
+    va_end(operands);
+    return offset;
+}
+
+/**
+ * Sets the source location of the next emitted instructions
+ * @param[in] code The code unit
+ * @param     loc  The location (ignored if its line is 0)
+ */
+void Code_SetLocation(code_t * code, loc_t loc) {
+    size_t count = Vec_GetLength(code->lines);
+
+    if (!loc.line) return;
+    if (!code->filename && loc.filename) code->filename = strdup(loc.filename);
+    if (count && (size_t)nanbox_to_int(Vec_GetAt(code->lines, count - 1)) == loc.line) return;
+    // no instruction was emitted for the previous line
+    if (count && (size_t)nanbox_to_int(Vec_GetAt(code->lines, count - 2)) == code->length) {
+        Vec_SetAt(code->lines, count - 1, nanbox_from_int(loc.line));
+        return;
+    }
+    Vec_Append(code->lines, nanbox_from_int(code->length));
+    Vec_Append(code->lines, nanbox_from_int(loc.line));
+}
+
+/**
+ * Finds the source line of an instruction
+ * @param[in] code   The code unit
+ * @param     offset The offset of the instruction, or of one of its operands
+ * @returns          The line or 0 if unknown
+ */
+size_t Code_GetLine(code_t * code, size_t offset) {
+    size_t line = 0;
+
+    for (size_t i = 0; i < Vec_GetLength(code->lines); i += 2) {
+        if ((size_t)nanbox_to_int(Vec_GetAt(code->lines, i)) > offset) break;
+        line = nanbox_to_int(Vec_GetAt(code->lines, i + 1));
+    }
+    return line;
+}
+
+/**
+ * Overwrites an operand of an already emitted instruction
+ * @param[in] code    The code unit
+ * @param     offset  Offset of the instruction
+ * @param     index   Index of the operand
+ * @param     operand The new value of the operand
+ */
+void Code_PatchOperand(code_t * code, size_t offset, size_t index, uint16_t operand) {
+    code->bytecode[offset + 1 + index * 2] = operand & 0xff;
+    code->bytecode[offset + 2 + index * 2] = (operand >> 8) & 0xff;
+}
+
+/**
+ * Reads an operand of an instruction
+ * @param[in] code   The code unit
+ * @param     offset Offset of the instruction
+ * @param     index  Index of the operand
+ * @returns          The operand
+ */
+uint16_t Code_GetOperand(code_t * code, size_t offset, size_t index) {
+    return code->bytecode[offset + 1 + index * 2]
+        | (code->bytecode[offset + 2 + index * 2] << 8);
+}
+
+/**
+ * Computes the size of an instruction
+ * @param opcode The instruction opcode
+ * @returns      The size of the instruction and its operands in bytes
+ */
+size_t Code_InstructionSize(opcode_t opcode) {
+    return 1 + opcode_operands[opcode] * 2;
+}
+
+/**
+ * Rewrites the first instruction of each sequence declared as a
+ * superinstruction, the longest sequence wins. The other instructions
+ * are left in place so the offsets and jump targets don't change
+ * @param[in] code The code unit (inner code units are not rewritten)
+ */
+void Code_FuseSuperinstructions(code_t * code) {
+    size_t count = 0;
+    size_t * offsets = (size_t *)malloc((code->length + 1) * sizeof(size_t));
+
+    if (!offsets) Err_Throw(Err_New("Cannot allocate instruction offsets"));
+    for (size_t offset = 0; offset < code->length; offset += Code_InstructionSize(code->bytecode[offset])) {
+        offsets[count++] = offset;
+    }
+    // the sequences are matched on the original opcodes, the ones that
+    // follow an instruction are not rewritten yet
+    for (size_t i = 0; i < count; i++) {
+        superinstruction_t * best = NULL;
+
+        for (size_t j = 0; j < superinstructions_count; j++) {
+            superinstruction_t * candidate = &superinstructions[j];
+            size_t k = 0;
+
+            if (i + candidate->length > count) continue;
+            if (best && best->length >= candidate->length) continue;
+            while (k < candidate->length && code->bytecode[offsets[i + k]] == candidate->components[k]) {
+                k++;
+            }
+            if (k == candidate->length) best = candidate;
+        }
+        if (best) code->bytecode[offsets[i]] = best->opcode;
+    }
+    free(offsets);
+}
+
+/**
+ * Adds a value to the constant pool, identical numbers are shared
+ * @param[in] code  The code unit
+ * @param     value The value
+ * @returns         The index of the constant
+ */
+size_t Code_AddConstant(code_t * code, nanbox_t value) {
+    if (!nanbox_is_pointer(value)) {
+        for (size_t i = 0; i < Vec_GetLength(code->constants); i++) {
+            if (Vec_GetAt(code->constants, i).as_int64 == value.as_int64) {
+                return i;
+            }
+        }
+    }
+    Vec_Append(code->constants, value);
+    return Vec_GetLength(code->constants) - 1;
+}
+
+/**
+ * Adds a name to the names pool, identical names are shared
+ * @param[in] code The code unit
+ * @param[in] name The name (it will be interned)
+ * @returns        The index of the name
+ */
+size_t Code_AddName(code_t * code, char * name) {
+    char * symbol = Symbol_Intern(name);
+
+    for (size_t i = 0; i < Vec_GetLength(code->names); i++) {
+        if (Code_GetName(code, i) == symbol) {
+            return i;
+        }
+    }
+    Vec_Append(code->names, nanbox_from_pointer(symbol));
+    return Vec_GetLength(code->names) - 1;
+}
+
+/**
+ * Adds an inner code unit
+ * @param[in] code  The code unit
+ * @param[in] inner The inner code unit (ownership is transfered)
+ * @returns         The index of the inner code unit
+ */
+size_t Code_AddCode(code_t * code, code_t * inner) {
+    Vec_Append(code->codes, nanbox_from_pointer(inner));
+    return Vec_GetLength(code->codes) - 1;
+}
+
+/**
+ * Adds an empty lookup cache for a message send or field access site
+ * @param[in] code The code unit
+ * @returns        The index of the cache
+ */
+size_t Code_AddCache(code_t * code) {
+    inline_cache_t * caches = realloc(code->caches, (code->caches_count + 1) * sizeof(inline_cache_t));
+
+    if (!caches) Err_Throw(Err_New("Cannot grow inline caches"));
+    code->caches = caches;
+    caches[code->caches_count].count = 0;
+    caches[code->caches_count].megamorphic = false;
+    return code->caches_count++;
+}
+
+/**
+ * Retrieves a name from the names pool
+ * @param[in] code  The code unit
+ * @param     index The index of the name
+ * @returns         The name (a symbol)
+ */
+char * Code_GetName(code_t * code, size_t index) {
+    return nanbox_to_pointer(Vec_GetAt(code->names, index));
+}
+
+static void Code_DisassembleConstant(code_t * code, size_t index, char * buf, size_t size) {
+    nanbox_t constant = Vec_GetAt(code->constants, index);
+
+    if (nanbox_is_int(constant)) {
+        snprintf(buf, size, "%d", nanbox_to_int(constant));
+    } else if (nanbox_is_double(constant)) {
+        snprintf(buf, size, "%g", nanbox_to_double(constant));
+    } else if (StringObject_Check(constant)) {
+        snprintf(buf, size, "\"%s\"", StringObject_GetValue(constant));
+    } else {
+        snprintf(buf, size, "?");
+    }
+}
+
+static string * Code_DisassembleIndent(code_t * code, size_t indent) {
+    #define APPEND_FREE(str1, str2) Str_Append(str1, str2);Str_Free(str2)
+    string * str, * str2;
+    char buf[256], operand_buf[128];
+    size_t offset = 0;
+
+    snprintf(buf, 256, "%*s%s <%s> params=%ld locals=%ld%s\n", (int)indent, "",
+            code->kind == CODE_CHUNK ? "Chunk" : code->kind == CODE_BLOCK ? "Block" : "Method",
+            code->name, code->params_count, code->locals_count,
+            code->needs_context ? " context" : "");
+    str = Str_New(buf);
+
+    while (offset < code->length) {
+        opcode_t opcode = code->bytecode[offset];
+
+        operand_buf[0] = '\0';
+        switch (opcode) {
+            case OP_PUSH_CONST:
+                Code_DisassembleConstant(code, Code_GetOperand(code, offset, 0), operand_buf, 128);
+                break;
+            case OP_LOAD_GLOBAL:
+            case OP_STORE_GLOBAL:
+            case OP_DECL_GLOBAL:
+            case OP_INIT_FIELD:
+            case OP_GET_FIELD:
+            case OP_SET_FIELD:
+            case OP_SEND:
+            case OP_SEND_BLOCKS:
+            case OP_SEND_R0:
+            case OP_SEND_R1:
+            case OP_SEND_R2:
+                snprintf(operand_buf, 128, "'%s'", Code_GetName(code, Code_GetOperand(code, offset, 0)));
+                break;
+            case OP_MAKE_BLOCK:
+            case OP_MAKE_FRAME_BLOCK:
+                snprintf(operand_buf, 128, "<%s>", ((code_t *)nanbox_to_pointer(
+                        Vec_GetAt(code->codes, Code_GetOperand(code, offset, 0))))->name);
+                break;
+            default:
+                break;
+        }
+
+        snprintf(buf, 256, "%*s%04ld %-22s", (int)indent + 4, "", offset, opcode_names[opcode] + 3);
+        str2 = Str_New(buf);
+        APPEND_FREE(str, str2);
+        for (size_t i = 0; i < opcode_operands[opcode]; i++) {
+            snprintf(buf, 256, " %d", Code_GetOperand(code, offset, i));
+            str2 = Str_New(buf);
+            APPEND_FREE(str, str2);
+        }
+        if (operand_buf[0]) {
+            snprintf(buf, 256, " (%s)", operand_buf);
+            str2 = Str_New(buf);
+            APPEND_FREE(str, str2);
+        }
+        str2 = Str_New("\n");
+        APPEND_FREE(str, str2);
+        offset += Code_InstructionSize(opcode);
+    }
+
+    for (size_t i = 0; i < Vec_GetLength(code->codes); i++) {
+        str2 = Code_DisassembleIndent(nanbox_to_pointer(Vec_GetAt(code->codes, i)), indent + 4);
+        APPEND_FREE(str, str2);
+    }
+    #undef APPEND_FREE
+
+    return str;
+}
+
+/**
+ * Builds a human readable listing of the code and of its inner code units
+ * @param[in] code The code unit
+ * @returns        The listing
+ */
+string * Code_Disassemble(code_t * code) {
+    return Code_DisassembleIndent(code, 0);
+}
@@ -0,0 +1,995 @@
+/**
+ * @file compiler.c
+ * Bytecode compiler implementation
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "compiler.h"
+#include "code.h"
+#include "opcodes.h"
+#include "ast.h"
+#include "tokens.h"
+#include "vector.h"
+#include "nanbox.h"
+#include "str.h"
+#include "stringobject.h"
+#include "Common/include/error.h"
+
+#define THIS_IDENT  "this"
+#define TRUE_IDENT  "True"
+#define FALSE_IDENT "False"
+#define NULL_IDENT  "Null"
+
+/**
+ * Messages whose builtin implementations only call the blocks they receive,
+ * the block litterals given to them can be created in the frame of the sender
+ */
+static const char * frame_block_selectors[] = {
+    "ifTrue", "ifFalse", "ifTrue:ifFalse", "ifFalse:ifTrue", "and", "or",
+    "whileTrue", "whileFalse", "to:do", "timesRepeat", "do", "detect"
+};
+
+static void Compiler_CompileNode(compiler_t * compiler, ast_node_t * node);
+static void Compiler_CompileStatements(compiler_t * compiler, vector_t * statements);
+
+static void Compiler_SetError(compiler_t * compiler, char * message) {
+    if (compiler->status == COMPILER_OK) {
+        compiler->status = COMPILER_ERROR;
+        compiler->error = Err_New(message);
+    }
+}
+
+static ast_node_t * Compiler_GetNode(vector_t * nodes, size_t index) {
+    return nanbox_to_pointer(Vec_GetAt(nodes, index));
+}
+
+/**
+ * Checks that an index fits in an instruction operand
+ */
+static size_t Compiler_CheckOperand(compiler_t * compiler, size_t operand, char * message) {
+    if (operand > CODE_MAX_OPERAND) {
+        Compiler_SetError(compiler, message);
+        operand = 0;
+    }
+    return operand;
+}
+
+static size_t Compiler_AddName(compiler_t * compiler, char * name) {
+    return Compiler_CheckOperand(compiler, Code_AddName(compiler->unit->code, name),
+                                 "Too many names in a single block");
+}
+
+static size_t Compiler_AddCache(compiler_t * compiler) {
+    return Compiler_CheckOperand(compiler, Code_AddCache(compiler->unit->code),
+                                 "Too many messages in a single block");
+}
+
+static size_t Compiler_AddConstant(compiler_t * compiler, nanbox_t value) {
+    return Compiler_CheckOperand(compiler, Code_AddConstant(compiler->unit->code, value),
+                                 "Too many constants in a single block");
+}
+
+/**
+ * Emits a jump whose target will be patched later
+ * @returns The offset of the jump instruction
+ */
+static size_t Compiler_EmitJump(compiler_t * compiler, opcode_t opcode) {
+    return Code_Emit(compiler->unit->code, opcode, 0);
+}
+
+/**
+ * Makes a previously emitted jump target the current offset
+ */
+static void Compiler_PatchJump(compiler_t * compiler, size_t jump_offset) {
+    size_t target = Compiler_CheckOperand(compiler, compiler->unit->code->length,
+                                          "Block too large");
+    Code_PatchOperand(compiler->unit->code, jump_offset, 0, target);
+}
+
+/********************** Units and variables ******************************/
+
+static void Compiler_PushUnit(compiler_t * compiler, code_kind_t kind, char * name) {
+    compiler_unit_t * unit = (compiler_unit_t *)malloc(sizeof(compiler_unit_t));
+
+    if (!unit) Err_Throw(Err_New("Cannot allocate compiler unit"));
+    unit->code = Code_New(kind, name);
+    unit->parent = compiler->unit;
+    unit->locals = Vec_NewWithIncrementLength(8);
+    unit->in_frame = false;
+    unit->temps = Vec_NewWithIncrementLength(4);
+    unit->temps_used = 0;
+    compiler->unit = unit;
+}
+
+/**
+ * Pops the current unit
+ * @returns The code of the unit
+ */
+static code_t * Compiler_PopUnit(compiler_t * compiler) {
+    compiler_unit_t * unit = compiler->unit;
+    code_t * code = unit->code;
+
+    code->locals_count = Vec_GetLength(unit->locals);
+    if (compiler->superinstructions) Code_FuseSuperinstructions(code);
+    compiler->unit = unit->parent;
+    Vec_Free(unit->locals);
+    Vec_Free(unit->temps);
+    free(unit);
+    return code;
+}
+
+static ssize_t Compiler_FindLocal(compiler_unit_t * unit, char * name) {
+    // identifiers are symbols
+    for (ssize_t i = Vec_GetLength(unit->locals) - 1; i >= 0; i--) {
+        if (nanbox_to_pointer(Vec_GetAt(unit->locals, i)) == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static size_t Compiler_DeclareLocal(compiler_t * compiler, char * name) {
+    ssize_t slot = Compiler_FindLocal(compiler->unit, name);
+
+    if (slot < 0) {
+        Vec_Append(compiler->unit->locals, nanbox_from_pointer(name));
+        slot = Vec_GetLength(compiler->unit->locals) - 1;
+    }
+    return Compiler_CheckOperand(compiler, slot, "Too many local variables in a single block");
+}
+
+/**
+ * Checks if the units between a block and an enclosing one are all frame
+ * blocks, such blocks reach the variables in the frames that created them
+ * @param depth Number of units between the block and the enclosing one
+ */
+static bool Compiler_InFramePath(compiler_unit_t * unit, size_t depth) {
+    for (size_t i = 0; i < depth; i++, unit = unit->parent) {
+        if (!unit->in_frame) return false;
+    }
+    return true;
+}
+
+/**
+ * Resolves a variable in the enclosing units
+ * @param[out] depth Number of units between the current one and the one
+ *                   that declares the variable
+ * @returns          The slot of the variable or -1 if it's a global one
+ */
+static ssize_t Compiler_ResolveVariable(compiler_t * compiler, char * name, size_t * depth) {
+    compiler_unit_t * unit = compiler->unit;
+    ssize_t slot = -1;
+
+    *depth = 0;
+    while (unit && unit->code->kind != CODE_CHUNK) {
+        slot = Compiler_FindLocal(unit, name);
+        if (slot >= 0) break;
+        unit = unit->parent;
+        (*depth)++;
+    }
+    if (slot >= 0 && *depth > 0) {
+        compiler_unit_t * inner = compiler->unit;
+        for (size_t i = 0; i < *depth; i++, inner = inner->parent) {
+            if (inner->code->captured_depth < *depth - i) {
+                inner->code->captured_depth = *depth - i;
+            }
+        }
+    }
+    if (slot >= 0 && *depth > 0 && !Compiler_InFramePath(compiler->unit, *depth)) {
+        // every unit between the block and the declaration must keep
+        // its variables in a context so the block can reach them
+        compiler_unit_t * outer = compiler->unit->parent;
+        for (size_t i = 0; i < *depth; i++, outer = outer->parent) {
+            outer->code->needs_context = true;
+        }
+    }
+    return slot;
+}
+
+static void Compiler_EmitLoadVariable(compiler_t * compiler, char * name) {
+    code_t * code = compiler->unit->code;
+    size_t depth;
+    ssize_t slot;
+
+    if (strcmp(name, THIS_IDENT) == 0) {
+        Code_Emit(code, OP_PUSH_THIS);
+    } else if (strcmp(name, TRUE_IDENT) == 0) {
+        Code_Emit(code, OP_PUSH_TRUE);
+    } else if (strcmp(name, FALSE_IDENT) == 0) {
+        Code_Emit(code, OP_PUSH_FALSE);
+    } else if (strcmp(name, NULL_IDENT) == 0) {
+        Code_Emit(code, OP_PUSH_NULL);
+    } else {
+        slot = Compiler_ResolveVariable(compiler, name, &depth);
+        if (slot < 0) {
+            Code_Emit(code, OP_LOAD_GLOBAL, Compiler_AddName(compiler, name));
+        } else if (depth == 0) {
+            Code_Emit(code, OP_LOAD_LOCAL, slot);
+        } else {
+            Code_Emit(code, OP_LOAD_CAPTURED, depth, slot);
+        }
+    }
+}
+
+static bool Compiler_IsReservedName(char * name) {
+    return strcmp(name, THIS_IDENT) == 0 || strcmp(name, TRUE_IDENT) == 0
+        || strcmp(name, FALSE_IDENT) == 0 || strcmp(name, NULL_IDENT) == 0;
+}
+
+static void Compiler_EmitStoreVariable(compiler_t * compiler, char * name) {
+    code_t * code = compiler->unit->code;
+    size_t depth;
+    ssize_t slot;
+
+    if (Compiler_IsReservedName(name)) {
+        char buf[256];
+        snprintf(buf, 256, "Cannot assign a value to '%s'", name);
+        Compiler_SetError(compiler, buf);
+        return;
+    }
+    slot = Compiler_ResolveVariable(compiler, name, &depth);
+    if (slot < 0) {
+        Code_Emit(code, OP_STORE_GLOBAL, Compiler_AddName(compiler, name));
+    } else if (depth == 0) {
+        Code_Emit(code, OP_STORE_LOCAL, slot);
+    } else {
+        Code_Emit(code, OP_STORE_CAPTURED, depth, slot);
+    }
+}
+
+/********************** Names ******************************/
+
+/**
+ * Builds the name of a field from an ast_obj_field_name_t
+ * (#sub:to gives "sub:to")
+ * @returns An allocated string
+ */
+static string * Compiler_FieldName(ast_node_t * node) {
+    vector_t * components = node->as_obj_field_name.components;
+    string * name = Str_New(""), * str;
+
+    for (size_t i = 0; i < Vec_GetLength(components); i++) {
+        if (i > 0) {
+            str = Str_New(":");
+            Str_Append(name, str);
+            Str_Free(str);
+        }
+        str = Str_New(Compiler_GetNode(components, i)->as_ident.value);
+        Str_Append(name, str);
+        Str_Free(str);
+    }
+    return name;
+}
+
+/**
+ * Builds a selector from the identifiers at even (or odd) positions
+ * of a vector of nodes (foo: a bar: b gives "foo:bar")
+ * @returns An allocated string
+ */
+static string * Compiler_Selector(vector_t * nodes, size_t first, size_t step) {
+    string * selector = Str_New(""), * str;
+
+    for (size_t i = first; i < Vec_GetLength(nodes); i += step) {
+        if (i > first) {
+            str = Str_New(":");
+            Str_Append(selector, str);
+            Str_Free(str);
+        }
+        str = Str_New(Compiler_GetNode(nodes, i)->as_ident.value);
+        Str_Append(selector, str);
+        Str_Free(str);
+    }
+    return selector;
+}
+
+/********************** Registers ******************************/
+
+/** Name of the slots of the temporaries, it never matches a symbol */
+static char temp_name[] = "(temp)";
+
+static opcode_t Compiler_BinaryOpcode(token_type_t op) {
+    switch (op) {
+        case TOKTYPE_PLUS:     return OP_ADD;
+        case TOKTYPE_MINUS:    return OP_SUB;
+        case TOKTYPE_STAR:     return OP_MUL;
+        case TOKTYPE_SLASH:    return OP_DIV;
+        case TOKTYPE_EQEQUAL:  return OP_EQ;
+        case TOKTYPE_NOTEQUAL: return OP_NE;
+        case TOKTYPE_LOWER:    return OP_LT;
+        case TOKTYPE_GREATER:  return OP_GT;
+        case TOKTYPE_LEQUAL:   return OP_LE;
+        case TOKTYPE_GEQUAL:   return OP_GE;
+        default:               return OP_NOP;
+    }
+}
+
+static opcode_t Compiler_RegisterOpcode(opcode_t opcode) {
+    switch (opcode) {
+        case OP_ADD: return OP_ADD_R;
+        case OP_SUB: return OP_SUB_R;
+        case OP_MUL: return OP_MUL_R;
+        case OP_DIV: return OP_DIV_R;
+        case OP_EQ:  return OP_EQ_R;
+        case OP_NE:  return OP_NE_R;
+        case OP_LT:  return OP_LT_R;
+        case OP_GT:  return OP_GT_R;
+        case OP_LE:  return OP_LE_R;
+        case OP_GE:  return OP_GE_R;
+        default:     return OP_NOP;
+    }
+}
+
+static bool Compiler_IsBinaryExpr(ast_node_t * node) {
+    return node->type == NODE_EQ_EXPR || node->type == NODE_COMP_EXPR
+        || node->type == NODE_ARITH_EXPR || node->type == NODE_TERM_EXPR
+        || node->type == NODE_FACTOR_EXPR;
+}
+
+static token_type_t Compiler_BinaryOperator(ast_node_t * node) {
+    // term_expr and factor_expr have only one possible operator
+    if (node->type == NODE_TERM_EXPR) return TOKTYPE_STAR;
+    if (node->type == NODE_FACTOR_EXPR) return TOKTYPE_SLASH;
+    return node->as_expr.op;
+}
+
+/**
+ * Allocates a temporary slot, the temporaries are reused by the next statement
+ */
+static size_t Compiler_NewTemp(compiler_t * compiler) {
+    compiler_unit_t * unit = compiler->unit;
+    size_t slot;
+
+    if (unit->temps_used == Vec_GetLength(unit->temps)) {
+        Vec_Append(unit->locals, nanbox_from_pointer(temp_name));
+        Vec_Append(unit->temps, nanbox_from_int(Vec_GetLength(unit->locals) - 1));
+    }
+    slot = nanbox_to_int(Vec_GetAt(unit->temps, unit->temps_used++));
+    if (slot >= CODE_REGISTER_CONSTANT) {
+        Compiler_SetError(compiler, "Too many local variables in a single block");
+        slot = 0;
+    }
+    return slot;
+}
+
+/**
+ * Indicates whether a node can be an operand of a register instruction:
+ * a local variable of the current unit, a litteral or a reserved name
+ */
+static bool Compiler_IsRegisterOperand(compiler_t * compiler, ast_node_t * node) {
+    ssize_t slot;
+
+    switch (node->type) {
+        case NODE_INT:
+        case NODE_DOUBLE:
+        case NODE_STRING:
+            return true;
+        case NODE_IDENTIFIER:
+            if (Compiler_IsReservedName(node->as_ident.value)) return true;
+            // the variables of a chunk are globals
+            if (compiler->unit->code->kind == CODE_CHUNK) return false;
+            slot = Compiler_FindLocal(compiler->unit, node->as_ident.value);
+            return slot >= 0 && slot < CODE_REGISTER_CONSTANT;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Returns the register operand of a node accepted by Compiler_IsRegisterOperand
+ */
+static size_t Compiler_RegisterOperand(compiler_t * compiler, ast_node_t * node) {
+    char * name;
+    nanbox_t value;
+    size_t index;
+
+    switch (node->type) {
+        case NODE_INT:
+            value = nanbox_from_int(node->as_int.value);
+            break;
+        case NODE_DOUBLE:
+            value = nanbox_from_double(node->as_double.value);
+            break;
+        case NODE_STRING:
+            value = StringObject_New(node->as_string.value);
+            break;
+        default:
+            name = node->as_ident.value;
+            if (strcmp(name, THIS_IDENT) == 0) return CODE_REGISTER_THIS;
+            if (strcmp(name, TRUE_IDENT) == 0) value = nanbox_true();
+            else if (strcmp(name, FALSE_IDENT) == 0) value = nanbox_false();
+            else if (strcmp(name, NULL_IDENT) == 0) value = nanbox_null();
+            else return Compiler_FindLocal(compiler->unit, name);
+            break;
+    }
+    index = Compiler_AddConstant(compiler, value);
+    if (index >= CODE_REGISTER_THIS - CODE_REGISTER_CONSTANT) {
+        Compiler_SetError(compiler, "Too many constants in a single block");
+        index = 0;
+    }
+    return index | CODE_REGISTER_CONSTANT;
+}
+
+/**
+ * Indicates whether an expression only applies binary operators to
+ * register operands
+ */
+static bool Compiler_IsRegisterExpr(compiler_t * compiler, ast_node_t * node) {
+    if (!Compiler_IsBinaryExpr(node)) {
+        return Compiler_IsRegisterOperand(compiler, node);
+    }
+    if (Compiler_BinaryOpcode(Compiler_BinaryOperator(node)) == OP_NOP) return false;
+    for (size_t i = 0; i < Vec_GetLength(node->as_expr.values); i++) {
+        if (!Compiler_IsRegisterExpr(compiler, Compiler_GetNode(node->as_expr.values, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Compiles an expression accepted by Compiler_IsRegisterExpr
+ * @param dst Slot that receives the value, or -1 to leave it where it is
+ *            (in a variable, a constant or a temporary)
+ * @returns   The register operand that holds the value
+ */
+static size_t Compiler_CompileRegisterExpr(compiler_t * compiler, ast_node_t * node, ssize_t dst) {
+    code_t * code = compiler->unit->code;
+    vector_t * values;
+    size_t value, operand, target;
+    opcode_t opcode;
+
+    if (!Compiler_IsBinaryExpr(node)) {
+        operand = Compiler_RegisterOperand(compiler, node);
+        if (dst < 0) return operand;
+        Code_Emit(code, OP_MOVE, dst, operand);
+        return dst;
+    }
+    values = node->as_expr.values;
+    opcode = Compiler_RegisterOpcode(Compiler_BinaryOpcode(Compiler_BinaryOperator(node)));
+    value = Compiler_CompileRegisterExpr(compiler, Compiler_GetNode(values, 0), -1);
+    for (size_t i = 1; i < Vec_GetLength(values); i++) {
+        operand = Compiler_CompileRegisterExpr(compiler, Compiler_GetNode(values, i), -1);
+        // only the last operation writes the destination, the operands
+        // may read the variable until then
+        target = dst >= 0 && i == Vec_GetLength(values) - 1 ? (size_t)dst : Compiler_NewTemp(compiler);
+        Code_Emit(code, opcode, target, value, operand);
+        value = target;
+    }
+    return value;
+}
+
+/**
+ * Pushes the value of a register operand on the stack
+ */
+static void Compiler_EmitPushRegister(compiler_t * compiler, size_t operand) {
+    code_t * code = compiler->unit->code;
+
+    if (operand == CODE_REGISTER_THIS) {
+        Code_Emit(code, OP_PUSH_THIS);
+    } else if (operand & CODE_REGISTER_CONSTANT) {
+        Code_Emit(code, OP_PUSH_CONST, operand & ~CODE_REGISTER_CONSTANT);
+    } else {
+        Code_Emit(code, OP_LOAD_LOCAL, operand);
+    }
+}
+
+/**
+ * Compiles a message with up to 2 arguments whose receiver and arguments
+ * are register expressions into a single SEND_R instruction
+ * @returns false if the message cannot be compiled that way
+ */
+static bool Compiler_CompileRegisterSend(compiler_t * compiler, ast_node_t * node, string * selector) {
+    vector_t * components = node->as_msg_pass_expr.components;
+    size_t argc = (Vec_GetLength(components) - 1) / 2;
+    size_t operands[3], name, cache;
+
+    if (argc > 2) return false;
+    for (size_t i = 0; i <= argc; i++) {
+        if (!Compiler_IsRegisterExpr(compiler, Compiler_GetNode(components, i * 2))) return false;
+    }
+    // receiver, selector part, argument, selector part, argument
+    for (size_t i = 0; i <= argc; i++) {
+        operands[i] = Compiler_CompileRegisterExpr(compiler, Compiler_GetNode(components, i * 2), -1);
+    }
+    name = Compiler_AddName(compiler, selector->c_str);
+    cache = Compiler_AddCache(compiler);
+    if (argc == 0) {
+        Code_Emit(compiler->unit->code, OP_SEND_R0, name, cache, operands[0]);
+    } else if (argc == 1) {
+        Code_Emit(compiler->unit->code, OP_SEND_R1, name, cache, operands[0], operands[1]);
+    } else {
+        Code_Emit(compiler->unit->code, OP_SEND_R2, name, cache, operands[0], operands[1], operands[2]);
+    }
+    return true;
+}
+
+/**
+ * Compiles an affectation or a declaration of a local variable of the current
+ * unit whose value is a register expression, the value is computed in place
+ * @param declare Whether the variable is declared
+ * @returns       false if the statement cannot be compiled that way
+ */
+static bool Compiler_CompileRegisterStore(compiler_t * compiler, char * name, ast_node_t * rval,
+                                          bool declare) {
+    ssize_t slot;
+
+    if (!compiler->registers || compiler->unit->code->kind == CODE_CHUNK
+            || Compiler_IsReservedName(name) || !Compiler_IsRegisterExpr(compiler, rval)) {
+        return false;
+    }
+    // a register expression only reads the variable if it's already declared
+    // in the unit, declaring it before compiling the value is then harmless
+    slot = declare ? (ssize_t)Compiler_DeclareLocal(compiler, name)
+                   : Compiler_FindLocal(compiler->unit, name);
+    if (slot < 0 || slot >= CODE_REGISTER_CONSTANT) return false;
+    Compiler_CompileRegisterExpr(compiler, rval, slot);
+    return true;
+}
+
+/********************** Nodes ******************************/
+
+/**
+ * Compiles a block or a message definition into a new code unit
+ * and emits the instruction that creates it
+ * @param[in] params     vector_t<ast_identifier_t *> of the parameters
+ * @param     first      Index of the first parameter in params
+ * @param     step       Distance between two parameters in params
+ * @param[in] statements vector_t<ast_statement_t *> of the body
+ * @param     in_frame   Whether the block is created in the frame of the current unit
+ */
+static void Compiler_CompileCodeUnit(compiler_t * compiler, code_kind_t kind, char * name,
+                                     vector_t * params, size_t first, size_t step,
+                                     vector_t * statements, bool in_frame) {
+    code_t * code;
+    size_t index, slot;
+
+    Compiler_PushUnit(compiler, kind, name);
+    compiler->unit->in_frame = in_frame;
+    for (size_t i = first; i < Vec_GetLength(params); i += step) {
+        Compiler_DeclareLocal(compiler, Compiler_GetNode(params, i)->as_ident.value);
+        compiler->unit->code->params_count++;
+    }
+    Compiler_CompileStatements(compiler, statements);
+    Code_Emit(compiler->unit->code, OP_PUSH_NULL);
+    Code_Emit(compiler->unit->code, OP_RETURN);
+    code = Compiler_PopUnit(compiler);
+
+    index = Compiler_CheckOperand(compiler, Code_AddCode(compiler->unit->code, code),
+                                  "Too many blocks in a single block");
+    if (in_frame) {
+        slot = Compiler_CheckOperand(compiler, compiler->unit->code->frame_blocks_count++,
+                                     "Too many blocks in a single block");
+        Code_Emit(compiler->unit->code, OP_MAKE_FRAME_BLOCK, index, slot);
+    } else {
+        Code_Emit(compiler->unit->code, OP_MAKE_BLOCK, index);
+    }
+}
+
+static void Compiler_CompileObjLitteral(compiler_t * compiler, ast_node_t * node) {
+    vector_t * obj_fields = node->as_obj_litteral.obj_fields;
+    code_t * code = compiler->unit->code;
+
+    Code_SetLocation(code, node->loc);
+    Code_Emit(code, OP_NEW_OBJECT);
+    for (size_t i = 0; i < Vec_GetLength(obj_fields); i++) {
+        ast_node_t * field = Compiler_GetNode(obj_fields, i);
+
+        if (field->type == NODE_OBJ_FIELD_INIT) {
+            Compiler_CompileNode(compiler, field->as_obj_field_init.value);
+            Code_Emit(code, OP_INIT_FIELD,
+                      Compiler_AddName(compiler, field->as_obj_field_init.ident->as_ident.value));
+        } else {
+            vector_t * selector_parts = field->as_obj_msg_def.selector;
+            // "a: x b: y" is the "a:b" message with x and y as parameters
+            string * selector = Compiler_Selector(selector_parts, 0, 2);
+            Compiler_CompileCodeUnit(compiler, CODE_METHOD, selector->c_str,
+                                     selector_parts, 1, 2, field->as_obj_msg_def.statements, false);
+            Code_Emit(code, OP_INIT_FIELD, Compiler_AddName(compiler, selector->c_str));
+            Str_Free(selector);
+        }
+    }
+}
+
+static void Compiler_CompileArrayLitteral(compiler_t * compiler, ast_node_t * node) {
+    vector_t * items = node->as_array_litteral.items;
+
+    for (size_t i = 0; i < Vec_GetLength(items); i++) {
+        Compiler_CompileNode(compiler, Compiler_GetNode(items, i));
+    }
+    // the items may span several lines
+    Code_SetLocation(compiler->unit->code, node->loc);
+    Code_Emit(compiler->unit->code, OP_NEW_ARRAY,
+              Compiler_CheckOperand(compiler, Vec_GetLength(items), "Too many items in array litteral"));
+}
+
+/**
+ * Compiles one component of a dotted expression applied to the value
+ * on top of the stack
+ * @param store Whether the component is the target of an affectation
+ *              whose value is compiled by the caller (rval)
+ */
+static void Compiler_CompileDottedComponent(compiler_t * compiler, ast_node_t * component,
+                                            ast_node_t * rval) {
+    code_t * code = compiler->unit->code;
+
+    if (component->type == NODE_ARRAY_ACCESS) {
+        Compiler_CompileNode(compiler, component->as_array_access.index_expr);
+        if (rval) {
+            Compiler_CompileNode(compiler, rval);
+            Code_Emit(code, OP_SET_INDEX);
+        } else {
+            Code_Emit(code, OP_GET_INDEX);
+        }
+    } else {
+        string * name = Compiler_FieldName(component);
+        size_t index;
+        if (rval) Compiler_CompileNode(compiler, rval);
+        index = Compiler_AddName(compiler, name->c_str);
+        Code_Emit(code, rval ? OP_SET_FIELD : OP_GET_FIELD, index, Compiler_AddCache(compiler));
+        Str_Free(name);
+    }
+}
+
+static void Compiler_CompileDottedExpr(compiler_t * compiler, ast_node_t * node, ast_node_t * rval) {
+    vector_t * components = node->as_dotted_expr.components;
+    size_t last = Vec_GetLength(components) - 1;
+
+    Compiler_EmitLoadVariable(compiler, Compiler_GetNode(components, 0)->as_ident.value);
+    for (size_t i = 1; i <= last; i++) {
+        Compiler_CompileDottedComponent(compiler, Compiler_GetNode(components, i),
+                                        i == last ? rval : NULL);
+    }
+}
+
+static bool Compiler_IsFrameBlockSelector(char * selector) {
+    for (size_t i = 0; i < sizeof(frame_block_selectors) / sizeof(frame_block_selectors[0]); i++) {
+        if (!strcmp(frame_block_selectors[i], selector)) return true;
+    }
+    return false;
+}
+
+/**
+ * Compiles the receiver or an argument of a message
+ * @param in_frame Whether a block litteral can be created in the frame
+ * @returns        Whether a frame block was created
+ */
+static bool Compiler_CompileMsgOperand(compiler_t * compiler, ast_node_t * node, bool in_frame) {
+    if (in_frame && node->type == NODE_BLOCK) {
+        Code_SetLocation(compiler->unit->code, node->loc);
+        Compiler_CompileCodeUnit(compiler, CODE_BLOCK, "block", node->as_block.params, 0, 1,
+                                 node->as_block.statements, true);
+        return true;
+    }
+    Compiler_CompileNode(compiler, node);
+    return false;
+}
+
+static void Compiler_CompileMsgPassExpr(compiler_t * compiler, ast_node_t * node) {
+    vector_t * components = node->as_msg_pass_expr.components;
+    size_t argc = (Vec_GetLength(components) - 1) / 2;
+    string * selector = Compiler_Selector(components, 1, 2);
+    bool in_frame = Compiler_IsFrameBlockSelector(selector->c_str);
+    bool frame_blocks;
+
+    Code_SetLocation(compiler->unit->code, node->loc);
+    if (compiler->registers && Compiler_CompileRegisterSend(compiler, node, selector)) {
+        Str_Free(selector);
+        return;
+    }
+    // receiver, selector part, argument, selector part, argument...
+    frame_blocks = Compiler_CompileMsgOperand(compiler, Compiler_GetNode(components, 0), in_frame);
+    for (size_t i = 2; i < Vec_GetLength(components); i += 2) {
+        frame_blocks |= Compiler_CompileMsgOperand(compiler, Compiler_GetNode(components, i), in_frame);
+    }
+    // the receiver of the message decides at runtime whether the frame blocks
+    // must be moved to the heap
+    Code_SetLocation(compiler->unit->code, node->loc);
+    Code_Emit(compiler->unit->code, frame_blocks ? OP_SEND_BLOCKS : OP_SEND,
+              Compiler_AddName(compiler, selector->c_str), argc, Compiler_AddCache(compiler));
+    Str_Free(selector);
+}
+
+/**
+ * Compiles || and && with short-circuit evaluation
+ */
+static void Compiler_CompileLogicalExpr(compiler_t * compiler, ast_node_t * node, opcode_t jump) {
+    vector_t * values = node->as_expr.values;
+    vector_t * jumps = Vec_New();
+
+    for (size_t i = 0; i < Vec_GetLength(values); i++) {
+        Compiler_CompileNode(compiler, Compiler_GetNode(values, i));
+        if (i < Vec_GetLength(values) - 1) {
+            Vec_Append(jumps, nanbox_from_int(Compiler_EmitJump(compiler, jump)));
+        }
+    }
+    for (size_t i = 0; i < Vec_GetLength(jumps); i++) {
+        Compiler_PatchJump(compiler, nanbox_to_int(Vec_GetAt(jumps, i)));
+    }
+    Vec_Free(jumps);
+}
+
+static void Compiler_CompileBinaryExpr(compiler_t * compiler, ast_node_t * node) {
+    vector_t * values = node->as_expr.values;
+    opcode_t opcode = Compiler_BinaryOpcode(Compiler_BinaryOperator(node));
+
+    if (compiler->registers && Compiler_IsRegisterExpr(compiler, node)) {
+        Compiler_EmitPushRegister(compiler, Compiler_CompileRegisterExpr(compiler, node, -1));
+        return;
+    }
+    Compiler_CompileNode(compiler, Compiler_GetNode(values, 0));
+    for (size_t i = 1; i < Vec_GetLength(values); i++) {
+        Compiler_CompileNode(compiler, Compiler_GetNode(values, i));
+        Code_Emit(compiler->unit->code, opcode);
+    }
+}
+
+static void Compiler_CompileUnaryExpr(compiler_t * compiler, ast_node_t * node) {
+    Compiler_CompileNode(compiler, Compiler_GetNode(node->as_expr.values, 0));
+    switch (node->as_expr.op) {
+        case TOKTYPE_EXCL:
+            Code_Emit(compiler->unit->code, OP_NOT);
+            break;
+        case TOKTYPE_MINUS:
+            Code_Emit(compiler->unit->code, OP_NEG);
+            break;
+        default:
+            Code_Emit(compiler->unit->code, OP_POS);
+            break;
+    }
+}
+
+static void Compiler_CompileDecl(compiler_t * compiler, ast_node_t * node) {
+    char * name = node->as_decl.lval->as_ident.value;
+
+    if (Compiler_IsReservedName(name)) {
+        char buf[256];
+        snprintf(buf, 256, "Cannot declare a variable named '%s'", name);
+        Compiler_SetError(compiler, buf);
+        return;
+    }
+    if (Compiler_CompileRegisterStore(compiler, name, node->as_decl.rval, true)) return;
+    Compiler_CompileNode(compiler, node->as_decl.rval);
+    if (compiler->unit->code->kind == CODE_CHUNK) {
+        Code_Emit(compiler->unit->code, OP_DECL_GLOBAL, Compiler_AddName(compiler, name));
+    } else {
+        Code_Emit(compiler->unit->code, OP_STORE_LOCAL, Compiler_DeclareLocal(compiler, name));
+    }
+}
+
+static void Compiler_CompileAffect(compiler_t * compiler, ast_node_t * node) {
+    ast_node_t * lval = node->as_affect.lval;
+
+    if (lval->type == NODE_IDENTIFIER) {
+        if (Compiler_CompileRegisterStore(compiler, lval->as_ident.value, node->as_affect.rval, false)) {
+            return;
+        }
+        Compiler_CompileNode(compiler, node->as_affect.rval);
+        Compiler_EmitStoreVariable(compiler, lval->as_ident.value);
+    } else {
+        Compiler_CompileDottedExpr(compiler, lval, node->as_affect.rval);
+    }
+}
+
+/**
+ * Indicates whether the unit is a block nested in a message definition,
+ * "^" then returns from the message instead of the block
+ */
+static bool Compiler_HasHomeMethod(compiler_unit_t * unit) {
+    if (unit->code->kind != CODE_BLOCK) return false;
+    for (unit = unit->parent; unit; unit = unit->parent) {
+        if (unit->code->kind == CODE_METHOD) return true;
+    }
+    return false;
+}
+
+/**
+ * Compiles a statement
+ * @param is_last Whether the statement ends its block, an expression without
+ *                a trailing ';' only gives its value to the block in this case
+ */
+static void Compiler_CompileStatement(compiler_t * compiler, ast_node_t * node, bool is_last) {
+    ast_statement_t * statement = &node->as_statement;
+    ast_node_t * value = statement->value;
+
+    compiler->unit->temps_used = 0;
+    Code_SetLocation(compiler->unit->code, node->loc);
+    if (statement->is_return_expr && !statement->is_local_return
+            && Compiler_HasHomeMethod(compiler->unit)) {
+        Compiler_CompileNode(compiler, value);
+        Code_Emit(compiler->unit->code, OP_NON_LOCAL_RETURN);
+    } else if (statement->is_return_expr && (!statement->is_local_return || is_last)) {
+        // '^' in a block that is not nested in a message returns from the block
+        Compiler_CompileNode(compiler, value);
+        Code_Emit(compiler->unit->code, OP_RETURN);
+    } else if (value->type == NODE_DECL) {
+        Compiler_CompileDecl(compiler, value);
+    } else if (value->type == NODE_AFFECT) {
+        Compiler_CompileAffect(compiler, value);
+    } else {
+        Compiler_CompileNode(compiler, value);
+        Code_Emit(compiler->unit->code, OP_POP);
+    }
+}
+
+static void Compiler_CompileStatements(compiler_t * compiler, vector_t * statements) {
+    for (size_t i = 0; i < Vec_GetLength(statements)
+            && compiler->status == COMPILER_OK; i++) {
+        Compiler_CompileStatement(compiler, Compiler_GetNode(statements, i),
+                                  i == Vec_GetLength(statements) - 1);
+    }
+}
+
+static void Compiler_CompileNode(compiler_t * compiler, ast_node_t * node) {
+    code_t * code = compiler->unit->code;
+
+    if (compiler->status != COMPILER_OK) return;
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            Compiler_EmitLoadVariable(compiler, node->as_ident.value);
+            break;
+
+        case NODE_STRING:
+            Code_Emit(code, OP_PUSH_CONST,
+                      Compiler_AddConstant(compiler, StringObject_New(node->as_string.value)));
+            break;
+
+        case NODE_INT:
+            Code_Emit(code, OP_PUSH_CONST,
+                      Compiler_AddConstant(compiler, nanbox_from_int(node->as_int.value)));
+            break;
+
+        case NODE_DOUBLE:
+            Code_Emit(code, OP_PUSH_CONST,
+                      Compiler_AddConstant(compiler, nanbox_from_double(node->as_double.value)));
+            break;
+
+        case NODE_OBJ_LITTERAL:
+            Compiler_CompileObjLitteral(compiler, node);
+            break;
+
+        case NODE_ARRAY_LITTERAL:
+            Compiler_CompileArrayLitteral(compiler, node);
+            break;
+
+        case NODE_BLOCK:
+            Code_SetLocation(code, node->loc);
+            Compiler_CompileCodeUnit(compiler, CODE_BLOCK, "block", node->as_block.params, 0, 1,
+                                     node->as_block.statements, false);
+            break;
+
+        case NODE_DOTTED_EXPR:
+            Compiler_CompileDottedExpr(compiler, node, NULL);
+            break;
+
+        case NODE_MSG_PASS_EXPR:
+            Compiler_CompileMsgPassExpr(compiler, node);
+            break;
+
+        case NODE_OR_EXPR:
+            Compiler_CompileLogicalExpr(compiler, node, OP_JUMP_IF_TRUE_OR_POP);
+            break;
+
+        case NODE_AND_EXPR:
+            Compiler_CompileLogicalExpr(compiler, node, OP_JUMP_IF_FALSE_OR_POP);
+            break;
+
+        case NODE_EQ_EXPR:
+        case NODE_COMP_EXPR:
+        case NODE_ARITH_EXPR:
+        case NODE_TERM_EXPR:
+        case NODE_FACTOR_EXPR:
+            Compiler_CompileBinaryExpr(compiler, node);
+            break;
+
+        case NODE_UNARY_EXPR:
+            Compiler_CompileUnaryExpr(compiler, node);
+            break;
+
+        case NODE_STATEMENT:
+            Compiler_CompileStatement(compiler, node, false);
+            break;
+
+        case NODE_DECL:
+            Compiler_CompileDecl(compiler, node);
+            break;
+
+        case NODE_AFFECT:
+            Compiler_CompileAffect(compiler, node);
+            break;
+
+        case NODE__ROOT_:
+        case NODE_OBJ_FIELD_NAME:
+        case NODE_OBJ_FIELD_INIT:
+        case NODE_OBJ_MSG_DEF:
+        case NODE_ARRAY_ACCESS:
+            // only compiled as part of their parent node
+            Compiler_SetError(compiler, "Unexpected node");
+            break;
+    }
+}
+
+/**
+ * Allocates a new compiler
+ * @returns The newly allocated compiler
+ */
+compiler_t * Compiler_New(void) {
+    compiler_t * compiler = (compiler_t *)malloc(sizeof(compiler_t));
+
+    if (compiler) {
+        compiler->unit = NULL;
+        compiler->status = COMPILER_OK;
+        compiler->error = NULL;
+        compiler->superinstructions = true;
+#ifdef COMPILER_REGISTER_VM
+        compiler->registers = true;
+#else
+        compiler->registers = false;
+#endif
+    } else {
+        Err_Throw(Err_New("Cannot allocate compiler"));
+    }
+    return compiler;
+}
+
+/**
+ * Frees a previously allocated compiler
+ * @param[in] compiler The compiler to be freed
+ */
+void Compiler_Free(compiler_t * compiler) {
+    if (compiler) {
+        if (compiler->error) Err_Free(compiler->error);
+        free(compiler);
+    } else {
+        Err_Throw(Err_New("NULL pointer to compiler"));
+    }
+}
+
+/**
+ * Returns the status of the compiler
+ * @returns the status of the compiler
+ */
+compiler_status_t Compiler_GetStatus(compiler_t * compiler) {
+    compiler_status_t status = COMPILER_OK;
+    if (compiler) status = compiler->status;
+    else Err_Throw(Err_New("NULL pointer to compiler"));
+    return status;
+}
+
+/**
+ * Returns the error that the compiler encountered if any
+ * @retval NULL if no error
+ * @retval A pointer to an error if any
+ */
+error_t * Compiler_GetError(compiler_t * compiler) {
+    error_t * error = NULL;
+    if (compiler) error = compiler->error;
+    else Err_Throw(Err_New("NULL pointer to compiler"));
+    return error;
+}
+
+/**
+ * Compiles the statements of an AST into a chunk of bytecode
+ * @param[in] compiler The compiler
+ * @param[in] ast_root The AST root node (it can be freed after)
+ * @retval The compiled chunk
+ * @retval NULL if an error occured
+ */
+code_t * Compiler_Compile(compiler_t * compiler, ast_node_t * ast_root) {
+    code_t * code;
+
+    if (!ast_root || ast_root->type != NODE__ROOT_) {
+        Err_Throw(Err_New("Expected an AST root node"));
+    }
+    Compiler_PushUnit(compiler, CODE_CHUNK, "chunk");
+    Compiler_CompileStatements(compiler, ast_root->as_root.statements);
+    Code_Emit(compiler->unit->code, OP_PUSH_NULL);
+    Code_Emit(compiler->unit->code, OP_RETURN);
+    code = Compiler_PopUnit(compiler);
+
+    if (compiler->status != COMPILER_OK) {
+        Code_Free(code);
+        code = NULL;
+    }
+    return code;
+}
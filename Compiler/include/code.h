@@ -0,0 +1,276 @@
+/**
+ * @file code.h
+ * Compiled code implementation
+ */
+#pragma once
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "vector.h"
+#include "nanbox.h"
+#include "object.h"
+#include "opcodes.h"
+#include "str.h"
+#include "location.h"
+
+/** Maximum value of an instruction operand */
+#define CODE_MAX_OPERAND UINT16_MAX
+
+/**
+ * Register operands (see OP_MOVE) with this bit set reference the
+ * constant whose index is in the other bits
+ */
+#define CODE_REGISTER_CONSTANT 0x8000
+
+/** Register operand that references "this" */
+#define CODE_REGISTER_THIS 0xffff
+
+/** Number of receiver kinds a message send site remembers */
+#define INLINE_CACHE_SIZE 4
+
+/**
+ * Result of a lookup remembered by a message send or field access site
+ */
+typedef struct {
+    /** Id of the shape of the receiver, 0 if it's not an object */
+    size_t shape_id;
+
+    /**
+     * Identifies where the lookup continues after the receiver: the id of
+     * its prototype (or of the prototype used for its type) and its type
+     */
+    size_t proto_key;
+
+    /** Value of object_lookup_epoch when the lookup was performed */
+    size_t epoch;
+
+    /** Object that holds the field, NULL when it's the receiver itself */
+    object_t * holder;
+
+    /** Slot of the field in its holder */
+    size_t slot;
+
+    /** Symbol that was looked up, only checked by the global cache */
+    char * name;
+} inline_cache_entry_t;
+
+/**
+ * Lookup cache of a message send or field access site
+ */
+typedef struct {
+    inline_cache_entry_t entries[INLINE_CACHE_SIZE];
+
+    /** Number of used entries */
+    size_t count;
+
+    /**
+     * Whether the site saw more receiver kinds than it can remember,
+     * it then uses the interpreter global cache
+     */
+    bool megamorphic;
+} inline_cache_t;
+
+typedef enum {
+    /** Top-level statements of a file or of a REPL input */
+    CODE_CHUNK,
+    /** Block litteral */
+    CODE_BLOCK,
+    /** Message definition in an object litteral */
+    CODE_METHOD
+} code_kind_t;
+
+typedef struct code_s code_t;
+
+/**
+ * Represents a compiled unit of code: bytecode and its constant pools
+ */
+struct code_s {
+    code_kind_t kind;
+
+    /** Name of the unit (the selector for methods) */
+    char * name;
+
+    /** The bytecode */
+    uint8_t * bytecode;
+
+    /** Length of the bytecode */
+    size_t length;
+
+    /** Allocated length of the bytecode buffer */
+    size_t capacity;
+
+    /**
+     * Litteral values used by the code
+     * vector_t<nanbox_t>
+     */
+    vector_t * constants;
+
+    /**
+     * Names of the variables, fields and selectors used by the code
+     * vector_t<char *> (symbols)
+     */
+    vector_t * names;
+
+    /**
+     * Code of the blocks and methods defined in this unit
+     * vector_t<code_t *>
+     */
+    vector_t * codes;
+
+    /** Number of parameters */
+    size_t params_count;
+
+    /** Number of local variables (parameters included) */
+    size_t locals_count;
+
+    /**
+     * Whether the local variables must live in a heap context
+     * because inner blocks can capture them
+     */
+    bool needs_context;
+
+    /**
+     * Number of blocks the code creates in its frame instead of the heap
+     * (see OP_MAKE_FRAME_BLOCK)
+     */
+    size_t frame_blocks_count;
+
+    /**
+     * Number of enclosing units whose variables the code or its inner
+     * blocks capture (0 if they don't capture any variable)
+     */
+    size_t captured_depth;
+
+    /** Lookup caches of the message send and field access sites */
+    inline_cache_t * caches;
+
+    /** Number of message send and field access sites */
+    size_t caches_count;
+
+    /**
+     * Source lines of the instructions: the offset of the first instruction
+     * of each line followed by the line, by increasing offsets
+     * vector_t<int>
+     */
+    vector_t * lines;
+
+    /** Name of the file the code comes from (or NULL) */
+    char * filename;
+};
+
+/**
+ * Allocates a new code unit
+ * @param     kind The kind of code
+ * @param[in] name The name of the unit (a copy will be performed)
+ * @returns        The newly allocated code unit
+ */
+code_t * Code_New(code_kind_t kind, char * name);
+
+/**
+ * Frees a code unit, its constants and its inner code units
+ * @param[in] code The code unit to free
+ */
+void Code_Free(code_t * code);
+
+/**
+ * Appends an instruction
+ * @param[in] code     The code unit
+ * @param     opcode   The instruction opcode
+ * @param     operands The operands (opcode_operands[opcode] of them)
+ * @returns            The offset of the instruction
+ */
+size_t Code_Emit(code_t * code, opcode_t opcode, ...);
+
+/**
+ * Overwrites an operand of an already emitted instruction
+ * @param[in] code    The code unit
+ * @param     offset  Offset of the instruction
+ * @param     index   Index of the operand
+ * @param     operand The new value of the operand
+ */
+void Code_PatchOperand(code_t * code, size_t offset, size_t index, uint16_t operand);
+
+/**
+ * Reads an operand of an instruction
+ * @param[in] code   The code unit
+ * @param     offset Offset of the instruction
+ * @param     index  Index of the operand
+ * @returns          The operand
+ */
+uint16_t Code_GetOperand(code_t * code, size_t offset, size_t index);
+
+/**
+ * Computes the size of an instruction
+ * @param opcode The instruction opcode
+ * @returns      The size of the instruction and its operands in bytes
+ */
+size_t Code_InstructionSize(opcode_t opcode);
+
+/**
+ * Rewrites the first instruction of each sequence declared as a
+ * superinstruction, the longest sequence wins. The other instructions
+ * are left in place so the offsets and jump targets don't change
+ * @param[in] code The code unit (inner code units are not rewritten)
+ */
+void Code_FuseSuperinstructions(code_t * code);
+
+/**
+ * Adds a value to the constant pool, identical numbers are shared
+ * @param[in] code  The code unit
+ * @param     value The value
+ * @returns         The index of the constant
+ */
+size_t Code_AddConstant(code_t * code, nanbox_t value);
+
+/**
+ * Adds a name to the names pool, identical names are shared
+ * @param[in] code The code unit
+ * @param[in] name The name (it will be interned)
+ * @returns        The index of the name
+ */
+size_t Code_AddName(code_t * code, char * name);
+
+/**
+ * Adds an inner code unit
+ * @param[in] code  The code unit
+ * @param[in] inner The inner code unit (ownership is transfered)
+ * @returns         The index of the inner code unit
+ */
+size_t Code_AddCode(code_t * code, code_t * inner);
+
+/**
+ * Adds an empty lookup cache for a message send or field access site
+ * @param[in] code The code unit
+ * @returns        The index of the cache
+ */
+size_t Code_AddCache(code_t * code);
+
+/**
+ * Retrieves a name from the names pool
+ * @param[in] code  The code unit
+ * @param     index The index of the name
+ * @returns         The name (a symbol)
+ */
+char * Code_GetName(code_t * code, size_t index);
+
+/**
+ * Sets the source location of the next emitted instructions
+ * @param[in] code The code unit
+ * @param     loc  The location (ignored if its line is 0)
+ */
+void Code_SetLocation(code_t * code, loc_t loc);
+
+/**
+ * Finds the source line of an instruction
+ * @param[in] code   The code unit
+ * @param     offset The offset of the instruction, or of one of its operands
+ * @returns          The line or 0 if unknown
+ */
+size_t Code_GetLine(code_t * code, size_t offset);
+
+/**
+ * Builds a human readable listing of the code and of its inner code units
+ * @param[in] code The code unit
+ * @returns        The listing
+ */
+string * Code_Disassemble(code_t * code);
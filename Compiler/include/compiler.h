@@ -0,0 +1,104 @@
+/**
+ * @file compiler.h
+ * Bytecode compiler implementation
+ */
+#pragma once
+#include <stdbool.h>
+#include "ast.h"
+#include "code.h"
+#include "vector.h"
+#include "Common/include/error.h"
+
+typedef enum {
+    COMPILER_OK,
+    COMPILER_ERROR = -1
+} compiler_status_t;
+
+typedef struct compiler_unit_s compiler_unit_t;
+
+/**
+ * Represents the code unit being compiled
+ */
+struct compiler_unit_s {
+    /** The code being emitted */
+    code_t * code;
+
+    /** The unit the code is nested in (NULL for a chunk) */
+    compiler_unit_t * parent;
+
+    /**
+     * Names of the local variables, the index is the slot
+     * vector_t<char *> (borrowed from the AST)
+     */
+    vector_t * locals;
+
+    /**
+     * Whether the unit is a block created in the frame of its parent unit,
+     * it cannot outlive the activation that creates it
+     */
+    bool in_frame;
+
+    /**
+     * Slots of the temporaries of register instructions, they are
+     * appended to the local variables
+     * vector_t<int>
+     */
+    vector_t * temps;
+
+    /** Number of temporaries used by the statement being compiled */
+    size_t temps_used;
+};
+
+typedef struct {
+    /** The unit being compiled */
+    compiler_unit_t * unit;
+
+    /** Status of the compiler */
+    compiler_status_t status;
+
+    /** Last error that occured if any */
+    error_t * error;
+
+    /** Whether the emitted code uses superinstructions (true by default) */
+    bool superinstructions;
+
+    /**
+     * Whether the expressions over local variables and litterals are compiled
+     * to register instructions (false by default, true with make VM=register)
+     */
+    bool registers;
+} compiler_t;
+
+/**
+ * Allocates a new compiler
+ * @returns The newly allocated compiler
+ */
+compiler_t * Compiler_New(void);
+
+/**
+ * Frees a previously allocated compiler
+ * @param[in] compiler The compiler to be freed
+ */
+void Compiler_Free(compiler_t * compiler);
+
+/**
+ * Returns the status of the compiler
+ * @returns the status of the compiler
+ */
+compiler_status_t Compiler_GetStatus(compiler_t * compiler);
+
+/**
+ * Returns the error that the compiler encountered if any
+ * @retval NULL if no error
+ * @retval A pointer to an error if any
+ */
+error_t * Compiler_GetError(compiler_t * compiler);
+
+/**
+ * Compiles the statements of an AST into a chunk of bytecode
+ * @param[in] compiler The compiler
+ * @param[in] ast_root The AST root node (it can be freed after)
+ * @retval The compiled chunk
+ * @retval NULL if an error occured
+ */
+code_t * Compiler_Compile(compiler_t * compiler, ast_node_t * ast_root);
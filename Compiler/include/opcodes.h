@@ -0,0 +1,96 @@
+/**
+ * @file opcodes.h
+ * (Auto-generated) Opcodes declaration
+ */
+#pragma once
+#include <sys/types.h>
+
+typedef enum {
+    OP_NOP,
+    OP_POP,
+    OP_DUP,
+    OP_PUSH_CONST,
+    OP_PUSH_NULL,
+    OP_PUSH_TRUE,
+    OP_PUSH_FALSE,
+    OP_PUSH_THIS,
+    OP_LOAD_LOCAL,
+    OP_STORE_LOCAL,
+    OP_LOAD_CAPTURED,
+    OP_STORE_CAPTURED,
+    OP_LOAD_GLOBAL,
+    OP_STORE_GLOBAL,
+    OP_DECL_GLOBAL,
+    OP_NEW_OBJECT,
+    OP_INIT_FIELD,
+    OP_GET_FIELD,
+    OP_SET_FIELD,
+    OP_NEW_ARRAY,
+    OP_GET_INDEX,
+    OP_SET_INDEX,
+    OP_MAKE_BLOCK,
+    OP_MAKE_FRAME_BLOCK,
+    OP_SEND,
+    OP_SEND_BLOCKS,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_EQ,
+    OP_NE,
+    OP_LT,
+    OP_GT,
+    OP_LE,
+    OP_GE,
+    OP_NOT,
+    OP_NEG,
+    OP_POS,
+    OP_JUMP,
+    OP_JUMP_IF_FALSE,
+    OP_JUMP_IF_FALSE_OR_POP,
+    OP_JUMP_IF_TRUE_OR_POP,
+    OP_RETURN,
+    OP_NON_LOCAL_RETURN,
+    OP_MOVE,
+    OP_ADD_R,
+    OP_SUB_R,
+    OP_MUL_R,
+    OP_DIV_R,
+    OP_EQ_R,
+    OP_NE_R,
+    OP_LT_R,
+    OP_GT_R,
+    OP_LE_R,
+    OP_GE_R,
+    OP_SEND_R0,
+    OP_SEND_R1,
+    OP_SEND_R2,
+    OP_PUSH_NULL_RETURN,
+    OP_PUSH_CONST_ADD,
+    OP_PUSH_CONST_SUB,
+    OP_PUSH_CONST_LT,
+    OP_PUSH_THIS_GET_FIELD,
+    OP_LOAD_LOCAL_GET_FIELD,
+    OP_LOAD_LOCAL_SEND,
+    OP_GET_FIELD_SEND,
+    OP_LOAD_LOCAL_GET_FIELD_SEND,
+    OPCODES_NUMBER
+} opcode_t;
+
+extern char * opcode_names[];
+extern size_t opcode_operands[];
+
+/** Maximum number of instructions fused in a superinstruction */
+#define SUPERINSTRUCTION_MAX_LENGTH 3
+
+/**
+ * Sequence of instructions run by a superinstruction
+ */
+typedef struct {
+    opcode_t opcode;
+    size_t length;
+    opcode_t components[SUPERINSTRUCTION_MAX_LENGTH];
+} superinstruction_t;
+
+extern superinstruction_t superinstructions[];
+extern size_t superinstructions_count;
@@ -0,0 +1,162 @@
+/**
+ * @file opcodes.c
+ * (Auto-generated) Opcodes declaration
+ */
+#include <sys/types.h>
+#include "opcodes.h"
+
+char * opcode_names[] = {
+    "OP_NOP",
+    "OP_POP",
+    "OP_DUP",
+    "OP_PUSH_CONST",
+    "OP_PUSH_NULL",
+    "OP_PUSH_TRUE",
+    "OP_PUSH_FALSE",
+    "OP_PUSH_THIS",
+    "OP_LOAD_LOCAL",
+    "OP_STORE_LOCAL",
+    "OP_LOAD_CAPTURED",
+    "OP_STORE_CAPTURED",
+    "OP_LOAD_GLOBAL",
+    "OP_STORE_GLOBAL",
+    "OP_DECL_GLOBAL",
+    "OP_NEW_OBJECT",
+    "OP_INIT_FIELD",
+    "OP_GET_FIELD",
+    "OP_SET_FIELD",
+    "OP_NEW_ARRAY",
+    "OP_GET_INDEX",
+    "OP_SET_INDEX",
+    "OP_MAKE_BLOCK",
+    "OP_MAKE_FRAME_BLOCK",
+    "OP_SEND",
+    "OP_SEND_BLOCKS",
+    "OP_ADD",
+    "OP_SUB",
+    "OP_MUL",
+    "OP_DIV",
+    "OP_EQ",
+    "OP_NE",
+    "OP_LT",
+    "OP_GT",
+    "OP_LE",
+    "OP_GE",
+    "OP_NOT",
+    "OP_NEG",
+    "OP_POS",
+    "OP_JUMP",
+    "OP_JUMP_IF_FALSE",
+    "OP_JUMP_IF_FALSE_OR_POP",
+    "OP_JUMP_IF_TRUE_OR_POP",
+    "OP_RETURN",
+    "OP_NON_LOCAL_RETURN",
+    "OP_MOVE",
+    "OP_ADD_R",
+    "OP_SUB_R",
+    "OP_MUL_R",
+    "OP_DIV_R",
+    "OP_EQ_R",
+    "OP_NE_R",
+    "OP_LT_R",
+    "OP_GT_R",
+    "OP_LE_R",
+    "OP_GE_R",
+    "OP_SEND_R0",
+    "OP_SEND_R1",
+    "OP_SEND_R2",
+    "OP_PUSH_NULL_RETURN",
+    "OP_PUSH_CONST_ADD",
+    "OP_PUSH_CONST_SUB",
+    "OP_PUSH_CONST_LT",
+    "OP_PUSH_THIS_GET_FIELD",
+    "OP_LOAD_LOCAL_GET_FIELD",
+    "OP_LOAD_LOCAL_SEND",
+    "OP_GET_FIELD_SEND",
+    "OP_LOAD_LOCAL_GET_FIELD_SEND",
+};
+
+size_t opcode_operands[] = {
+    0, // OP_NOP
+    0, // OP_POP
+    0, // OP_DUP
+    1, // OP_PUSH_CONST
+    0, // OP_PUSH_NULL
+    0, // OP_PUSH_TRUE
+    0, // OP_PUSH_FALSE
+    0, // OP_PUSH_THIS
+    1, // OP_LOAD_LOCAL
+    1, // OP_STORE_LOCAL
+    2, // OP_LOAD_CAPTURED
+    2, // OP_STORE_CAPTURED
+    1, // OP_LOAD_GLOBAL
+    1, // OP_STORE_GLOBAL
+    1, // OP_DECL_GLOBAL
+    0, // OP_NEW_OBJECT
+    1, // OP_INIT_FIELD
+    2, // OP_GET_FIELD
+    2, // OP_SET_FIELD
+    1, // OP_NEW_ARRAY
+    0, // OP_GET_INDEX
+    0, // OP_SET_INDEX
+    1, // OP_MAKE_BLOCK
+    2, // OP_MAKE_FRAME_BLOCK
+    3, // OP_SEND
+    3, // OP_SEND_BLOCKS
+    0, // OP_ADD
+    0, // OP_SUB
+    0, // OP_MUL
+    0, // OP_DIV
+    0, // OP_EQ
+    0, // OP_NE
+    0, // OP_LT
+    0, // OP_GT
+    0, // OP_LE
+    0, // OP_GE
+    0, // OP_NOT
+    0, // OP_NEG
+    0, // OP_POS
+    1, // OP_JUMP
+    1, // OP_JUMP_IF_FALSE
+    1, // OP_JUMP_IF_FALSE_OR_POP
+    1, // OP_JUMP_IF_TRUE_OR_POP
+    0, // OP_RETURN
+    0, // OP_NON_LOCAL_RETURN
+    2, // OP_MOVE
+    3, // OP_ADD_R
+    3, // OP_SUB_R
+    3, // OP_MUL_R
+    3, // OP_DIV_R
+    3, // OP_EQ_R
+    3, // OP_NE_R
+    3, // OP_LT_R
+    3, // OP_GT_R
+    3, // OP_LE_R
+    3, // OP_GE_R
+    3, // OP_SEND_R0
+    4, // OP_SEND_R1
+    5, // OP_SEND_R2
+    0, // OP_PUSH_NULL_RETURN
+    1, // OP_PUSH_CONST_ADD
+    1, // OP_PUSH_CONST_SUB
+    1, // OP_PUSH_CONST_LT
+    0, // OP_PUSH_THIS_GET_FIELD
+    1, // OP_LOAD_LOCAL_GET_FIELD
+    1, // OP_LOAD_LOCAL_SEND
+    2, // OP_GET_FIELD_SEND
+    1, // OP_LOAD_LOCAL_GET_FIELD_SEND
+};
+
+superinstruction_t superinstructions[] = {
+    { OP_PUSH_NULL_RETURN, 2, { OP_PUSH_NULL, OP_RETURN } },
+    { OP_PUSH_CONST_ADD, 2, { OP_PUSH_CONST, OP_ADD } },
+    { OP_PUSH_CONST_SUB, 2, { OP_PUSH_CONST, OP_SUB } },
+    { OP_PUSH_CONST_LT, 2, { OP_PUSH_CONST, OP_LT } },
+    { OP_PUSH_THIS_GET_FIELD, 2, { OP_PUSH_THIS, OP_GET_FIELD } },
+    { OP_LOAD_LOCAL_GET_FIELD, 2, { OP_LOAD_LOCAL, OP_GET_FIELD } },
+    { OP_LOAD_LOCAL_SEND, 2, { OP_LOAD_LOCAL, OP_SEND } },
+    { OP_GET_FIELD_SEND, 2, { OP_GET_FIELD, OP_SEND } },
+    { OP_LOAD_LOCAL_GET_FIELD_SEND, 3, { OP_LOAD_LOCAL, OP_GET_FIELD, OP_SEND } },
+};
+
+size_t superinstructions_count = 9;
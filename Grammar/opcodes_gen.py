@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+import sys
+import re
+
+def gen_opcode_targets(opcodes, targets_h_file):
+    with open(targets_h_file, "w") as tf:
+        tf.truncate(0)
+        tf.write("/**\n"
+                 " * @file opcode_targets.h\n"
+                 " * (Auto-generated) Dispatch table of the interpreter loop\n"
+                 " * Must be included in the function that defines the TARGET_* labels\n"
+                 " */\n"
+                 "static void * opcode_targets[256] = {\n")
+        for (opcode_name, _) in opcodes:
+            tf.write("    &&TARGET_OP_" + opcode_name + ",\n")
+        for _ in range(len(opcodes), 256):
+            tf.write("    &&TARGET_UNKNOWN,\n")
+        tf.write("};\n")
+
+SUPERINSTRUCTION_MAX_LENGTH = 3
+
+# instructions after which the next one doesn't run in the same frame
+# or isn't the next one in the bytecode
+SEQUENCE_ENDS = {"SEND", "SEND_BLOCKS", "SEND_R0", "SEND_R1", "SEND_R2", "RETURN", "NON_LOCAL_RETURN",
+                 "JUMP", "JUMP_IF_FALSE", "JUMP_IF_FALSE_OR_POP", "JUMP_IF_TRUE_OR_POP"}
+
+def check_superinstructions(opcodes, superinstructions):
+    operands = dict(opcodes)
+    for (name, components) in superinstructions:
+        if not 2 <= len(components) <= SUPERINSTRUCTION_MAX_LENGTH:
+            sys.exit(name + ": a superinstruction fuses 2 to "
+                     + str(SUPERINSTRUCTION_MAX_LENGTH) + " instructions")
+        for component in components:
+            if component not in operands or component in dict(superinstructions):
+                sys.exit(name + ": " + component + " is not a base instruction")
+        if any(component in SEQUENCE_ENDS for component in components[:-1]):
+            sys.exit(name + ": only the last component can be a send, a jump or a return")
+        if operands[name] != operands[components[0]]:
+            sys.exit(name + ": the operands are those of " + components[0])
+
+def gen_opcodes(opcodes_file, opcodes_h_file, opcodes_c_file, targets_h_file=None):
+    with open(opcodes_h_file, "w") as hf, \
+         open(opcodes_c_file, "w") as cf, \
+         open(opcodes_file, "r") as of:
+        opcodes = []
+
+        superinstructions = []
+
+        for line in of.readlines():
+            match = re.match(r"(?P<name>[A-Z_0-9]+) +(?P<operands>[0-9]+)"
+                             r"(?: += +(?P<components>[A-Z_0-9 ]+[A-Z_0-9]))?", line)
+            if match:
+                opcodes.append((match.group("name"), match.group("operands")))
+                if match.group("components"):
+                    superinstructions.append((match.group("name"), match.group("components").split()))
+        check_superinstructions(opcodes, superinstructions)
+
+        hf.truncate(0)
+        hf.write("/**\n"
+                 " * @file opcodes.h\n"
+                 " * (Auto-generated) Opcodes declaration\n"
+                 " */\n"
+                 "#pragma once\n"
+                 "#include <sys/types.h>\n\n"
+                 "typedef enum {\n")
+        for (opcode_name, _) in opcodes:
+            hf.write("    OP_" + opcode_name + ",\n")
+        hf.write("    OPCODES_NUMBER\n"
+                 "} opcode_t;\n\n"
+                 "extern char * opcode_names[];\n"
+                 "extern size_t opcode_operands[];\n\n"
+                 "/** Maximum number of instructions fused in a superinstruction */\n"
+                 "#define SUPERINSTRUCTION_MAX_LENGTH " + str(SUPERINSTRUCTION_MAX_LENGTH) + "\n\n"
+                 "/**\n"
+                 " * Sequence of instructions run by a superinstruction\n"
+                 " */\n"
+                 "typedef struct {\n"
+                 "    opcode_t opcode;\n"
+                 "    size_t length;\n"
+                 "    opcode_t components[SUPERINSTRUCTION_MAX_LENGTH];\n"
+                 "} superinstruction_t;\n\n"
+                 "extern superinstruction_t superinstructions[];\n"
+                 "extern size_t superinstructions_count;\n")
+
+        cf.write("/**\n"
+                 " * @file opcodes.c\n"
+                 " * (Auto-generated) Opcodes declaration\n"
+                 " */\n"
+                 "#include <sys/types.h>\n"
+                 "#include \"opcodes.h\"\n\n"
+                 "char * opcode_names[] = {\n")
+        for (opcode_name, _) in opcodes:
+            cf.write("    \"OP_" + opcode_name + "\",\n")
+        cf.write("};\n\n"
+                 "size_t opcode_operands[] = {\n")
+        for (opcode_name, operands) in opcodes:
+            cf.write("    " + operands + ", // OP_" + opcode_name + "\n")
+        cf.write("};\n\n"
+                 "superinstruction_t superinstructions[] = {\n")
+        for (opcode_name, components) in superinstructions:
+            cf.write("    { OP_" + opcode_name + ", " + str(len(components)) + ", { "
+                     + ", ".join("OP_" + component for component in components) + " } },\n")
+        if not superinstructions:
+            cf.write("    { OP_NOP, 0, { OP_NOP } },\n")
+        cf.write("};\n\n"
+                 "size_t superinstructions_count = " + str(len(superinstructions)) + ";\n")
+
+    if targets_h_file:
+        gen_opcode_targets(opcodes, targets_h_file)
+
+if __name__ == "__main__":
+    gen_opcodes(sys.argv[1], sys.argv[2], sys.argv[3],
+                sys.argv[4] if len(sys.argv) > 4 else None)
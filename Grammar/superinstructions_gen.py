@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+# Ranks the opcode sequences of profiles written by an interpreter built
+# with "make PROFILE=opcodes" and prints the most executed ones as
+# superinstruction declarations for opcodes.txt
+# Usage: superinstructions_gen.py <opcodes.txt> <profile> [<profile>...] [--top N]
+import sys
+import re
+from collections import defaultdict
+
+# instructions after which the next one doesn't run in the same frame
+# or isn't the next one in the bytecode, they can only end a sequence
+SEQUENCE_ENDS = {"SEND", "SEND_BLOCKS", "SEND_R0", "SEND_R1", "SEND_R2", "RETURN", "NON_LOCAL_RETURN",
+                 "JUMP", "JUMP_IF_FALSE", "JUMP_IF_FALSE_OR_POP", "JUMP_IF_TRUE_OR_POP"}
+
+def read_opcodes(opcodes_file):
+    operands = {}
+    declared = {}
+    with open(opcodes_file, "r") as of:
+        for line in of.readlines():
+            match = re.match(r"(?P<name>[A-Z_0-9]+) +(?P<operands>[0-9]+)"
+                             r"(?: += +(?P<components>[A-Z_0-9 ]+[A-Z_0-9]))?", line)
+            if match:
+                operands[match.group("name")] = int(match.group("operands"))
+                if match.group("components"):
+                    declared[tuple(match.group("components").split())] = match.group("name")
+    return operands, declared
+
+def read_profiles(profile_files):
+    counts = defaultdict(int)
+    for profile_file in profile_files:
+        with open(profile_file, "r") as pf:
+            for line in pf.readlines():
+                fields = line.split()
+                if len(fields) < 2 or not fields[0].isdigit():
+                    continue
+                counts[tuple(name[len("OP_"):] for name in fields[1:])] += int(fields[0])
+    return counts
+
+def is_fusable(sequence):
+    return not any(name in SEQUENCE_ENDS for name in sequence[:-1])
+
+def main(argv):
+    top = 10
+    if "--top" in argv:
+        index = argv.index("--top")
+        top = int(argv[index + 1])
+        del argv[index:index + 2]
+    if len(argv) < 3:
+        print("Usage: " + argv[0] + " <opcodes.txt> <profile> [<profile>...] [--top N]")
+        return 1
+
+    operands, declared = read_opcodes(argv[1])
+    counts = read_profiles(argv[2:])
+    total = sum(count for (sequence, count) in counts.items() if len(sequence) == 1)
+    # each execution of a fused sequence saves one dispatch per extra component
+    candidates = sorted(((count * (len(sequence) - 1), sequence)
+                         for (sequence, count) in counts.items()
+                         if len(sequence) > 1 and is_fusable(sequence)), reverse=True)
+
+    print("# %d dispatches profiled" % total)
+    print("# saved dispatches, then the declaration for opcodes.txt")
+    for (saved, sequence) in candidates[:top]:
+        name = declared.get(sequence, "_".join(sequence))
+        # the operands of a superinstruction are those of its first component
+        declaration = "%-36s %d = %s" % (name, operands.get(sequence[0], 0), " ".join(sequence))
+        status = "  # declared" if sequence in declared else ""
+        print("%12d (%4.1f%%)  %s%s" % (saved, 100.0 * saved / max(total, 1), declaration, status))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -2,24 +2,313 @@
  * @file arrayobject.c
  * Arrays Implementation
  */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include "arrayobject.h"
 #include "object.h"
 #include "objects_types.h"
 #include "nanbox.h"
 #include "vector.h"
+#include "gc.h"
+#include "Common/include/error.h"
 
-#define LENGTH_FIELD "length"
+/** Size of an item of each kind */
+static const size_t item_sizes[] = {
+    [ARRAY_KIND_INT] = sizeof(int32_t),
+    [ARRAY_KIND_DOUBLE] = sizeof(double),
+    [ARRAY_KIND_GENERIC] = sizeof(nanbox_t),
+    [ARRAY_KIND_SPARSE] = sizeof(array_entry_t)
+};
 
-static void ArrayObject_FreeItem(nanbox_t item) {
-    if (nanbox_is_pointer(item)) {
-        Object_DecRef(&item);
+/**
+ * Frees the items of an array, or leaves them to the other arrays that
+ * share them
+ */
+static void ArrayObject_FreeItems(arrayobject_t * arrayobject_ptr) {
+    array_shared_t * shared = arrayobject_ptr->shared;
+
+    if (!shared) {
+        GC_RemoveExternalSize(arrayobject_ptr->capacity * item_sizes[arrayobject_ptr->kind]);
+        free(arrayobject_ptr->items.values);
+    } else if (--shared->refs == 0) {
+        GC_RemoveExternalSize(shared->size);
+        free(shared->items);
+        free(shared);
     }
+    arrayobject_ptr->shared = NULL;
 }
 
 static void ArrayObject_CustomFree(void * object_ptr) {
+    ArrayObject_FreeItems((arrayobject_t *)object_ptr);
+}
+
+static void ArrayObject_Trace(void * object_ptr) {
     arrayobject_t * arrayobject_ptr = (arrayobject_t *)object_ptr;
-    Vec_ForEach(arrayobject_ptr->items, ArrayObject_FreeItem);
-    Vec_Free(arrayobject_ptr->items);
+    // the packed kinds reference no object
+    if (arrayobject_ptr->kind == ARRAY_KIND_GENERIC) {
+        GC_MarkAll(arrayobject_ptr->items.values, arrayobject_ptr->length);
+    } else if (arrayobject_ptr->kind == ARRAY_KIND_SPARSE) {
+        for (size_t i = 0; i < arrayobject_ptr->capacity; i++) {
+            if (!nanbox_is_empty(arrayobject_ptr->items.entries[i].value)) {
+                GC_Mark(&arrayobject_ptr->items.entries[i].value);
+            }
+        }
+    }
+}
+
+/**
+ * Boxes a number of a double array, the integers are read as integers
+ * like they were stored
+ */
+static nanbox_t ArrayObject_BoxDouble(double value) {
+    if (value >= INT32_MIN && value <= INT32_MAX && value == (int32_t)value
+            && !(value == 0 && signbit(value))) {
+        return nanbox_from_int((int32_t)value);
+    }
+    return nanbox_from_double(value);
+}
+
+/**
+ * Makes the last array using a shared storage its owner
+ * @returns Whether the array owns its items
+ */
+static bool ArrayObject_Own(arrayobject_t * arrayobject_ptr) {
+    array_shared_t * shared = arrayobject_ptr->shared;
+
+    if (shared->refs > 1 || shared->items != arrayobject_ptr->items.values) return false;
+    arrayobject_ptr->capacity = shared->size / item_sizes[arrayobject_ptr->kind];
+    arrayobject_ptr->shared = NULL;
+    free(shared);
+    return true;
+}
+
+/**
+ * Reallocates the storage of the items for another capacity or kind, the
+ * items are converted to the new kind. Shared items are copied
+ */
+static void ArrayObject_Resize(arrayobject_t * arrayobject_ptr, size_t capacity, array_kind_t kind) {
+    size_t size = capacity * item_sizes[kind];
+    void * items;
+
+    if (kind == arrayobject_ptr->kind && !arrayobject_ptr->shared) {
+        items = realloc(arrayobject_ptr->items.values, size);
+        if (!items) Err_Throw(Err_New("Cannot grow array"));
+        GC_RemoveExternalSize(arrayobject_ptr->capacity * item_sizes[kind]);
+    } else {
+        items = malloc(size);
+        if (!items) Err_Throw(Err_New("Cannot grow array"));
+        if (kind == arrayobject_ptr->kind) {
+            memcpy(items, arrayobject_ptr->items.values, arrayobject_ptr->length * item_sizes[kind]);
+        }
+        for (size_t i = 0; kind != arrayobject_ptr->kind && i < arrayobject_ptr->length; i++) {
+            if (arrayobject_ptr->kind == ARRAY_KIND_INT && kind == ARRAY_KIND_DOUBLE) {
+                ((double *)items)[i] = arrayobject_ptr->items.ints[i];
+            } else if (arrayobject_ptr->kind == ARRAY_KIND_INT) {
+                ((nanbox_t *)items)[i] = nanbox_from_int(arrayobject_ptr->items.ints[i]);
+            } else {
+                ((nanbox_t *)items)[i] = ArrayObject_BoxDouble(arrayobject_ptr->items.doubles[i]);
+            }
+        }
+        ArrayObject_FreeItems(arrayobject_ptr);
+    }
+    GC_AddExternalSize(size);
+    arrayobject_ptr->items.values = items;
+    arrayobject_ptr->capacity = capacity;
+    arrayobject_ptr->kind = kind;
+}
+
+/**
+ * Stores an item at an index below the capacity of a dense array, the
+ * array moves to the kind that can hold it first
+ */
+static void ArrayObject_Store(arrayobject_t * arrayobject_ptr, size_t index, nanbox_t item) {
+    array_kind_t kind = arrayobject_ptr->kind;
+
+    if (kind == ARRAY_KIND_INT && !nanbox_is_int(item)) {
+        kind = nanbox_is_double(item) ? ARRAY_KIND_DOUBLE : ARRAY_KIND_GENERIC;
+    } else if (kind == ARRAY_KIND_DOUBLE && !nanbox_is_number(item)) {
+        kind = ARRAY_KIND_GENERIC;
+    }
+    if (kind != arrayobject_ptr->kind
+            || (arrayobject_ptr->shared && !ArrayObject_Own(arrayobject_ptr))) {
+        ArrayObject_Resize(arrayobject_ptr, arrayobject_ptr->capacity, kind);
+    }
+    switch (kind) {
+        case ARRAY_KIND_INT:
+            arrayobject_ptr->items.ints[index] = nanbox_to_int(item);
+            break;
+        case ARRAY_KIND_DOUBLE:
+            arrayobject_ptr->items.doubles[index] = nanbox_to_number(item);
+            break;
+        default:
+            arrayobject_ptr->items.values[index] = item;
+            GC_WRITE_BARRIER(arrayobject_ptr, item);
+            break;
+    }
+}
+
+/**
+ * Makes room in a dense array for the items up to a length, the holes
+ * before the last one are null. The length is set once the last one is stored
+ */
+static void ArrayObject_Extend(arrayobject_t * arrayobject_ptr, size_t length) {
+    size_t capacity;
+    array_kind_t kind = arrayobject_ptr->kind;
+
+    if (arrayobject_ptr->shared) ArrayObject_Own(arrayobject_ptr);
+    capacity = arrayobject_ptr->capacity ? arrayobject_ptr->capacity : ARRAY_INITIAL_CAPACITY;
+
+    if (length > arrayobject_ptr->length + 1) kind = ARRAY_KIND_GENERIC;
+    while (capacity < length) capacity *= 2;
+    if (capacity != arrayobject_ptr->capacity || kind != arrayobject_ptr->kind
+            || arrayobject_ptr->shared) {
+        ArrayObject_Resize(arrayobject_ptr, capacity, kind);
+    }
+    for (size_t i = arrayobject_ptr->length; i + 1 < length; i++) {
+        arrayobject_ptr->items.values[i] = nanbox_null();
+    }
+}
+
+/**
+ * Returns the entry of an index of a sparse array, or the free entry where
+ * it must be added
+ */
+static array_entry_t * ArrayObject_Find(arrayobject_t * arrayobject_ptr, size_t index) {
+    size_t mask = arrayobject_ptr->capacity - 1;
+    size_t i = (index * 2654435761u) & mask;
+
+    while (!nanbox_is_empty(arrayobject_ptr->items.entries[i].value)
+            && arrayobject_ptr->items.entries[i].index != index) {
+        i = (i + 1) & mask;
+    }
+    return &arrayobject_ptr->items.entries[i];
+}
+
+/**
+ * Reads the item at an index below the length
+ */
+static nanbox_t ArrayObject_Load(arrayobject_t * arrayobject_ptr, size_t index) {
+    switch (arrayobject_ptr->kind) {
+        case ARRAY_KIND_INT:
+            return nanbox_from_int(arrayobject_ptr->items.ints[index]);
+        case ARRAY_KIND_DOUBLE:
+            return ArrayObject_BoxDouble(arrayobject_ptr->items.doubles[index]);
+        case ARRAY_KIND_SPARSE: {
+            nanbox_t item = ArrayObject_Find(arrayobject_ptr, index)->value;
+            return nanbox_is_empty(item) ? nanbox_null() : item;
+        }
+        default:
+            return arrayobject_ptr->items.values[index];
+    }
+}
+
+/**
+ * Moves the entries of a sparse array, or the items of a dense one but the
+ * null ones, to new entries
+ */
+static void ArrayObject_Rehash(arrayobject_t * arrayobject_ptr, size_t capacity) {
+    arrayobject_t previous = *arrayobject_ptr;
+    array_entry_t * entries = (array_entry_t *)malloc(capacity * sizeof(array_entry_t));
+
+    if (!entries) Err_Throw(Err_New("Cannot allocate sparse array entries"));
+    for (size_t i = 0; i < capacity; i++) {
+        entries[i].value = nanbox_empty();
+    }
+    arrayobject_ptr->items.entries = entries;
+    arrayobject_ptr->capacity = capacity;
+    arrayobject_ptr->kind = ARRAY_KIND_SPARSE;
+    arrayobject_ptr->count = 0;
+    arrayobject_ptr->shared = NULL;
+    if (previous.kind == ARRAY_KIND_SPARSE) {
+        for (size_t i = 0; i < previous.capacity; i++) {
+            if (!nanbox_is_empty(previous.items.entries[i].value)) {
+                *ArrayObject_Find(arrayobject_ptr, previous.items.entries[i].index) = previous.items.entries[i];
+                arrayobject_ptr->count++;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < previous.length; i++) {
+            nanbox_t item = ArrayObject_Load(&previous, i);
+
+            // the holes left by the previous stores are not kept
+            if (nanbox_is_null(item)) continue;
+            *ArrayObject_Find(arrayobject_ptr, i) = (array_entry_t){ i, item };
+            arrayobject_ptr->count++;
+        }
+    }
+    ArrayObject_FreeItems(&previous);
+    GC_AddExternalSize(capacity * sizeof(array_entry_t));
+}
+
+/**
+ * Moves the entries of a sparse array to generic items, the holes are null
+ */
+static void ArrayObject_Densify(arrayobject_t * arrayobject_ptr) {
+    array_entry_t * entries = arrayobject_ptr->items.entries;
+    size_t capacity = arrayobject_ptr->capacity;
+    nanbox_t * items = (nanbox_t *)malloc(arrayobject_ptr->length * sizeof(nanbox_t));
+
+    if (!items) Err_Throw(Err_New("Cannot grow array"));
+    for (size_t i = 0; i < arrayobject_ptr->length; i++) {
+        items[i] = nanbox_null();
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        if (!nanbox_is_empty(entries[i].value)) items[entries[i].index] = entries[i].value;
+    }
+    free(entries);
+    GC_RemoveExternalSize(capacity * sizeof(array_entry_t));
+    GC_AddExternalSize(arrayobject_ptr->length * sizeof(nanbox_t));
+    arrayobject_ptr->items.values = items;
+    arrayobject_ptr->capacity = arrayobject_ptr->length;
+    arrayobject_ptr->kind = ARRAY_KIND_GENERIC;
+    arrayobject_ptr->count = 0;
+}
+
+/**
+ * Stores an item in a sparse array, which becomes dense once half full
+ */
+static void ArrayObject_StoreSparse(arrayobject_t * arrayobject_ptr, size_t index, nanbox_t item) {
+    array_entry_t * entry = ArrayObject_Find(arrayobject_ptr, index);
+
+    if (nanbox_is_empty(entry->value)) {
+        // a quarter of the entries stays free
+        if ((arrayobject_ptr->count + 1) * 4 > arrayobject_ptr->capacity * 3) {
+            ArrayObject_Rehash(arrayobject_ptr, arrayobject_ptr->capacity * 2);
+            entry = ArrayObject_Find(arrayobject_ptr, index);
+        }
+        entry->index = index;
+        arrayobject_ptr->count++;
+        if (index >= arrayobject_ptr->length) arrayobject_ptr->length = index + 1;
+    }
+    entry->value = item;
+    GC_WRITE_BARRIER(arrayobject_ptr, item);
+    if (arrayobject_ptr->count * 2 >= arrayobject_ptr->length) {
+        ArrayObject_Densify(arrayobject_ptr);
+    }
+}
+
+/**
+ * Removes the entry of an index of a sparse array
+ * @returns The item, null for a hole
+ */
+static nanbox_t ArrayObject_RemoveSparse(arrayobject_t * arrayobject_ptr, size_t index) {
+    array_entry_t * entry = ArrayObject_Find(arrayobject_ptr, index);
+    size_t mask = arrayobject_ptr->capacity - 1;
+    nanbox_t item = entry->value;
+
+    if (nanbox_is_empty(item)) return nanbox_null();
+    entry->value = nanbox_empty();
+    arrayobject_ptr->count--;
+    // the following colliding entries are added again so that they are still found
+    for (size_t i = (entry - arrayobject_ptr->items.entries + 1) & mask;
+            !nanbox_is_empty(arrayobject_ptr->items.entries[i].value); i = (i + 1) & mask) {
+        array_entry_t moved = arrayobject_ptr->items.entries[i];
+
+        arrayobject_ptr->items.entries[i].value = nanbox_empty();
+        *ArrayObject_Find(arrayobject_ptr, moved.index) = moved;
+    }
+    return item;
 }
 
 /**
@@ -29,14 +318,18 @@ static void ArrayObject_CustomFree(void * object_ptr) {
 nanbox_t ArrayObject_New(void) {
     arrayobject_t * arrayobject_ptr;
     nanbox_t arrayobject;
-    arrayobject = Object_New(sizeof(arrayobject_t), ArrayObject_CustomFree);
+    arrayobject = Object_New(sizeof(arrayobject_t), ArrayObject_CustomFree, ArrayObject_Trace);
     arrayobject_ptr = nanbox_to_pointer(arrayobject);
     arrayobject_ptr->type = ARRAY_OBJECT;
-    arrayobject_ptr->items = Vec_New();
+    // an empty array holds integers until another item is stored
+    arrayobject_ptr->kind = ARRAY_KIND_INT;
+    arrayobject_ptr->items.values = NULL;
+    arrayobject_ptr->length = 0;
+    arrayobject_ptr->capacity = 0;
+    arrayobject_ptr->count = 0;
+    arrayobject_ptr->shared = NULL;
     /// @todo Array prototype
     // Object_SetPrototype(arrayobject, /* TODO */);
-    // Initial length is 0
-    Object_SetField(arrayobject, LENGTH_FIELD, nanbox_from_int(0));
     return arrayobject;
 }
 
@@ -44,40 +337,48 @@ nanbox_t ArrayObject_New(void) {
  * Retrieves a stored element in the arrayobject
  * @param arrayobject A reference to the arrayobject
  * @param index       The index of the element in the arrayobject
- * @returns           The stored element
+ * @returns           The stored element, null for a hole
  */
 nanbox_t ArrayObject_GetAt(nanbox_t arrayobject, ssize_t index) {
     arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
-    size_t vec_size = Vec_GetLength(arrayobject_ptr->items);
-    if (index < 0 || index > vec_size - 1) {
+    if (index < 0 || (size_t)index >= arrayobject_ptr->length) {
         /// @todo Raise exception
         return nanbox_null();
     }
-    return Vec_GetAt(arrayobject_ptr->items, index);
+    return ArrayObject_Load(arrayobject_ptr, index);
 }
 
 /**
- * Stores an element in the arrayobject
+ * Stores an element in the arrayobject, a store after the end extends it
  * @param arrayobject A reference to the arrayobject
  * @param index      The index of the element in the arrayobject
  * @param item       The element to be stored
  */
 void ArrayObject_SetAt(nanbox_t arrayobject, ssize_t index, nanbox_t item) {
     arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
-    size_t vec_size = Vec_GetLength(arrayobject_ptr->items);
-    if (index < 0 || index > vec_size - 1) {
+    size_t length = arrayobject_ptr->length;
+
+    if (index < 0) {
         /// @todo Raise exception
+        return;
+    }
+    // the holes would take most of the items
+    if (arrayobject_ptr->kind != ARRAY_KIND_SPARSE && (size_t)index > length + ARRAY_MAX_GAP
+            && (size_t)index > length * 2) {
+        size_t capacity = ARRAY_INITIAL_CAPACITY;
+
+        // a quarter of the entries stays free
+        while (capacity * 3 < (length + 1) * 4) capacity *= 2;
+        ArrayObject_Rehash(arrayobject_ptr, capacity);
+    }
+    if (arrayobject_ptr->kind == ARRAY_KIND_SPARSE) {
+        ArrayObject_StoreSparse(arrayobject_ptr, index, item);
+    } else if ((size_t)index < length) {
+        ArrayObject_Store(arrayobject_ptr, index, item);
     } else {
-        // We must decrement the ref count of the previous value
-        nanbox_t old = Vec_GetAt(arrayobject_ptr->items, index);
-        if (nanbox_is_pointer(old)) {
-            Object_DecRef(&old);
-        }
-        Vec_SetAt(arrayobject_ptr->items, index, item);
-        // We increment the ref count of the new object
-        if (nanbox_is_pointer(item)) {
-            Object_IncRef(item);
-        }
+        ArrayObject_Extend(arrayobject_ptr, index + 1);
+        ArrayObject_Store(arrayobject_ptr, index, item);
+        arrayobject_ptr->length = index + 1;
     }
 }
 
@@ -88,12 +389,14 @@ void ArrayObject_SetAt(nanbox_t arrayobject, ssize_t index, nanbox_t item) {
  */
 void ArrayObject_Append(nanbox_t arrayobject, nanbox_t item) {
     arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
-    size_t length = nanbox_to_int(Object_GetField(arrayobject, LENGTH_FIELD));
-    Object_SetField(arrayobject, LENGTH_FIELD, nanbox_from_int(length + 1));
-    Vec_Append(arrayobject_ptr->items, item);
-    // We increment the ref count of the appended object
-    if (nanbox_is_pointer(item)) {
-        Object_IncRef(item);
+    size_t length = arrayobject_ptr->length;
+
+    if (arrayobject_ptr->kind == ARRAY_KIND_SPARSE) {
+        ArrayObject_StoreSparse(arrayobject_ptr, length, item);
+    } else {
+        ArrayObject_Extend(arrayobject_ptr, length + 1);
+        ArrayObject_Store(arrayobject_ptr, length, item);
+        arrayobject_ptr->length++;
     }
 }
 
@@ -104,20 +407,63 @@ void ArrayObject_Append(nanbox_t arrayobject, nanbox_t item) {
  */
 nanbox_t ArrayObject_Pop(nanbox_t arrayobject) {
     arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
-    size_t length = nanbox_to_int(Object_GetField(arrayobject, LENGTH_FIELD));
-    if (length > 1) {
-        Object_SetField(arrayobject, LENGTH_FIELD, nanbox_from_int(length - 1));
-        nanbox_t item = Vec_Pop(arrayobject_ptr->items);
-        // We decrement the ref count of the popped object
-        if (nanbox_is_pointer(item)) {
-            Object_DecRef(&item);
-        }
-        return item;
+    if (arrayobject_ptr->length > 0 && arrayobject_ptr->kind == ARRAY_KIND_SPARSE) {
+        return ArrayObject_RemoveSparse(arrayobject_ptr, --arrayobject_ptr->length);
+    }
+    if (arrayobject_ptr->length > 0) {
+        return ArrayObject_Load(arrayobject_ptr, --arrayobject_ptr->length);
     }
     /// @todo Raise exception
     return nanbox_null();
 }
 
+/**
+ * Creates an arrayobject holding some of the items of another one, they are
+ * only copied once one of the two arrayobjects is modified
+ * @param arrayobject A reference to the arrayobject
+ * @param index       Index of the first item
+ * @param length      Number of items, they must be in the arrayobject
+ * @returns           The new arrayobject
+ */
+nanbox_t ArrayObject_Slice(nanbox_t arrayobject, size_t index, size_t length) {
+    arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
+    nanbox_t slice = ArrayObject_New();
+    arrayobject_t * slice_ptr = nanbox_to_pointer(slice);
+
+    if (length == 0) return slice;
+    if (arrayobject_ptr->kind == ARRAY_KIND_SPARSE) {
+        // only the entries are copied, the last item sets the length
+        ArrayObject_SetAt(slice, length - 1, nanbox_null());
+        for (size_t i = 0; i < arrayobject_ptr->capacity; i++) {
+            array_entry_t * entry = &arrayobject_ptr->items.entries[i];
+
+            if (!nanbox_is_empty(entry->value) && entry->index >= index
+                    && entry->index < index + length) {
+                ArrayObject_SetAt(slice, entry->index - index, entry->value);
+            }
+        }
+        return slice;
+    }
+    if (!arrayobject_ptr->shared) {
+        array_shared_t * shared = (array_shared_t *)malloc(sizeof(array_shared_t));
+
+        if (!shared) Err_Throw(Err_New("Cannot share array items"));
+        shared->refs = 1;
+        shared->items = arrayobject_ptr->items.values;
+        shared->size = arrayobject_ptr->capacity * item_sizes[arrayobject_ptr->kind];
+        arrayobject_ptr->shared = shared;
+    }
+    arrayobject_ptr->shared->refs++;
+    slice_ptr->shared = arrayobject_ptr->shared;
+    slice_ptr->kind = arrayobject_ptr->kind;
+    slice_ptr->items.values = (void *)((char *)arrayobject_ptr->items.values
+                                       + index * item_sizes[arrayobject_ptr->kind]);
+    slice_ptr->length = slice_ptr->capacity = length;
+    // the slice references the values of the array without write barrier
+    GC_WRITE_BARRIER(slice_ptr, arrayobject);
+    return slice;
+}
+
 /**
  * Get the length of the arrayobject
  * @param arrayobject A reference to the arrayobject
@@ -125,5 +471,83 @@ nanbox_t ArrayObject_Pop(nanbox_t arrayobject) {
  */
 size_t ArrayObject_GetLength(nanbox_t arrayobject) {
     arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
-    return Vec_GetLength(arrayobject_ptr->items);
+    return arrayobject_ptr->length;
+}
+
+/**
+ * Returns the kind of the items of the arrayobject
+ * @param arrayobject A reference to the arrayobject
+ * @returns           The kind
+ */
+array_kind_t ArrayObject_GetKind(nanbox_t arrayobject) {
+    arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
+    return arrayobject_ptr->kind;
+}
+
+/**
+ * Returns the size of the storage of the items of the arrayobject
+ * @param arrayobject A reference to the arrayobject
+ * @returns           The size, in bytes, a storage shared by several
+ *                    arrayobjects is divided between them
+ */
+size_t ArrayObject_GetItemsSize(nanbox_t arrayobject) {
+    arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
+    if (arrayobject_ptr->shared) {
+        return arrayobject_ptr->shared->size / arrayobject_ptr->shared->refs;
+    }
+    return arrayobject_ptr->capacity * item_sizes[arrayobject_ptr->kind];
+}
+
+/**
+ * Adds the items of the arrayobject, the packed kinds are added without
+ * unboxing them
+ * @param arrayobject A reference to the arrayobject
+ * @returns           The sum or nanbox_null() if an item is not a number
+ */
+nanbox_t ArrayObject_Sum(nanbox_t arrayobject) {
+    arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
+    int64_t int_sum = 0;
+    double sum = 0;
+
+    switch (arrayobject_ptr->kind) {
+        case ARRAY_KIND_INT:
+            // the int64_t sum of less than 2^32 int32_t items can't overflow
+            for (size_t i = 0; i < arrayobject_ptr->length; i++) {
+                int_sum += arrayobject_ptr->items.ints[i];
+            }
+            if (int_sum < INT32_MIN || int_sum > INT32_MAX) return nanbox_from_double((double)int_sum);
+            return nanbox_from_int((int32_t)int_sum);
+        case ARRAY_KIND_DOUBLE:
+            for (size_t i = 0; i < arrayobject_ptr->length; i++) {
+                sum += arrayobject_ptr->items.doubles[i];
+            }
+            return ArrayObject_BoxDouble(sum);
+        case ARRAY_KIND_SPARSE:
+            // the holes are null
+            if (arrayobject_ptr->count < arrayobject_ptr->length) return nanbox_null();
+            for (size_t i = 0; i < arrayobject_ptr->capacity; i++) {
+                nanbox_t item = arrayobject_ptr->items.entries[i].value;
+
+                if (nanbox_is_empty(item)) continue;
+                if (!nanbox_is_number(item)) return nanbox_null();
+                sum += nanbox_to_number(item);
+            }
+            return ArrayObject_BoxDouble(sum);
+        default:
+            for (size_t i = 0; i < arrayobject_ptr->length; i++) {
+                if (!nanbox_is_number(arrayobject_ptr->items.values[i])) return nanbox_null();
+                sum += nanbox_to_number(arrayobject_ptr->items.values[i]);
+            }
+            return ArrayObject_BoxDouble(sum);
+    }
+}
+
+/**
+ * Checks if a value is an arrayobject
+ * @param value The value to check
+ * @returns     Whether the value references an arrayobject
+ */
+bool ArrayObject_Check(nanbox_t value) {
+    return nanbox_is_pointer(value)
+        && ((object_t *)nanbox_to_pointer(value))->type == ARRAY_OBJECT;
 }
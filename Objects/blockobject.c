@@ -0,0 +1,70 @@
+/**
+ * @file blockobject.c
+ * Blocks Implementation
+ */
+#include "blockobject.h"
+#include "object.h"
+#include "objects_types.h"
+#include "nanbox.h"
+#include "gc.h"
+
+static void BlockObject_Trace(void * object_ptr) {
+    blockobject_t * blockobject_ptr = (blockobject_t *)object_ptr;
+    GC_Mark(&blockobject_ptr->outer);
+    GC_Mark(&blockobject_ptr->this);
+}
+
+/**
+ * Allocates a new blockobject
+ * @param[in] code  The compiled code of the block
+ * @param     outer The captured context (or nanbox_null())
+ * @param     this  The value of "this" in the block
+ * @returns         The newly allocated blockobject
+ */
+nanbox_t BlockObject_New(struct code_s * code, nanbox_t outer, nanbox_t this) {
+    blockobject_t * blockobject_ptr;
+    nanbox_t blockobject;
+
+    blockobject = Object_New(sizeof(blockobject_t), NULL, BlockObject_Trace);
+    blockobject_ptr = nanbox_to_pointer(blockobject);
+    blockobject_ptr->type = BLOCK_OBJECT;
+    blockobject_ptr->code = code;
+    blockobject_ptr->outer = outer;
+    blockobject_ptr->outer_frame = NULL;
+    blockobject_ptr->this = this;
+    blockobject_ptr->home_frame = 0;
+    blockobject_ptr->home_activation = 0;
+    return blockobject;
+}
+
+/**
+ * Initializes a blockobject in the storage of the frame that creates it
+ * @param[in] storage     The storage of the block
+ * @param[in] code        The compiled code of the block
+ * @param[in] outer_frame The frame that creates the block
+ * @param     this        The value of "this" in the block
+ * @returns               The blockobject
+ */
+nanbox_t BlockObject_NewInFrame(blockobject_t * storage, struct code_s * code,
+                                struct frame_s * outer_frame, nanbox_t this) {
+    nanbox_t blockobject = Object_NewInFrame(storage, NULL, BlockObject_Trace);
+
+    storage->type = BLOCK_OBJECT;
+    storage->code = code;
+    storage->outer = nanbox_null();
+    storage->outer_frame = outer_frame;
+    storage->this = this;
+    storage->home_frame = 0;
+    storage->home_activation = 0;
+    return blockobject;
+}
+
+/**
+ * Checks if a value is a blockobject
+ * @param value The value to check
+ * @returns     Whether the value references a blockobject
+ */
+bool BlockObject_Check(nanbox_t value) {
+    return nanbox_is_pointer(value)
+        && ((object_t *)nanbox_to_pointer(value))->type == BLOCK_OBJECT;
+}
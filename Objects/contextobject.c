@@ -0,0 +1,37 @@
+/**
+ * @file contextobject.c
+ * Contexts Implementation
+ */
+#include "contextobject.h"
+#include "object.h"
+#include "objects_types.h"
+#include "nanbox.h"
+#include "gc.h"
+
+static void ContextObject_Trace(void * object_ptr) {
+    contextobject_t * contextobject_ptr = (contextobject_t *)object_ptr;
+    GC_MarkAll(contextobject_ptr->values, contextobject_ptr->count);
+    GC_Mark(&contextobject_ptr->parent);
+}
+
+/**
+ * Allocates a new contextobject, all its variables are set to null
+ * @param parent The context of the enclosing block (or nanbox_null())
+ * @param count  The number of variables
+ * @returns      The newly allocated contextobject
+ */
+nanbox_t ContextObject_New(nanbox_t parent, size_t count) {
+    contextobject_t * contextobject_ptr;
+    nanbox_t contextobject;
+
+    contextobject = Object_New(sizeof(contextobject_t) + count * sizeof(nanbox_t),
+                               NULL, ContextObject_Trace);
+    contextobject_ptr = nanbox_to_pointer(contextobject);
+    contextobject_ptr->type = CONTEXT_OBJECT;
+    contextobject_ptr->parent = parent;
+    contextobject_ptr->count = count;
+    for (size_t i = 0; i < count; i++) {
+        contextobject_ptr->values[i] = nanbox_null();
+    }
+    return contextobject;
+}
@@ -0,0 +1,976 @@
+/**
+ * @file gc.c
+ * Generational garbage collector: new objects are allocated by bumping a
+ * pointer in a nursery, the young collections copy the survivors to the
+ * old space, a full collection marks the objects reachable from the roots
+ * and frees the other ones, reference cycles included, a slice at each
+ * safe point. The weak references are cleared and the finalizers queued
+ * once the marking is done. With a pause time the marking runs in slices
+ * too, between which a write barrier keeps track of the mutations
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "gc.h"
+#include "object.h"
+#include "arrayobject.h"
+#include "stringobject.h"
+#include "nanbox.h"
+#include "vector.h"
+#include "Common/include/error.h"
+
+/** Number of gray objects the mark stack grows by */
+#define GC_MARK_STACK_INCREMENT 1024
+
+/** Objects of the nursery are aligned on this size */
+#define GC_ALIGNMENT sizeof(nanbox_t)
+#define GC_ALIGN(size) (((size) + GC_ALIGNMENT - 1) & ~(GC_ALIGNMENT - 1))
+
+typedef struct {
+    gc_roots_func_t func;
+    void * data;
+} gc_roots_t;
+
+typedef struct {
+    object_t * object;
+    gc_weak_func_t func;
+} gc_weak_t;
+
+typedef struct {
+    nanbox_t object;
+    nanbox_t finalizer;
+    gc_finalizer_func_t func;
+    void * data;
+} gc_finalizer_t;
+
+bool gc_mark = true;
+
+bool gc_marking = false;
+
+pool_t gc_pool = POOL_INITIALIZER("objects");
+
+char * gc_nursery_start = NULL;
+char * gc_nursery_end = NULL;
+
+/** Next free byte of the nursery */
+static char * nursery_top = NULL;
+static size_t nursery_objects_count = 0;
+
+/** Whether the running collection is a young one */
+static bool collecting_young = false;
+
+/** Whether the end of an incremental marking scans the roots again */
+static bool remarking = false;
+
+/**
+ * Objects the incremental marking must still trace, while a young
+ * collection uses the mark stack (NULL otherwise)
+ */
+static vector_t * gray_stack = NULL;
+
+/** Longest time of the steps of a full collection, in µs (0 if not incremental) */
+static size_t pause_time = 0;
+
+/** Time before which the program runs without collection steps, in µs */
+static uint64_t next_step = 0;
+
+/** Memory charged to each account, in bytes (see GC_NewAccount) */
+static size_t account_sizes[GC_MAX_ACCOUNTS];
+static bool accounts_used[GC_MAX_ACCOUNTS] = { [GC_NO_ACCOUNT] = true };
+
+/** Account the allocations are charged to */
+static gc_account_t current_account = GC_NO_ACCOUNT;
+
+/** Number of pauses of each range of durations (see GC_PAUSE_RANGES) */
+static size_t pauses[GC_PAUSE_RANGES];
+static size_t max_pause = 0;
+
+/** Old objects that may reference young ones (vector_t<object_t *>) */
+static vector_t * remembered = NULL;
+
+/** All the objects of the old space, linked by their gc_next field */
+static object_t * heap_objects = NULL;
+static size_t heap_objects_count = 0;
+static size_t heap_size = 0;
+
+/** Memory held by the objects besides their storage (see GC_AddExternalSize) */
+static size_t external_size = 0;
+
+/**
+ * Link to the next object the sweep examines, NULL when no sweep is pending.
+ * The objects allocated meanwhile survive the sweep
+ */
+static object_t ** sweep_link = NULL;
+
+/** Counters of GC_GetStats that cannot be computed from the objects */
+static size_t peak_size = 0;
+static size_t allocated_bytes = 0;
+static size_t young_collections = 0;
+static size_t full_collections = 0;
+
+/** Function called at each allocation */
+static gc_allocation_hook_t allocation_hook = NULL;
+static void * allocation_hook_data = NULL;
+
+/** Heap size, external storage included, that triggers the next full collection */
+static size_t heap_threshold = GC_INITIAL_THRESHOLD;
+
+/** Functions that mark the roots */
+static gc_roots_t * roots = NULL;
+static size_t roots_count = 0;
+static size_t roots_capacity = 0;
+
+/** Variables that keep their value alive (vector_t<nanbox_t *>) */
+static vector_t * handles = NULL;
+
+/** Objects whose weak references are processed at the end of the marking */
+static gc_weak_t * weaks = NULL;
+static size_t weaks_count = 0;
+static size_t weaks_capacity = 0;
+
+/** Objects whose collection calls a function */
+static gc_finalizer_t * finalizers = NULL;
+static size_t finalizers_count = 0;
+static size_t finalizers_capacity = 0;
+
+/** Number of values marked so far, tells when the ephemerons stop marking values */
+static size_t marked_count = 0;
+
+/**
+ * Objects marked whose references are not marked yet (vector_t<object_t *>),
+ * the marking doesn't recurse so long chains of objects cannot overflow the C stack
+ */
+static vector_t * mark_stack = NULL;
+
+/**
+ * Returns the time of a monotonic clock, in µs
+ */
+static uint64_t GC_Now(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * Allocates the storage of an object in the old space
+ */
+static object_t * GC_AllocOld(size_t size) {
+    object_t * object = (object_t *)Pool_AllocBlock(&gc_pool, size);
+
+    object->gc_next = heap_objects;
+    object->gc_size = size;
+    object->gc_remembered = false;
+    // an object allocated during an incremental marking survives it, the
+    // values it is initialized with are marked by the next steps
+    object->gc_marked = gc_marking ? gc_mark : !gc_mark;
+    if (gc_marking) Vec_Append(mark_stack, nanbox_from_pointer(object));
+    heap_objects = object;
+    heap_objects_count++;
+    heap_size += size;
+    allocated_bytes += size;
+    return object;
+}
+
+/**
+ * Allocates the storage of a new object in the nursery, or in the old space
+ * if it's too big or the nursery is full
+ * @param size The size of the object
+ * @returns    The storage (the object is initialized by the caller)
+ */
+object_t * GC_Alloc(size_t size) {
+    object_t * object;
+
+#ifdef GC_ALLOCATION_HOOK
+    if (allocation_hook) allocation_hook(size, allocation_hook_data);
+#endif
+    if (!gc_nursery_start) {
+        gc_nursery_start = nursery_top = (char *)malloc(GC_NURSERY_SIZE);
+        if (!gc_nursery_start) Err_Throw(Err_New("Cannot allocate the nursery"));
+        gc_nursery_end = gc_nursery_start + GC_NURSERY_SIZE;
+    }
+    account_sizes[current_account] += size;
+    if (size <= GC_NURSERY_MAX_OBJECT && nursery_top + GC_ALIGN(size) <= gc_nursery_end) {
+        object = (object_t *)nursery_top;
+        nursery_top += GC_ALIGN(size);
+        nursery_objects_count++;
+        object->gc_account = current_account;
+        // a young object has no next object until it is moved to the old space
+        object->gc_next = NULL;
+        object->gc_size = size;
+        object->gc_remembered = false;
+        object->gc_marked = !gc_mark;
+        return object;
+    }
+    // the object is initialized without write barrier, it may reference young objects
+    object = GC_AllocOld(size);
+    object->gc_account = current_account;
+    GC_Remember(object);
+    return object;
+}
+
+/**
+ * Sets the function called at each allocation (see gc_allocation_hook_t)
+ * @param     hook The function or NULL
+ * @param[in] data The data given to the function
+ */
+void GC_SetAllocationHook(gc_allocation_hook_t hook, void * data) {
+    allocation_hook = hook;
+    allocation_hook_data = data;
+}
+
+/**
+ * Stops charging memory to an account, an account isn't charged less than
+ * nothing when it frees memory another one allocated
+ */
+static void GC_Uncharge(gc_account_t account, size_t size) {
+    account_sizes[account] -= size < account_sizes[account] ? size : account_sizes[account];
+}
+
+/**
+ * Releases what an unreachable object holds, charging what it frees to
+ * the account of the object
+ */
+static void GC_ReleaseObject(object_t * object) {
+    gc_account_t account = current_account;
+
+    current_account = object->gc_account;
+    Object_Free(object);
+    current_account = account;
+    GC_Uncharge(object->gc_account, object->gc_size);
+}
+
+/**
+ * Counts memory an object holds besides its storage (slots, items,
+ * characters) in the size of the heap
+ * @param size The size, in bytes
+ */
+void GC_AddExternalSize(size_t size) {
+    external_size += size;
+    account_sizes[current_account] += size;
+}
+
+/**
+ * Stops counting memory given to GC_AddExternalSize, when it is freed
+ * @param size The size, in bytes
+ */
+void GC_RemoveExternalSize(size_t size) {
+    external_size -= size;
+    GC_Uncharge(current_account, size);
+}
+
+/**
+ * Copies a young object to the old space, the young copy keeps the
+ * address of the old one in its gc_next field
+ */
+static object_t * GC_Promote(object_t * object) {
+    object_t * copy = (object_t *)Pool_AllocBlock(&gc_pool, object->gc_size);
+
+    memcpy(copy, object, object->gc_size);
+    if (object->slots == object->inline_slots) copy->slots = copy->inline_slots;
+    copy->gc_next = heap_objects;
+    heap_objects = copy;
+    heap_objects_count++;
+    heap_size += copy->gc_size;
+    object->gc_next = copy;
+    // the cached lookups may hold the previous address of a prototype
+    if (object->in_lookup_cache) object_lookup_epoch++;
+    Vec_Append(mark_stack, nanbox_from_pointer(copy));
+    // the incremental marking may not have seen the old objects it references
+    if (gray_stack) {
+        copy->gc_marked = gc_mark;
+        Vec_Append(gray_stack, nanbox_from_pointer(copy));
+    }
+    return copy;
+}
+
+/**
+ * Marks a value as reachable, the values it references will be marked too.
+ * During a young collection a young value is moved to the old space and the
+ * variable is updated. Only the trace functions of the objects and the
+ * roots functions call it
+ * @param[in] value The variable holding the value
+ */
+void GC_Mark(nanbox_t * value) {
+    object_t * object;
+
+    if (!nanbox_is_pointer(*value) || !(object = nanbox_to_pointer(*value))) return;
+    if (collecting_young) {
+        if (!GC_IsYoung(object)) return;
+        if (!object->gc_next) marked_count++;
+        *value = nanbox_from_pointer(object->gc_next ? object->gc_next : GC_Promote(object));
+        return;
+    }
+    // the young objects are left to the young collections, the frame
+    // objects to the end of the marking
+    if (gc_marking && (GC_IsYoung(object) || object->in_frame)) return;
+    if (object->gc_marked == gc_mark) return;
+    object->gc_marked = gc_mark;
+    marked_count++;
+    Vec_Append(mark_stack, *value);
+}
+
+/**
+ * Marks the values of an array of values
+ * @param[in] values The values
+ * @param     count  Number of values
+ */
+void GC_MarkAll(nanbox_t * values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        GC_Mark(&values[i]);
+    }
+}
+
+/**
+ * Marks the values referenced by an object
+ */
+static void GC_Trace(object_t * object) {
+    GC_MarkAll(object->slots, object->shape->fields_count);
+    GC_Mark(&object->prototype);
+    if (object->trace) object->trace(object);
+}
+
+/**
+ * Marks a root whose references may be written without write barrier: a
+ * young collection also scans it when it is old
+ * @param[in] value The variable holding the value
+ */
+void GC_MarkRoot(nanbox_t * value) {
+    object_t * object;
+
+    GC_Mark(value);
+    if (!nanbox_is_pointer(*value) || !(object = nanbox_to_pointer(*value))) return;
+    // an incremental marking may have traced it before the last writes
+    if ((collecting_young && !GC_IsYoung(object)) || remarking) GC_Trace(object);
+}
+
+/**
+ * Marks a value during an incremental marking, the values it references
+ * will be marked by the next steps (see GC_WRITE_BARRIER)
+ * @param value The value
+ */
+void GC_Shade(nanbox_t value) {
+    if (nanbox_is_pointer(value)) GC_Mark(&value);
+}
+
+/**
+ * Traces again an object given to GC_MarkRoot that stops being a root,
+ * since its references were written without write barrier
+ * @param[in] object The object
+ */
+void GC_Rescan(object_t * object) {
+    if (gc_marking && !GC_IsYoung(object) && object->gc_marked == gc_mark) {
+        Vec_Append(mark_stack, nanbox_from_pointer(object));
+    }
+}
+
+/**
+ * Adds an old object to the objects scanned by the next young collection
+ * (see GC_WRITE_BARRIER)
+ * @param[in] object The object
+ */
+void GC_Remember(object_t * object) {
+    if (!remembered) remembered = Vec_New();
+    object->gc_remembered = true;
+    Vec_Append(remembered, nanbox_from_pointer(object));
+}
+
+/**
+ * Defers the weak references of an object to the end of the marking, only
+ * the trace functions of the objects call it (see gc_weak_func_t)
+ * @param[in] object The object
+ * @param     func   The function that processes its weak references
+ */
+void GC_DeferWeak(object_t * object, gc_weak_func_t func) {
+    if (weaks_count == weaks_capacity) {
+        size_t capacity = weaks_capacity ? weaks_capacity * 2 : 16;
+        gc_weak_t * grown = (gc_weak_t *)realloc(weaks, capacity * sizeof(gc_weak_t));
+
+        if (!grown) Err_Throw(Err_New("Cannot grow the weak objects of the collector"));
+        weaks = grown;
+        weaks_capacity = capacity;
+    }
+    weaks[weaks_count].object = object;
+    weaks[weaks_count].func = func;
+    weaks_count++;
+}
+
+/**
+ * Tells whether the marking reached a value so far, only the functions
+ * given to GC_DeferWeak call it. The variable is updated when the value moved
+ * @param[in] value The variable holding the value
+ * @returns         true if the value is marked or isn't an object
+ */
+bool GC_IsMarked(nanbox_t * value) {
+    object_t * object;
+
+    if (!nanbox_is_pointer(*value) || !(object = nanbox_to_pointer(*value))) return true;
+    if (collecting_young) {
+        // a young collection keeps all the old objects
+        if (!GC_IsYoung(object)) return true;
+        if (!object->gc_next) return false;
+        *value = nanbox_from_pointer(object->gc_next);
+        return true;
+    }
+    return object->gc_marked == gc_mark;
+}
+
+/**
+ * Calls a function once an object is collected, with a value kept alive
+ * until then. The value must not reference the object, else it is never
+ * collected
+ * @param     object    The object
+ * @param     finalizer The value
+ * @param     func      The function
+ * @param[in] data      The data given to the function
+ */
+void GC_AddFinalizer(nanbox_t object, nanbox_t finalizer, gc_finalizer_func_t func, void * data) {
+    if (finalizers_count == finalizers_capacity) {
+        size_t capacity = finalizers_capacity ? finalizers_capacity * 2 : 16;
+        gc_finalizer_t * grown = (gc_finalizer_t *)realloc(finalizers,
+                                                           capacity * sizeof(gc_finalizer_t));
+
+        if (!grown) Err_Throw(Err_New("Cannot grow the finalizers of the collector"));
+        finalizers = grown;
+        finalizers_capacity = capacity;
+    }
+    finalizers[finalizers_count].object = object;
+    finalizers[finalizers_count].finalizer = finalizer;
+    finalizers[finalizers_count].func = func;
+    finalizers[finalizers_count].data = data;
+    finalizers_count++;
+}
+
+/**
+ * Forgets the finalizers given to GC_AddFinalizer with some data
+ * @param[in] data The data
+ */
+void GC_RemoveFinalizers(void * data) {
+    for (size_t i = finalizers_count; i > 0; i--) {
+        if (finalizers[i - 1].data == data) finalizers[i - 1] = finalizers[--finalizers_count];
+    }
+}
+
+/**
+ * Registers a function that marks roots at each collection
+ * @param     func The function
+ * @param[in] data The data given to the function
+ */
+void GC_AddRoots(gc_roots_func_t func, void * data) {
+    if (roots_count == roots_capacity) {
+        size_t capacity = roots_capacity ? roots_capacity * 2 : 4;
+        gc_roots_t * grown = (gc_roots_t *)realloc(roots, capacity * sizeof(gc_roots_t));
+
+        if (!grown) Err_Throw(Err_New("Cannot grow the roots of the collector"));
+        roots = grown;
+        roots_capacity = capacity;
+    }
+    roots[roots_count].func = func;
+    roots[roots_count].data = data;
+    roots_count++;
+}
+
+/**
+ * Unregisters a function given to GC_AddRoots
+ * @param     func The function
+ * @param[in] data The data given to the function
+ */
+void GC_RemoveRoots(gc_roots_func_t func, void * data) {
+    for (size_t i = 0; i < roots_count; i++) {
+        if (roots[i].func == func && roots[i].data == data) {
+            roots[i] = roots[--roots_count];
+            return;
+        }
+    }
+}
+
+/**
+ * Keeps the value of a variable alive until GC_RemoveHandle, for the C code
+ * that holds a value while scripts run. The variable is updated when
+ * the value moves
+ * @param[in] handle The variable
+ */
+void GC_AddHandle(nanbox_t * handle) {
+    if (!handles) handles = Vec_New();
+    Vec_Append(handles, nanbox_from_pointer(handle));
+}
+
+/**
+ * Forgets a variable given to GC_AddHandle
+ * @param[in] handle The variable
+ */
+void GC_RemoveHandle(nanbox_t * handle) {
+    size_t count = handles ? Vec_GetLength(handles) : 0;
+
+    // the handles are usually removed in the reverse order they were added
+    for (size_t i = count; i > 0; i--) {
+        if (nanbox_to_pointer(Vec_GetAt(handles, i - 1)) == handle) {
+            Vec_SetAt(handles, i - 1, Vec_GetAt(handles, count - 1));
+            Vec_Pop(handles);
+            return;
+        }
+    }
+}
+
+/**
+ * Marks the objects referenced by the marked objects
+ */
+static void GC_DrainMarkStack(void) {
+    while (Vec_GetLength(mark_stack) > 0) {
+        GC_Trace(nanbox_to_pointer(Vec_Pop(mark_stack)));
+    }
+}
+
+/**
+ * Processes the weak references once the strong ones are marked: the
+ * ephemerons mark their values until no new value is marked, then the
+ * references to the unmarked values are cleared and the finalizers of the
+ * unmarked objects are called
+ * @param first The first deferred object of the collection, the previous
+ *              ones wait for the end of an incremental marking
+ */
+static void GC_ProcessWeaks(size_t first) {
+    size_t marked;
+
+    do {
+        marked = marked_count;
+        // the objects marked meanwhile are processed by the same loop
+        for (size_t i = first; i < weaks_count; i++) {
+            weaks[i].func(weaks[i].object, false);
+            GC_DrainMarkStack();
+        }
+    } while (marked != marked_count);
+    for (size_t i = first; i < weaks_count; i++) {
+        weaks[i].func(weaks[i].object, true);
+    }
+    weaks_count = first;
+
+    for (size_t i = finalizers_count; i > 0; i--) {
+        gc_finalizer_t finalizer = finalizers[i - 1];
+
+        if (GC_IsMarked(&finalizers[i - 1].object)) continue;
+        finalizers[i - 1] = finalizers[--finalizers_count];
+        finalizer.func(finalizer.finalizer, finalizer.data);
+    }
+}
+
+/**
+ * Marks the roots and the handles, the objects they reach are left in the
+ * mark stack
+ */
+static void GC_MarkRoots(void) {
+    if (!mark_stack) mark_stack = Vec_NewWithIncrementLength(GC_MARK_STACK_INCREMENT);
+    for (size_t i = 0; i < roots_count; i++) {
+        roots[i].func(roots[i].data);
+    }
+    for (size_t i = 0; handles && i < Vec_GetLength(handles); i++) {
+        GC_Mark((nanbox_t *)nanbox_to_pointer(Vec_GetAt(handles, i)));
+    }
+    for (size_t i = 0; i < finalizers_count; i++) {
+        GC_Mark(&finalizers[i].finalizer);
+    }
+    if (collecting_young && remembered) {
+        for (size_t i = 0; i < Vec_GetLength(remembered); i++) {
+            object_t * object = nanbox_to_pointer(Vec_GetAt(remembered, i));
+
+            object->gc_remembered = false;
+            GC_Trace(object);
+        }
+        Vec_Free(remembered);
+        remembered = NULL;
+    }
+}
+
+/**
+ * Marks the roots and the handles then the objects they reach
+ */
+static void GC_MarkFromRoots(void) {
+    size_t first_weak = collecting_young ? weaks_count : 0;
+
+    GC_MarkRoots();
+    GC_DrainMarkStack();
+    GC_ProcessWeaks(first_weak);
+}
+
+/**
+ * Remembers the size of the heap, external storage included, if it's the
+ * highest one
+ */
+static void GC_UpdatePeakSize(void) {
+    size_t size = heap_size + (nursery_top - gc_nursery_start) + external_size;
+
+    if (size > peak_size) peak_size = size;
+}
+
+/**
+ * Moves the objects of the nursery that are reachable from the roots, the
+ * handles and the remembered objects to the old space and empties it
+ */
+void GC_CollectYoung(void) {
+    if (!gc_nursery_start) return;
+    // the heap only shrinks during the collections
+    GC_UpdatePeakSize();
+    allocated_bytes += nursery_top - gc_nursery_start;
+    young_collections++;
+    if (gc_marking) {
+        // the survivors join the objects the incremental marking traces
+        gray_stack = mark_stack;
+        mark_stack = Vec_NewWithIncrementLength(GC_MARK_STACK_INCREMENT);
+    }
+    collecting_young = true;
+    GC_MarkFromRoots();
+    collecting_young = false;
+    if (gray_stack) {
+        Vec_Free(mark_stack);
+        mark_stack = gray_stack;
+        gray_stack = NULL;
+    }
+
+    // the objects left behind only need to release what they hold
+    for (char * cursor = gc_nursery_start; cursor < nursery_top; ) {
+        object_t * object = (object_t *)cursor;
+
+        cursor += GC_ALIGN(object->gc_size);
+        if (!object->gc_next) GC_ReleaseObject(object);
+    }
+    nursery_top = gc_nursery_start;
+    nursery_objects_count = 0;
+}
+
+/**
+ * Marks the objects reachable from the roots and the handles, the other
+ * objects of the old space are freed by the sweep that follows
+ */
+static void GC_MarkHeap(void) {
+    // the survivors of the nursery are marked with the old objects
+    GC_CollectYoung();
+    full_collections++;
+    GC_MarkFromRoots();
+    // the survivors are unmarked for the next collection, the sweep frees
+    // the objects without the previous mark, the new objects get it
+    gc_mark = !gc_mark;
+    sweep_link = &heap_objects;
+}
+
+/**
+ * Marks the roots to start an incremental marking, the objects they reach
+ * are marked by GC_MarkStep
+ */
+static void GC_StartMarking(void) {
+    // the survivors of the nursery are marked with the old objects
+    GC_CollectYoung();
+    full_collections++;
+    gc_marking = true;
+    GC_MarkRoots();
+}
+
+/**
+ * Ends an incremental marking: the roots are marked again since they are
+ * written without write barrier, then the unreachable objects are left to
+ * the sweep
+ */
+static void GC_FinishMarking(void) {
+    GC_CollectYoung();
+    gc_marking = false;
+    remarking = true;
+    GC_MarkFromRoots();
+    remarking = false;
+    gc_mark = !gc_mark;
+    sweep_link = &heap_objects;
+}
+
+/**
+ * Marks objects of an incremental marking until a time, the marking ends
+ * when all the reachable objects are marked
+ * @param deadline The time, in µs
+ */
+static void GC_MarkStep(uint64_t deadline) {
+    size_t count = 0;
+
+    while (Vec_GetLength(mark_stack) > 0) {
+        GC_Trace(nanbox_to_pointer(Vec_Pop(mark_stack)));
+        if (++count % GC_STEP_OBJECTS == 0 && GC_Now() >= deadline) return;
+    }
+    GC_FinishMarking();
+}
+
+/**
+ * Frees some of the unreachable objects left by the last marking
+ * @param budget Number of objects to examine
+ * @retval true if the sweep is done
+ * @retval false if objects remain to be examined
+ */
+bool GC_SweepStep(size_t budget) {
+    if (!sweep_link) return true;
+    GC_UpdatePeakSize();
+    while (*sweep_link && budget > 0) {
+        object_t * object = *sweep_link;
+
+        if (object->gc_marked != gc_mark) {
+            sweep_link = &object->gc_next;
+        } else {
+            *sweep_link = object->gc_next;
+            heap_objects_count--;
+            heap_size -= object->gc_size;
+            GC_ReleaseObject(object);
+            Pool_FreeBlock(&gc_pool, object, object->gc_size);
+        }
+        budget--;
+    }
+    if (*sweep_link) return false;
+    sweep_link = NULL;
+    heap_threshold = (heap_size + external_size) * GC_GROWTH_FACTOR;
+    if (heap_threshold < GC_INITIAL_THRESHOLD) heap_threshold = GC_INITIAL_THRESHOLD;
+    return true;
+}
+
+/**
+ * Marks the objects reachable from the roots and the handles, the
+ * unreachable ones are freed by the next calls to GC_SweepStep
+ */
+void GC_CollectLazily(void) {
+    if (gc_marking) GC_FinishMarking();
+    // the objects the previous sweep didn't examine carry the mark of its marking
+    GC_SweepStep(SIZE_MAX);
+    GC_MarkHeap();
+}
+
+/**
+ * Starts a collection whose marking and sweep run a step at each safe
+ * point (see GC_SetPauseTime)
+ */
+void GC_CollectIncrementally(void) {
+    if (gc_marking) GC_FinishMarking();
+    GC_SweepStep(SIZE_MAX);
+    GC_StartMarking();
+}
+
+/**
+ * Tells whether a collection is in progress
+ * @returns true if a marking or a sweep remains to be done
+ */
+bool GC_IsCollecting(void) {
+    return gc_marking || sweep_link;
+}
+
+/**
+ * Frees the objects that cannot be reached from the roots and the handles
+ */
+void GC_Collect(void) {
+    GC_CollectLazily();
+    GC_SweepStep(SIZE_MAX);
+}
+
+/**
+ * Counts a pause of the program in the statistics
+ * @param duration The duration, in µs
+ */
+static void GC_AddPause(uint64_t duration) {
+    size_t range = 0;
+
+    while (range < GC_PAUSE_RANGES - 1 && duration >> range) range++;
+    pauses[range]++;
+    if (duration > max_pause) max_pause = duration;
+}
+
+/**
+ * GC_CollectIfNeeded when the pause time is set: the young collections
+ * happen as usual, the full collections in steps separated by as long as
+ * the pause time
+ */
+static void GC_CollectIncrementallyIfNeeded(void) {
+    uint64_t start;
+
+    if (nursery_top - gc_nursery_start >= GC_NURSERY_LIMIT) {
+        start = GC_Now();
+        GC_CollectYoung();
+    } else if (gc_marking || sweep_link) {
+        start = GC_Now();
+        if (start < next_step) return;
+        if (gc_marking) {
+            GC_MarkStep(start + pause_time);
+        } else {
+            while (!GC_SweepStep(GC_STEP_OBJECTS) && GC_Now() < start + pause_time);
+        }
+    } else if (heap_size + external_size >= heap_threshold) {
+        start = GC_Now();
+        GC_StartMarking();
+    } else {
+        return;
+    }
+    next_step = GC_Now();
+    GC_AddPause(next_step - start);
+    next_step += pause_time;
+}
+
+/**
+ * Runs a collection if the nursery or the heap grew enough since the last
+ * one, or continues the marking or the sweep of the last one. Only called
+ * where every live value is reachable from the roots or the handles
+ */
+void GC_CollectIfNeeded(void) {
+    uint64_t start;
+
+    if (pause_time) {
+        GC_CollectIncrementallyIfNeeded();
+        return;
+    }
+    if (sweep_link && nursery_top - gc_nursery_start >= GC_NURSERY_LIMIT) {
+        // the nursery fills up during a long sweep too
+        start = GC_Now();
+        GC_CollectYoung();
+    } else if (sweep_link) {
+        start = GC_Now();
+        GC_SweepStep(GC_SWEEP_BUDGET);
+    } else if (heap_size + external_size >= heap_threshold) {
+        start = GC_Now();
+        GC_CollectLazily();
+    } else if (nursery_top - gc_nursery_start >= GC_NURSERY_LIMIT) {
+        start = GC_Now();
+        GC_CollectYoung();
+    } else {
+        return;
+    }
+    GC_AddPause(GC_Now() - start);
+}
+
+/**
+ * Sets the longest time a safe point spends on a full collection: the
+ * marking and the sweep are done in steps of this time, the program runs
+ * as long between two steps. The young collections and the end of the
+ * marking, that scans the roots again, are not split
+ * @param microseconds The time, 0 (the default) marks the heap at once
+ */
+void GC_SetPauseTime(size_t microseconds) {
+    pause_time = microseconds;
+}
+
+/**
+ * Creates a heap account (see gc_account_t)
+ * @returns The account
+ */
+gc_account_t GC_NewAccount(void) {
+    for (size_t account = 0; account < GC_MAX_ACCOUNTS; account++) {
+        if (!accounts_used[account]) {
+            accounts_used[account] = true;
+            account_sizes[account] = 0;
+            return (gc_account_t)account;
+        }
+    }
+    Err_Throw(Err_New("Too many heap accounts"));
+    return GC_NO_ACCOUNT;
+}
+
+/**
+ * Deletes an account given by GC_NewAccount, the memory charged to it is
+ * charged to GC_NO_ACCOUNT
+ * @param account The account
+ */
+void GC_FreeAccount(gc_account_t account) {
+    for (object_t * object = heap_objects; object; object = object->gc_next) {
+        if (object->gc_account == account) object->gc_account = GC_NO_ACCOUNT;
+    }
+    for (char * cursor = gc_nursery_start; cursor < nursery_top; ) {
+        object_t * object = (object_t *)cursor;
+
+        cursor += GC_ALIGN(object->gc_size);
+        if (object->gc_account == account) object->gc_account = GC_NO_ACCOUNT;
+    }
+    account_sizes[GC_NO_ACCOUNT] += account_sizes[account];
+    account_sizes[account] = 0;
+    accounts_used[account] = false;
+    if (current_account == account) current_account = GC_NO_ACCOUNT;
+}
+
+/**
+ * Charges the next allocations, and the memory given to GC_AddExternalSize,
+ * to an account
+ * @param account The account, GC_NO_ACCOUNT by default
+ */
+void GC_SetAccount(gc_account_t account) {
+    current_account = account;
+}
+
+/**
+ * Returns the memory charged to an account that is not freed yet: its
+ * objects, garbage included until the next collection, and the memory
+ * they hold besides their storage
+ * @param account The account
+ * @returns       The size, in bytes
+ */
+size_t GC_GetAccountSize(gc_account_t account) {
+    return account_sizes[account];
+}
+
+/**
+ * Adds an object to the statistics
+ */
+static void GC_CountObject(gc_stats_t * stats, object_t * object) {
+    stats->objects[object->type]++;
+    stats->objects_bytes += object->gc_size;
+    if (object->slots != object->inline_slots) {
+        stats->slots_bytes += object->slots_capacity * sizeof(nanbox_t);
+    }
+    if (object->type == ARRAY_OBJECT) {
+        stats->arrays_bytes += ArrayObject_GetItemsSize(nanbox_from_pointer(object));
+    } else if (object->type == STRING_OBJECT) {
+        stats->strings_bytes += ((stringobject_t *)object)->length + 1;
+    }
+}
+
+/**
+ * Computes the statistics of the heap, by walking all its objects
+ * @returns The statistics
+ */
+gc_stats_t GC_GetStats(void) {
+    gc_stats_t stats = { 0 };
+    double seconds = (double)clock() / CLOCKS_PER_SEC;
+
+    for (object_t * object = heap_objects; object; object = object->gc_next) {
+        GC_CountObject(&stats, object);
+    }
+    for (char * cursor = gc_nursery_start; cursor < nursery_top; ) {
+        object_t * object = (object_t *)cursor;
+
+        cursor += GC_ALIGN(object->gc_size);
+        GC_CountObject(&stats, object);
+    }
+    GC_UpdatePeakSize();
+    stats.heap_size = heap_size;
+    stats.nursery_size = nursery_top - gc_nursery_start;
+    stats.peak_size = peak_size;
+    stats.allocated_bytes = allocated_bytes + stats.nursery_size;
+    stats.allocation_rate = seconds > 0 ? stats.allocated_bytes / seconds : 0;
+    stats.young_collections = young_collections;
+    stats.full_collections = full_collections;
+    for (size_t i = 0; i < GC_PAUSE_RANGES; i++) {
+        stats.pauses += pauses[i];
+    }
+    stats.max_pause = max_pause;
+    for (size_t i = 0, count = 0; i < GC_PAUSE_RANGES && stats.pauses; i++) {
+        count += pauses[i];
+        if (count * 100 >= stats.pauses * 99) {
+            stats.p99_pause = (size_t)1 << i;
+            break;
+        }
+    }
+    return stats;
+}
+
+/**
+ * Returns the size of the heap: the old space, the nursery and the memory
+ * the objects hold besides their storage
+ * @returns The size, in bytes, garbage included until the next collection
+ */
+size_t GC_GetHeapSize(void) {
+    return heap_size + (nursery_top - gc_nursery_start) + external_size;
+}
+
+/**
+ * Returns the number of objects in the heap
+ * @returns The number of objects, garbage included until the next collection
+ */
+size_t GC_GetObjectsCount(void) {
+    return heap_objects_count + nursery_objects_count;
+}
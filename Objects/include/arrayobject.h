@@ -3,13 +3,78 @@
  * Arrays Implementation
  */
 #pragma once
+#include <stdint.h>
 #include "object.h"
 #include "vector.h"
 #include "nanbox.h"
 
+/** Capacity of the items of an array at its first append */
+#define ARRAY_INITIAL_CAPACITY 8
+
+/**
+ * Number of holes a store after the end of an array may leave, a store
+ * further away that leaves it less than half full makes it sparse
+ */
+#define ARRAY_MAX_GAP 64
+
+/**
+ * Kinds of the items of an array, from the most to the least specific.
+ * The packed kinds store the numbers without boxing, an array moves to a
+ * less specific kind on the first store of an item it can't hold
+ */
+typedef enum {
+    /** Integers, stored as int32_t */
+    ARRAY_KIND_INT,
+    /** Numbers, stored as double */
+    ARRAY_KIND_DOUBLE,
+    /** Any values, stored as nanbox_t */
+    ARRAY_KIND_GENERIC,
+    /**
+     * Any values, stored with their index in a hash table, for the arrays
+     * with large holes. The array is dense again once half of it is filled
+     */
+    ARRAY_KIND_SPARSE
+} array_kind_t;
+
+/**
+ * Entry of a sparse array, the free entries hold nanbox_empty()
+ */
+typedef struct {
+    size_t index;
+    nanbox_t value;
+} array_entry_t;
+
+/**
+ * Storage of the items of an array shared with its slices, until one of
+ * them is modified
+ */
+typedef struct {
+    /** Number of arrays using it */
+    size_t refs;
+    /** The allocated storage, each array uses a part of it */
+    void * items;
+    /** Its size, in bytes */
+    size_t size;
+} array_shared_t;
+
 typedef struct {
     OBJECT_HEAD;
-    vector_t * items;
+    array_kind_t kind;
+    /** Storage of the items, the member in use depends on the kind */
+    union {
+        int32_t * ints;
+        double * doubles;
+        nanbox_t * values;
+        array_entry_t * entries;
+    } items;
+    /** Highest index + 1, the holes read as null */
+    size_t length;
+    /** Number of items, or of entries of a sparse array */
+    size_t capacity;
+    /** Number of used entries of a sparse array */
+    size_t count;
+    /** Storage the items are part of, NULL when the array owns them */
+    array_shared_t * shared;
 } arrayobject_t;
 
 /**
@@ -22,12 +87,12 @@ nanbox_t ArrayObject_New(void);
  * Retrieves a stored element in the arrayobject
  * @param arrayobject A reference to the arrayobject
  * @param index       The index of the element in the arrayobject
- * @returns           The stored element
+ * @returns           The stored element, null for a hole
  */
 nanbox_t ArrayObject_GetAt(nanbox_t arrayobject, ssize_t index);
 
 /**
- * Stores an element in the arrayobject
+ * Stores an element in the arrayobject, a store after the end extends it
  * @param arrayobject A reference to the arrayobject
  * @param index      The index of the element in the arrayobject
  * @param item       The element to be stored
@@ -48,9 +113,49 @@ void ArrayObject_Append(nanbox_t arrayobject, nanbox_t item);
  */
 nanbox_t ArrayObject_Pop(nanbox_t arrayobject);
 
+/**
+ * Creates an arrayobject holding some of the items of another one, they are
+ * only copied once one of the two arrayobjects is modified
+ * @param arrayobject A reference to the arrayobject
+ * @param index       Index of the first item
+ * @param length      Number of items, they must be in the arrayobject
+ * @returns           The new arrayobject
+ */
+nanbox_t ArrayObject_Slice(nanbox_t arrayobject, size_t index, size_t length);
+
 /**
  * Get the length of the arrayobject
  * @param arrayobject A reference to the arrayobject
  * @returns           The arrayobject length
  */
 size_t ArrayObject_GetLength(nanbox_t arrayobject);
+
+/**
+ * Returns the kind of the items of the arrayobject
+ * @param arrayobject A reference to the arrayobject
+ * @returns           The kind
+ */
+array_kind_t ArrayObject_GetKind(nanbox_t arrayobject);
+
+/**
+ * Returns the size of the storage of the items of the arrayobject
+ * @param arrayobject A reference to the arrayobject
+ * @returns           The size, in bytes, a storage shared by several
+ *                    arrayobjects is divided between them
+ */
+size_t ArrayObject_GetItemsSize(nanbox_t arrayobject);
+
+/**
+ * Adds the items of the arrayobject, the packed kinds are added without
+ * unboxing them
+ * @param arrayobject A reference to the arrayobject
+ * @returns           The sum or nanbox_null() if an item is not a number
+ */
+nanbox_t ArrayObject_Sum(nanbox_t arrayobject);
+
+/**
+ * Checks if a value is an arrayobject
+ * @param value The value to check
+ * @returns     Whether the value references an arrayobject
+ */
+bool ArrayObject_Check(nanbox_t value);
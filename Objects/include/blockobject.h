@@ -0,0 +1,59 @@
+/**
+ * @file blockobject.h
+ * Blocks Implementation
+ */
+#pragma once
+#include "object.h"
+#include "nanbox.h"
+
+struct code_s;
+struct frame_s;
+
+typedef struct {
+    OBJECT_HEAD;
+    /** The compiled code of the block (owned by the interpreter) */
+    struct code_s * code;
+    /** The context the block captured its outer variables from (or null) */
+    nanbox_t outer;
+    /**
+     * Frame that created the block when it lives in that frame (or NULL),
+     * the block reads its outer variables directly from there
+     */
+    struct frame_s * outer_frame;
+    /** Value of "this" when the block was created */
+    nanbox_t this;
+    /**
+     * Activation of the method the block was created in, directly or through
+     * other blocks: the index of its frame and its activation number (0 if
+     * the block was not created in a method). "^" in the block returns from it
+     */
+    size_t home_frame;
+    size_t home_activation;
+} blockobject_t;
+
+/**
+ * Allocates a new blockobject
+ * @param[in] code  The compiled code of the block
+ * @param     outer The captured context (or nanbox_null())
+ * @param     this  The value of "this" in the block
+ * @returns         The newly allocated blockobject
+ */
+nanbox_t BlockObject_New(struct code_s * code, nanbox_t outer, nanbox_t this);
+
+/**
+ * Initializes a blockobject in the storage of the frame that creates it
+ * @param[in] storage     The storage of the block
+ * @param[in] code        The compiled code of the block
+ * @param[in] outer_frame The frame that creates the block
+ * @param     this        The value of "this" in the block
+ * @returns               The blockobject
+ */
+nanbox_t BlockObject_NewInFrame(blockobject_t * storage, struct code_s * code,
+                                struct frame_s * outer_frame, nanbox_t this);
+
+/**
+ * Checks if a value is a blockobject
+ * @param value The value to check
+ * @returns     Whether the value references a blockobject
+ */
+bool BlockObject_Check(nanbox_t value);
@@ -0,0 +1,28 @@
+/**
+ * @file contextobject.h
+ * Contexts Implementation
+ * A context stores the local variables of a block or method activation
+ * when they can be captured by inner blocks
+ */
+#pragma once
+#include <sys/types.h>
+#include "object.h"
+#include "nanbox.h"
+
+typedef struct {
+    OBJECT_HEAD;
+    /** Context of the enclosing block or method (or null) */
+    nanbox_t parent;
+    /** Number of variables */
+    size_t count;
+    /** The variables */
+    nanbox_t values[];
+} contextobject_t;
+
+/**
+ * Allocates a new contextobject, all its variables are set to null
+ * @param parent The context of the enclosing block (or nanbox_null())
+ * @param count  The number of variables
+ * @returns      The newly allocated contextobject
+ */
+nanbox_t ContextObject_New(nanbox_t parent, size_t count);
@@ -0,0 +1,403 @@
+/**
+ * @file gc.h
+ * Generational garbage collector: new objects are allocated by bumping a
+ * pointer in a nursery, the young collections copy the survivors to the
+ * old space, a full collection marks the objects reachable from the roots
+ * and frees the other ones, reference cycles included, a slice at each
+ * safe point. The weak references are cleared and the finalizers queued
+ * once the marking is done. With a pause time the marking runs in slices
+ * too, between which a write barrier keeps track of the mutations
+ */
+#pragma once
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "nanbox.h"
+#include "pool.h"
+#include "objects_types.h"
+
+struct object_s;
+
+/** Heap size that triggers the first full collection, in bytes */
+#define GC_INITIAL_THRESHOLD (1024 * 1024)
+
+/** The next full collection happens when the heap is this many times the surviving size */
+#define GC_GROWTH_FACTOR 2
+
+/** Number of objects a safe point examines while a sweep is pending */
+#define GC_SWEEP_BUDGET 4096
+
+/** Number of objects an incremental step examines between two readings of the clock */
+#define GC_STEP_OBJECTS 256
+
+/** Number of ranges of pause times, the range i holds the pauses shorter than 2^i µs */
+#define GC_PAUSE_RANGES 32
+
+/** Size of the nursery, in bytes */
+#define GC_NURSERY_SIZE (1024 * 1024)
+
+/**
+ * Nursery usage that triggers a young collection at the next safe point,
+ * the rest absorbs the allocations made until then
+ */
+#define GC_NURSERY_LIMIT (GC_NURSERY_SIZE / 4 * 3)
+
+/** Number of heap accounts that can exist at once, the account 0 included */
+#define GC_MAX_ACCOUNTS 1024
+
+/** Account of the allocations made outside the accounts of GC_NewAccount */
+#define GC_NO_ACCOUNT 0
+
+/** Objects bigger than this are directly allocated in the old space */
+#define GC_NURSERY_MAX_OBJECT (GC_NURSERY_SIZE / 64)
+
+/**
+ * Identifies a heap account: the memory allocated while it is the current
+ * account is charged to it until it is freed, so that the programs sharing
+ * the heap can each be given a limit
+ */
+typedef uint16_t gc_account_t;
+
+/**
+ * Statistics of the heap, the objects not freed yet are counted until a
+ * collection frees them
+ */
+typedef struct {
+    /** Number of objects of each type */
+    size_t objects[OBJECT_TYPES_COUNT];
+    /** Size of the objects themselves, in bytes */
+    size_t objects_bytes;
+    /** Size of the fields that don't fit in the objects, in bytes */
+    size_t slots_bytes;
+    /** Size of the items of the arrays, in bytes */
+    size_t arrays_bytes;
+    /** Size of the characters of the strings, in bytes */
+    size_t strings_bytes;
+    /** Size of the old space, in bytes */
+    size_t heap_size;
+    /** Size of the objects of the nursery, in bytes */
+    size_t nursery_size;
+    /** Highest size of the heap, as given by GC_GetHeapSize, in bytes */
+    size_t peak_size;
+    /** Size of the objects allocated since the program started, in bytes */
+    size_t allocated_bytes;
+    /** Bytes allocated per second of processor time */
+    double allocation_rate;
+    size_t young_collections;
+    size_t full_collections;
+    /** Number of times the safe points collected */
+    size_t pauses;
+    /** Longest pause of the safe points, in µs */
+    size_t max_pause;
+    /** Duration 99% of the pauses don't exceed, in µs (rounded up to a power of 2) */
+    size_t p99_pause;
+} gc_stats_t;
+
+/**
+ * Marks the values a part of the program keeps alive with GC_Mark
+ * @param[in] data The data given to GC_AddRoots
+ */
+typedef void (*gc_roots_func_t)(void * data);
+
+/**
+ * Called with the size of each allocated object, only by the builds that
+ * define GC_ALLOCATION_HOOK (make PROFILE=allocations)
+ * @param     size The size of the object
+ * @param[in] data The data given to GC_SetAllocationHook
+ */
+typedef void (*gc_allocation_hook_t)(size_t size, void * data);
+
+/**
+ * Processes the weak references of an object given to GC_DeferWeak once
+ * the marking is done, with GC_IsMarked
+ * @param[in] object The object
+ * @param     clear  false while the marking goes on: the values the weak
+ *                   references keep alive are marked with GC_Mark when
+ *                   their referents are marked (ephemerons). true when
+ *                   it's done: the references to the unmarked values
+ *                   are cleared
+ */
+typedef void (*gc_weak_func_t)(void * object, bool clear);
+
+/**
+ * Called when an object given to GC_AddFinalizer is collected
+ * @param     finalizer The value given with the object
+ * @param[in] data      The data given to GC_AddFinalizer
+ */
+typedef void (*gc_finalizer_func_t)(nanbox_t finalizer, void * data);
+
+/**
+ * Value of the mark of the objects reached by the current collection, it flips
+ * after each collection so that the survivors don't need to be unmarked
+ */
+extern bool gc_mark;
+
+/**
+ * Whether an incremental marking is in progress, the write barrier then
+ * marks the stored values
+ */
+extern bool gc_marking;
+
+/** Pool of the objects of the old space and of their slots */
+extern pool_t gc_pool;
+
+/** Bounds of the nursery, NULL until the first allocation */
+extern char * gc_nursery_start;
+extern char * gc_nursery_end;
+
+/** Whether an object lives in the nursery */
+#define GC_IsYoung(object) ((char *)(object) >= gc_nursery_start && (char *)(object) < gc_nursery_end)
+
+/** Whether a value references an object of the nursery */
+#define GC_IsYoungValue(value) (nanbox_is_pointer(value) && GC_IsYoung(nanbox_to_pointer(value)))
+
+/**
+ * Write barrier: must follow the stores of values in objects, so that the
+ * young collections know the old objects that reference young ones and an
+ * incremental marking doesn't miss the values stored in objects it already
+ * traced. The stack, the globals and the contexts and blocks of the active
+ * frames are scanned at each collection and don't need it
+ * @param object The object written to (a pointer)
+ * @param value  The stored value
+ */
+#define GC_WRITE_BARRIER(object, value) \
+    do { \
+        if (!(object)->gc_remembered && GC_IsYoungValue(value) && !GC_IsYoung(object)) { \
+            GC_Remember((struct object_s *)(object)); \
+        } \
+        if (gc_marking) GC_Shade(value); \
+    } while (0)
+
+/**
+ * Allocates the storage of a new object in the nursery, or in the old space
+ * if it's too big or the nursery is full
+ * @param size The size of the object
+ * @returns    The storage (the object is initialized by the caller)
+ */
+struct object_s * GC_Alloc(size_t size);
+
+/**
+ * Sets the function called at each allocation (see gc_allocation_hook_t)
+ * @param     hook The function or NULL
+ * @param[in] data The data given to the function
+ */
+void GC_SetAllocationHook(gc_allocation_hook_t hook, void * data);
+
+/**
+ * Counts memory an object holds besides its storage (slots, items,
+ * characters) in the size of the heap
+ * @param size The size, in bytes
+ */
+void GC_AddExternalSize(size_t size);
+
+/**
+ * Stops counting memory given to GC_AddExternalSize, when it is freed
+ * @param size The size, in bytes
+ */
+void GC_RemoveExternalSize(size_t size);
+
+/**
+ * Marks a value as reachable, the values it references will be marked too.
+ * During a young collection a young value is moved to the old space and the
+ * variable is updated. Only the trace functions of the objects and the
+ * roots functions call it
+ * @param[in] value The variable holding the value
+ */
+void GC_Mark(nanbox_t * value);
+
+/**
+ * Marks the values of an array of values
+ * @param[in] values The values
+ * @param     count  Number of values
+ */
+void GC_MarkAll(nanbox_t * values, size_t count);
+
+/**
+ * Marks a root whose references may be written without write barrier: a
+ * young collection also scans it when it is old
+ * @param[in] value The variable holding the value
+ */
+void GC_MarkRoot(nanbox_t * value);
+
+/**
+ * Defers the weak references of an object to the end of the marking, only
+ * the trace functions of the objects call it (see gc_weak_func_t)
+ * @param[in] object The object
+ * @param     func   The function that processes its weak references
+ */
+void GC_DeferWeak(struct object_s * object, gc_weak_func_t func);
+
+/**
+ * Tells whether the marking reached a value so far, only the functions
+ * given to GC_DeferWeak call it. The variable is updated when the value moved
+ * @param[in] value The variable holding the value
+ * @returns         true if the value is marked or isn't an object
+ */
+bool GC_IsMarked(nanbox_t * value);
+
+/**
+ * Calls a function once an object is collected, with a value kept alive
+ * until then. The value must not reference the object, else it is never
+ * collected
+ * @param     object    The object
+ * @param     finalizer The value
+ * @param     func      The function
+ * @param[in] data      The data given to the function
+ */
+void GC_AddFinalizer(nanbox_t object, nanbox_t finalizer, gc_finalizer_func_t func, void * data);
+
+/**
+ * Forgets the finalizers given to GC_AddFinalizer with some data
+ * @param[in] data The data
+ */
+void GC_RemoveFinalizers(void * data);
+
+/**
+ * Marks a value during an incremental marking, the values it references
+ * will be marked by the next steps (see GC_WRITE_BARRIER)
+ * @param value The value
+ */
+void GC_Shade(nanbox_t value);
+
+/**
+ * Traces again an object given to GC_MarkRoot that stops being a root,
+ * since its references were written without write barrier
+ * @param[in] object The object
+ */
+void GC_Rescan(struct object_s * object);
+
+/**
+ * Adds an old object to the objects scanned by the next young collection
+ * (see GC_WRITE_BARRIER)
+ * @param[in] object The object
+ */
+void GC_Remember(struct object_s * object);
+
+/**
+ * Registers a function that marks roots at each collection
+ * @param     func The function
+ * @param[in] data The data given to the function
+ */
+void GC_AddRoots(gc_roots_func_t func, void * data);
+
+/**
+ * Unregisters a function given to GC_AddRoots
+ * @param     func The function
+ * @param[in] data The data given to the function
+ */
+void GC_RemoveRoots(gc_roots_func_t func, void * data);
+
+/**
+ * Keeps the value of a variable alive until GC_RemoveHandle, for the C code
+ * that holds a value while scripts run. The variable is updated when
+ * the value moves
+ * @param[in] handle The variable
+ */
+void GC_AddHandle(nanbox_t * handle);
+
+/**
+ * Forgets a variable given to GC_AddHandle
+ * @param[in] handle The variable
+ */
+void GC_RemoveHandle(nanbox_t * handle);
+
+/**
+ * Moves the objects of the nursery that are reachable from the roots, the
+ * handles and the remembered objects to the old space and empties it
+ */
+void GC_CollectYoung(void);
+
+/**
+ * Marks the objects reachable from the roots and the handles, the
+ * unreachable ones are freed by the next calls to GC_SweepStep
+ */
+void GC_CollectLazily(void);
+
+/**
+ * Frees some of the unreachable objects left by the last marking
+ * @param budget Number of objects to examine
+ * @retval true if the sweep is done
+ * @retval false if objects remain to be examined
+ */
+bool GC_SweepStep(size_t budget);
+
+/**
+ * Starts a collection whose marking and sweep run a step at each safe
+ * point (see GC_SetPauseTime)
+ */
+void GC_CollectIncrementally(void);
+
+/**
+ * Tells whether a collection is in progress
+ * @returns true if a marking or a sweep remains to be done
+ */
+bool GC_IsCollecting(void);
+
+/**
+ * Frees the objects that cannot be reached from the roots and the handles
+ */
+void GC_Collect(void);
+
+/**
+ * Runs a collection if the nursery or the heap grew enough since the last
+ * one, or continues the marking or the sweep of the last one. Only called
+ * where every live value is reachable from the roots or the handles
+ */
+void GC_CollectIfNeeded(void);
+
+/**
+ * Sets the longest time a safe point spends on a full collection: the
+ * marking and the sweep are done in steps of this time, the program runs
+ * as long between two steps. The young collections and the end of the
+ * marking, that scans the roots again, are not split
+ * @param microseconds The time, 0 (the default) marks the heap at once
+ */
+void GC_SetPauseTime(size_t microseconds);
+
+/**
+ * Creates a heap account (see gc_account_t)
+ * @returns The account
+ */
+gc_account_t GC_NewAccount(void);
+
+/**
+ * Deletes an account given by GC_NewAccount, the memory charged to it is
+ * charged to GC_NO_ACCOUNT
+ * @param account The account
+ */
+void GC_FreeAccount(gc_account_t account);
+
+/**
+ * Charges the next allocations, and the memory given to GC_AddExternalSize,
+ * to an account
+ * @param account The account, GC_NO_ACCOUNT by default
+ */
+void GC_SetAccount(gc_account_t account);
+
+/**
+ * Returns the memory charged to an account that is not freed yet: its
+ * objects, garbage included until the next collection, and the memory
+ * they hold besides their storage
+ * @param account The account
+ * @returns       The size, in bytes
+ */
+size_t GC_GetAccountSize(gc_account_t account);
+
+/**
+ * Computes the statistics of the heap, by walking all its objects
+ * @returns The statistics
+ */
+gc_stats_t GC_GetStats(void);
+
+/**
+ * Returns the size of the heap: the old space, the nursery and the memory
+ * the objects hold besides their storage
+ * @returns The size, in bytes, garbage included until the next collection
+ */
+size_t GC_GetHeapSize(void);
+
+/**
+ * Returns the number of objects in the heap
+ * @returns The number of objects, garbage included until the next collection
+ */
+size_t GC_GetObjectsCount(void);
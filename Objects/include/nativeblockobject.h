@@ -0,0 +1,53 @@
+/**
+ * @file nativeblockobject.h
+ * Native blocks Implementation
+ * A native block wraps a C function so it can be sent as a message
+ */
+#pragma once
+#include <sys/types.h>
+#include <stdint.h>
+#include "object.h"
+#include "nanbox.h"
+
+struct interpreter_s;
+
+/** Number of parameters of a native block that accepts any number of arguments */
+#define NATIVE_BLOCK_VARIADIC SIZE_MAX
+
+/**
+ * Signature of the C functions wrapped by native blocks
+ * @param[in] interp The interpreter
+ * @param     this   The receiver of the message (borrowed)
+ * @param[in] args   The arguments of the message (borrowed)
+ * @param     argc   The number of arguments
+ * @returns          The result of the message (owned by the caller)
+ */
+typedef nanbox_t (*native_block_func_t)(struct interpreter_s * interp, nanbox_t this,
+                                        nanbox_t * args, size_t argc);
+
+typedef struct {
+    OBJECT_HEAD;
+    native_block_func_t func;
+    /** Number of expected arguments */
+    size_t params_count;
+    /**
+     * Whether the function only calls the blocks it receives and doesn't keep
+     * them, the blocks can then stay in the frame of the sender
+     */
+    bool borrows_blocks;
+} nativeblockobject_t;
+
+/**
+ * Allocates a new nativeblockobject
+ * @param func         The C function to wrap
+ * @param params_count The number of arguments the function expects
+ * @returns            The newly allocated nativeblockobject
+ */
+nanbox_t NativeBlockObject_New(native_block_func_t func, size_t params_count);
+
+/**
+ * Checks if a value is a nativeblockobject
+ * @param value The value to check
+ * @returns     Whether the value references a nativeblockobject
+ */
+bool NativeBlockObject_Check(nanbox_t value);
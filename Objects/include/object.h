@@ -6,37 +6,92 @@
 
 #include <sys/types.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "hashmap.h"
 #include "vector.h"
 #include "nanbox.h"
 #include "objects_types.h"
-#include "object_tracker.h"
+#include "shape.h"
 
 typedef struct object_s object_t;
 
 #define OBJECT_CUSTOM_FREE_SIGNATURE(function_name) void (*function_name)(void *)
 
-#define OBJECT_HEAD size_t ref_count; \
-    hashmap_t * fields; \
+/**
+ * Marks the values an object references besides its fields and its
+ * prototype, with GC_Mark
+ */
+#define OBJECT_TRACE_SIGNATURE(function_name) void (*function_name)(void *)
+
+/** Number of fields an object stores without allocating a slots array */
+#define OBJECT_INLINE_SLOTS 4
+
+/** Number of entries of the global lookup cache (a power of 2, see Object_Lookup) */
+#define OBJECT_LOOKUP_CACHE_SIZE 1024
+
+#define OBJECT_HEAD struct object_s * gc_next; \
+    size_t gc_size; \
+    bool gc_marked; \
+    bool gc_remembered; \
+    /* heap account the object is charged to (see GC_NewAccount) */ \
+    uint16_t gc_account; \
+    shape_t * shape; \
+    nanbox_t * slots; \
+    size_t slots_capacity; \
+    nanbox_t inline_slots[OBJECT_INLINE_SLOTS]; \
     nanbox_t prototype; \
     bool freezed; \
     object_type_t type; \
     OBJECT_CUSTOM_FREE_SIGNATURE(custom_free); \
-    object_tracker_t * object_tracker;
+    OBJECT_TRACE_SIGNATURE(trace); \
+    size_t id; \
+    bool in_lookup_cache; \
+    bool in_frame;
+
+/**
+ * Incremented each time a cached message lookup may become wrong: a field
+ * is added to an object that took part in a cached lookup as a prototype,
+ * or the prototype of such an object changes
+ */
+extern size_t object_lookup_epoch;
 
 typedef struct object_s {
     OBJECT_HEAD
 } object_t;
 
-#define NEW_FROM_TYPE(object_type) Object_New(sizeof(object_type))
+#define NEW_FROM_TYPE(object_type) Object_New(sizeof(object_type), NULL, NULL)
 
-nanbox_t Object_New(size_t object_size, OBJECT_CUSTOM_FREE_SIGNATURE(custom_free));
-void Object_Free(nanbox_t * object);
-void Object_AddTracker(nanbox_t object, object_tracker_t * object_tracker);
-void Object_IncRef(nanbox_t object);
-void Object_DecRef(nanbox_t * object);
+// the object is allocated and freed by the collector (see gc.h)
+nanbox_t Object_New(size_t object_size, OBJECT_CUSTOM_FREE_SIGNATURE(custom_free),
+                    OBJECT_TRACE_SIGNATURE(trace));
+// the object lives in storage owned by an interpreter frame, the collector doesn't free it
+nanbox_t Object_NewInFrame(void * storage, OBJECT_CUSTOM_FREE_SIGNATURE(custom_free),
+                           OBJECT_TRACE_SIGNATURE(trace));
+// releases what an unreachable object holds, its storage is freed by its owner
+void Object_Free(object_t * object);
 void Object_Freeze(nanbox_t object);
+// field names are symbols (see Symbol_Intern)
 void Object_SetField(nanbox_t object, char * name, nanbox_t value);
 nanbox_t Object_GetField(nanbox_t object, char * name);
+/**
+ * Looks for a field in an object then in its prototypes. The result is
+ * kept in a global cache indexed by the shape and the prototype of the
+ * object and the name, until object_lookup_epoch changes
+ * @param      object The object, NULL is returned if it's not one
+ * @param[in]  name   The name of the field (a symbol)
+ * @param[out] slot   The slot of the field in the object that holds it
+ * @returns           The object that holds the field or NULL if not found
+ */
+object_t * Object_Lookup(nanbox_t object, char * name, size_t * slot);
+/**
+ * Reads a property an object computes from its state instead of storing
+ * it in a field, like the length of the arrays. Object_GetField falls
+ * back to them when no field has the name
+ * @param      object The object
+ * @param[in]  name   The name of the property (a symbol)
+ * @param[out] value  The value of the property
+ * @returns           true if the object has such a property
+ */
+bool Object_GetIntrinsic(nanbox_t object, char * name, nanbox_t * value);
 void Object_SetPrototype(nanbox_t object, nanbox_t prototype);
 nanbox_t Object_GetPrototype(nanbox_t object);
@@ -6,5 +6,12 @@
 typedef enum {
     OBJECT,
     ARRAY_OBJECT,
-    NATIVE_BLOCK
+    NATIVE_BLOCK,
+    STRING_OBJECT,
+    BLOCK_OBJECT,
+    CONTEXT_OBJECT,
+    WEAKREF_OBJECT,
+    WEAKMAP_OBJECT
 } object_type_t;
+
+#define OBJECT_TYPES_COUNT (WEAKMAP_OBJECT + 1)
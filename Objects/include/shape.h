@@ -0,0 +1,89 @@
+/**
+ * @file shape.h
+ * Hidden classes shared by the objects that got the same fields
+ * in the same order
+ */
+#pragma once
+#include <sys/types.h>
+#include "hashmap.h"
+#include "vector.h"
+
+/** Above this number of fields a shape indexes its fields in a hashmap */
+#define SHAPE_LINEAR_LOOKUP_MAX 8
+
+typedef struct shape_s shape_t;
+
+/**
+ * Node of the transition tree: the root shape has no field and each
+ * child adds one field to its parent. The field added by a shape is
+ * stored in the slot fields_count - 1 of the objects
+ */
+struct shape_s {
+    size_t ref_count;
+
+    /** Unique identifier, never reused */
+    size_t id;
+
+    /** Shape this one derives from (owned reference), NULL for the root */
+    shape_t * parent;
+
+    /** Name of the field added by this shape (a symbol), NULL for the root */
+    char * name;
+
+    /** Number of fields */
+    size_t fields_count;
+
+    /**
+     * Shapes derived from this one, indexed by the name of the added field
+     * (borrowed references, a shape leaves its parent transitions when freed)
+     * hashmap_t<shape_t *>
+     */
+    hashmap_t * transitions;
+
+    /**
+     * Slots of the fields, built on the first lookup of a large shape
+     * hashmap_t<int>
+     */
+    hashmap_t * slots;
+};
+
+/**
+ * Returns the shape of the objects without fields
+ * @returns The root shape (borrowed reference)
+ */
+shape_t * Shape_Root(void);
+
+/**
+ * Takes a new reference to a shape
+ * @param[in] shape The shape
+ */
+void Shape_IncRef(shape_t * shape);
+
+/**
+ * Releases a reference to a shape, it is freed with its last reference
+ * @param[in] shape The shape
+ */
+void Shape_DecRef(shape_t * shape);
+
+/**
+ * Follows or creates the transition that adds a field
+ * @param[in] shape The shape
+ * @param[in] name  The name of the field (a symbol)
+ * @returns         The shape with the added field (new reference)
+ */
+shape_t * Shape_AddField(shape_t * shape, char * name);
+
+/**
+ * Finds the slot of a field
+ * @param[in] shape The shape
+ * @param[in] name  The name of the field (a symbol)
+ * @returns         The slot or -1 if the shape has no such field
+ */
+ssize_t Shape_Lookup(shape_t * shape, char * name);
+
+/**
+ * Returns the names of the fields in slot order
+ * @param[in] shape The shape
+ * @returns         The names (vector_t<char *> of symbols)
+ */
+vector_t * Shape_GetNames(shape_t * shape);
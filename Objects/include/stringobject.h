@@ -0,0 +1,50 @@
+/**
+ * @file stringobject.h
+ * Strings Implementation
+ */
+#pragma once
+#include <sys/types.h>
+#include "object.h"
+#include "nanbox.h"
+
+typedef struct {
+    OBJECT_HEAD;
+    char * value;
+    size_t length;
+} stringobject_t;
+
+/**
+ * Allocates a new stringobject
+ * @param[in] value The C string to build the stringobject from
+ *                  (a copy will be performed)
+ * @returns         The newly allocated stringobject
+ */
+nanbox_t StringObject_New(char * value);
+
+/**
+ * Allocates a new stringobject that takes ownership of an allocated C string
+ * @param[in] value The C string (will be freed with the stringobject)
+ * @returns         The newly allocated stringobject
+ */
+nanbox_t StringObject_NewFromBuffer(char * value);
+
+/**
+ * Retrieves the C string stored in the stringobject
+ * @param stringobject A reference to the stringobject
+ * @returns            The C string (do not free it)
+ */
+char * StringObject_GetValue(nanbox_t stringobject);
+
+/**
+ * Get the length of the stringobject
+ * @param stringobject A reference to the stringobject
+ * @returns            The stringobject length
+ */
+size_t StringObject_GetLength(nanbox_t stringobject);
+
+/**
+ * Checks if a value is a stringobject
+ * @param value The value to check
+ * @returns     Whether the value references a stringobject
+ */
+bool StringObject_Check(nanbox_t value);
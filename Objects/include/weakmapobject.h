@@ -0,0 +1,75 @@
+/**
+ * @file weakmapobject.h
+ * Weak maps Implementation
+ * A weak map associates values to objects without keeping the objects
+ * alive: an entry is removed when its key is collected, and its value is
+ * only kept alive by the map while the key is (an ephemeron)
+ */
+#pragma once
+#include <stdbool.h>
+#include "object.h"
+#include "nanbox.h"
+
+/** Number of entries of a new weakmapobject (power of 2) */
+#define WEAKMAP_INITIAL_CAPACITY 8
+
+typedef struct {
+    /** The key object (or null for a free entry) */
+    nanbox_t key;
+    nanbox_t value;
+} weakmap_entry_t;
+
+typedef struct {
+    OBJECT_HEAD;
+    /** The entries, by hash of the identifier of their key */
+    weakmap_entry_t * entries;
+    /** Number of entries (power of 2) */
+    size_t capacity;
+    /** Number of used entries */
+    size_t count;
+} weakmapobject_t;
+
+/**
+ * Allocates a new empty weakmapobject
+ * @returns The newly allocated weakmapobject
+ */
+nanbox_t WeakMapObject_New(void);
+
+/**
+ * Retrieves the value associated to a key
+ * @param weakmapobject A reference to the weakmapobject
+ * @param key           The key (an object)
+ * @returns             The value or null if the key isn't in the map
+ */
+nanbox_t WeakMapObject_Get(nanbox_t weakmapobject, nanbox_t key);
+
+/**
+ * Associates a value to a key
+ * @param weakmapobject A reference to the weakmapobject
+ * @param key           The key (an object)
+ * @param value         The value
+ */
+void WeakMapObject_Set(nanbox_t weakmapobject, nanbox_t key, nanbox_t value);
+
+/**
+ * Removes a key and its value
+ * @param weakmapobject A reference to the weakmapobject
+ * @param key           The key (an object)
+ * @returns             Whether the key was in the map
+ */
+bool WeakMapObject_Remove(nanbox_t weakmapobject, nanbox_t key);
+
+/**
+ * Get the number of entries of the weakmapobject
+ * @param weakmapobject A reference to the weakmapobject
+ * @returns             The number of keys, the collected ones are removed
+ *                      by the collections
+ */
+size_t WeakMapObject_GetCount(nanbox_t weakmapobject);
+
+/**
+ * Checks if a value is a weakmapobject
+ * @param value The value to check
+ * @returns     Whether the value references a weakmapobject
+ */
+bool WeakMapObject_Check(nanbox_t value);
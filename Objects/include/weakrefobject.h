@@ -0,0 +1,37 @@
+/**
+ * @file weakrefobject.h
+ * Weak references Implementation
+ * A weak reference doesn't keep its referent alive, it is cleared when
+ * the referent is collected
+ */
+#pragma once
+#include <stdbool.h>
+#include "object.h"
+#include "nanbox.h"
+
+typedef struct {
+    OBJECT_HEAD;
+    /** The referent (or null once collected) */
+    nanbox_t referent;
+} weakrefobject_t;
+
+/**
+ * Allocates a new weakrefobject
+ * @param referent The referenced value
+ * @returns        The newly allocated weakrefobject
+ */
+nanbox_t WeakRefObject_New(nanbox_t referent);
+
+/**
+ * Retrieves the referent of a weakrefobject
+ * @param weakrefobject A reference to the weakrefobject
+ * @returns             The referent or null if it was collected
+ */
+nanbox_t WeakRefObject_Get(nanbox_t weakrefobject);
+
+/**
+ * Checks if a value is a weakrefobject
+ * @param value The value to check
+ * @returns     Whether the value references a weakrefobject
+ */
+bool WeakRefObject_Check(nanbox_t value);
@@ -0,0 +1,37 @@
+/**
+ * @file nativeblockobject.c
+ * Native blocks Implementation
+ */
+#include "nativeblockobject.h"
+#include "object.h"
+#include "objects_types.h"
+#include "nanbox.h"
+
+/**
+ * Allocates a new nativeblockobject
+ * @param func         The C function to wrap
+ * @param params_count The number of arguments the function expects
+ * @returns            The newly allocated nativeblockobject
+ */
+nanbox_t NativeBlockObject_New(native_block_func_t func, size_t params_count) {
+    nativeblockobject_t * nativeblockobject_ptr;
+    nanbox_t nativeblockobject;
+
+    nativeblockobject = Object_New(sizeof(nativeblockobject_t), NULL, NULL);
+    nativeblockobject_ptr = nanbox_to_pointer(nativeblockobject);
+    nativeblockobject_ptr->type = NATIVE_BLOCK;
+    nativeblockobject_ptr->func = func;
+    nativeblockobject_ptr->params_count = params_count;
+    nativeblockobject_ptr->borrows_blocks = false;
+    return nativeblockobject;
+}
+
+/**
+ * Checks if a value is a nativeblockobject
+ * @param value The value to check
+ * @returns     Whether the value references a nativeblockobject
+ */
+bool NativeBlockObject_Check(nanbox_t value) {
+    return nanbox_is_pointer(value)
+        && ((object_t *)nanbox_to_pointer(value))->type == NATIVE_BLOCK;
+}
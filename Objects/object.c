@@ -4,117 +4,224 @@
  */
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "object.h"
+#include "arrayobject.h"
+#include "symbol.h"
+#include "gc.h"
+#include "shape.h"
 #include "location.h"
 #include "Common/include/error.h"
 #include "hashmap.h"
 #include "nanbox.h"
 #include "vector.h"
 
-nanbox_t Object_New(size_t object_size, OBJECT_CUSTOM_FREE_SIGNATURE(custom_free)) {
-    object_t * object = NULL;
-
-    object = (object_t *)malloc(object_size);
-    if (object) {
-        object->ref_count = 1;
-        object->freezed = false;
-        object->fields = HashMap_New();
-        object->prototype = nanbox_null(); /// @todo base object
-        object->type = OBJECT;
-        object->custom_free = custom_free;
-    } else {
-        loc_t loc = { __LINE__, 0, __FILE__ };
-        Err_Throw(Err_NewWithLocation("Cannot allocate new object", loc));
+size_t object_lookup_epoch = 0;
+
+/** Identifier of the next allocated object, identifiers are never reused */
+static size_t next_object_id = 1;
+
+/**
+ * Result of a lookup through the prototypes, valid for the objects with
+ * the same shape and the same prototype until object_lookup_epoch changes
+ */
+typedef struct {
+    size_t shape_id;
+    /** Id of the prototype of the object, 0 if it has none */
+    size_t proto_id;
+    /** Symbol that was looked up, NULL for an unused entry */
+    char * name;
+    size_t epoch;
+    /** Object that holds the field, NULL when it's the object itself */
+    object_t * holder;
+    size_t slot;
+} object_lookup_entry_t;
+
+/** Lookups indexed by shape, prototype and name (see Object_Lookup) */
+static object_lookup_entry_t lookup_cache[OBJECT_LOOKUP_CACHE_SIZE];
+
+/**
+ * Invalidates the cached lookups if an object took part in one of them
+ */
+static void Object_LayoutChanged(object_t * object_ptr) {
+    if (object_ptr->in_lookup_cache) {
+        object_lookup_epoch++;
     }
+}
 
-    return nanbox_from_pointer(object);
+static void Object_Init(object_t * object, OBJECT_CUSTOM_FREE_SIGNATURE(custom_free),
+                        OBJECT_TRACE_SIGNATURE(trace)) {
+    object->freezed = false;
+    object->shape = Shape_Root();
+    Shape_IncRef(object->shape);
+    object->slots = object->inline_slots;
+    object->slots_capacity = OBJECT_INLINE_SLOTS;
+    object->prototype = nanbox_null(); /// @todo base object
+    object->type = OBJECT;
+    object->custom_free = custom_free;
+    object->trace = trace;
+    object->id = next_object_id++;
+    object->in_lookup_cache = false;
+    object->in_frame = false;
 }
 
-void Object_Free(nanbox_t * object) {
-    object_t * object_ptr;
+nanbox_t Object_New(size_t object_size, OBJECT_CUSTOM_FREE_SIGNATURE(custom_free),
+                    OBJECT_TRACE_SIGNATURE(trace)) {
+    object_t * object = GC_Alloc(object_size);
 
-    if (nanbox_is_pointer(*object) && (object_ptr = nanbox_to_pointer(*object))) {
-        vector_t * fields = HashMap_GetValues(object_ptr->fields);
-        nanbox_t proto = Object_GetPrototype(*object);
+    Object_Init(object, custom_free, trace);
+    return nanbox_from_pointer(object);
+}
 
-        for (size_t i = 0; i < Vec_GetLength(fields); i++) {
-            nanbox_t field = Vec_GetAt(fields, i);
-            if (nanbox_is_pointer(field)) {
-                Object_DecRef(&field);
-            }
-        }
-        if (nanbox_is_pointer(proto)) {
-            Object_DecRef(&proto);
-        }
-        Vec_Free(fields);
-        HashMap_Free(object_ptr->fields);
+nanbox_t Object_NewInFrame(void * storage, OBJECT_CUSTOM_FREE_SIGNATURE(custom_free),
+                           OBJECT_TRACE_SIGNATURE(trace)) {
+    object_t * object = (object_t *)storage;
 
-        // use custom free function for special objects
-        if (object_ptr->custom_free) {
-            object_ptr->custom_free(object_ptr);
-        }
+    Object_Init(object, custom_free, trace);
+    object->in_frame = true;
+    // the collector scans the frame objects at each collection, they are
+    // never added to the remembered objects
+    object->gc_marked = !gc_mark;
+    object->gc_next = NULL;
+    object->gc_remembered = true;
+    object->gc_account = GC_NO_ACCOUNT;
+    return nanbox_from_pointer(object);
+}
 
-        free(object_ptr);
-        *object = nanbox_deleted();
-    } else if (nanbox_is_deleted(*object)) {
-        loc_t loc = { __LINE__, 0, __FILE__ };
-        Err_Throw(Err_NewWithLocation("Object already freed", loc));
-    } else {
-        loc_t loc = { __LINE__, 0, __FILE__ };
-        Err_Throw(Err_NewWithLocation("NaN boxed value is not an object", loc));
+void Object_Free(object_t * object) {
+    if (!object) {
+        loc_t loc = { __LINE__ + 1, 0, __FILE__ };
+        Err_Throw(Err_NewWithLocation("NULL pointer to object", loc));
+    }
+    // the referenced objects are freed by the collector when they
+    // become unreachable too, they may already be freed
+    if (object->slots != object->inline_slots) {
+        Pool_FreeBlock(&gc_pool, object->slots, object->slots_capacity * sizeof(nanbox_t));
+        GC_RemoveExternalSize(object->slots_capacity * sizeof(nanbox_t));
+    }
+    Shape_DecRef(object->shape);
+
+    // use custom free function for special objects
+    if (object->custom_free) {
+        object->custom_free(object);
     }
 }
 
-void Object_AddTracker(nanbox_t object, object_tracker_t * object_tracker) {
+void Object_Freeze(nanbox_t object) {
     if (nanbox_is_pointer(object)) {
         object_t * obj_ptr = nanbox_to_pointer(object);
-        obj_ptr->object_tracker = object_tracker;
+        obj_ptr->freezed = true;
     } else {
         loc_t loc = {__LINE__ + 1, 0, __FILE__};
         Err_Throw(Err_NewWithLocation("NaN boxed value is not an object", loc));
     }
 }
 
-void Object_IncRef(nanbox_t object) {
+/**
+ * Adds a field to an object, the object takes a new shape
+ */
+static void Object_AddField(object_t * obj_ptr, char * name, nanbox_t value) {
+    shape_t * shape = Shape_AddField(obj_ptr->shape, name);
+    size_t slot = obj_ptr->shape->fields_count;
+
+    if (slot == obj_ptr->slots_capacity) {
+        size_t capacity = obj_ptr->slots_capacity * 2;
+        nanbox_t * slots = (nanbox_t *)Pool_AllocBlock(&gc_pool, capacity * sizeof(nanbox_t));
+
+        memcpy(slots, obj_ptr->slots, slot * sizeof(nanbox_t));
+        if (obj_ptr->slots != obj_ptr->inline_slots) {
+            Pool_FreeBlock(&gc_pool, obj_ptr->slots, obj_ptr->slots_capacity * sizeof(nanbox_t));
+            GC_RemoveExternalSize(obj_ptr->slots_capacity * sizeof(nanbox_t));
+        }
+        GC_AddExternalSize(capacity * sizeof(nanbox_t));
+        obj_ptr->slots = slots;
+        obj_ptr->slots_capacity = capacity;
+    }
+    obj_ptr->slots[slot] = value;
+    Shape_DecRef(obj_ptr->shape);
+    obj_ptr->shape = shape;
+    Object_LayoutChanged(obj_ptr);
+}
+
+void Object_SetField(nanbox_t object, char * name, nanbox_t value) {
     if (nanbox_is_pointer(object)) {
         object_t * obj_ptr = nanbox_to_pointer(object);
-        obj_ptr->ref_count++;
+        ssize_t slot = Shape_Lookup(obj_ptr->shape, name);
+
+        if (slot >= 0) {
+            obj_ptr->slots[slot] = value;
+        } else {
+            Object_AddField(obj_ptr, name, value);
+        }
+        GC_WRITE_BARRIER(obj_ptr, value);
     } else {
         loc_t loc = {__LINE__ + 1, 0, __FILE__};
         Err_Throw(Err_NewWithLocation("NaN boxed value is not an object", loc));
     }
 }
 
-void Object_DecRef(nanbox_t * object) {
-    if (nanbox_is_pointer(*object)) {
-        object_t * obj_ptr = nanbox_to_pointer(*object);
-        obj_ptr->ref_count--;
-        if (obj_ptr->ref_count < 1) {
-            Object_Free(object);
+/**
+ * Looks for a field through the prototypes without the cache, the
+ * prototypes are flagged so that changing them invalidates the cache
+ */
+static object_t * Object_LookupUncached(object_t * obj_ptr, char * name, size_t * slot) {
+    while (obj_ptr) {
+        ssize_t found = Shape_Lookup(obj_ptr->shape, name);
+
+        if (found >= 0) {
+            *slot = found;
+            return obj_ptr;
         }
-    } else {
-        loc_t loc = {__LINE__ + 1, 0, __FILE__};
-        Err_Throw(Err_NewWithLocation("NaN boxed value is not an object", loc));
+        if (!nanbox_is_pointer(obj_ptr->prototype)) break;
+        obj_ptr = nanbox_to_pointer(obj_ptr->prototype);
+        obj_ptr->in_lookup_cache = true;
     }
+    return NULL;
 }
 
-void Object_Freeze(nanbox_t object) {
-    if (nanbox_is_pointer(object)) {
-        object_t * obj_ptr = nanbox_to_pointer(object);
-        obj_ptr->freezed = true;
-    } else {
-        loc_t loc = {__LINE__ + 1, 0, __FILE__};
-        Err_Throw(Err_NewWithLocation("NaN boxed value is not an object", loc));
+object_t * Object_Lookup(nanbox_t object, char * name, size_t * slot) {
+    object_t * obj_ptr;
+    object_t * holder;
+    object_lookup_entry_t * cached;
+    size_t proto_id;
+    size_t hash;
+
+    if (!nanbox_is_pointer(object)) return NULL;
+    obj_ptr = nanbox_to_pointer(object);
+    proto_id = nanbox_is_pointer(obj_ptr->prototype)
+        ? ((object_t *)nanbox_to_pointer(obj_ptr->prototype))->id : 0;
+    hash = (obj_ptr->shape->id * 31 + proto_id) * 31 ^ (uintptr_t)name >> 3;
+    cached = &lookup_cache[hash & (OBJECT_LOOKUP_CACHE_SIZE - 1)];
+    if (cached->name == name && cached->shape_id == obj_ptr->shape->id
+            && cached->proto_id == proto_id && cached->epoch == object_lookup_epoch) {
+        *slot = cached->slot;
+        return cached->holder ? cached->holder : obj_ptr;
+    }
+    holder = Object_LookupUncached(obj_ptr, name, slot);
+    // the misses are not remembered, the field may be added to any object
+    if (holder) {
+        cached->shape_id = obj_ptr->shape->id;
+        cached->proto_id = proto_id;
+        cached->name = name;
+        cached->epoch = object_lookup_epoch;
+        cached->holder = holder == obj_ptr ? NULL : holder;
+        cached->slot = *slot;
     }
+    return holder;
 }
 
-void Object_SetField(nanbox_t object, char * name, nanbox_t value) {
-    if (nanbox_is_pointer(object)) {
-        object_t * obj_ptr = nanbox_to_pointer(object);
-        HashMap_Set(obj_ptr->fields, name, value);
-    } else {
-        loc_t loc = {__LINE__ + 1, 0, __FILE__};
-        Err_Throw(Err_NewWithLocation("NaN boxed value is not an object", loc));
+bool Object_GetIntrinsic(nanbox_t object, char * name, nanbox_t * value) {
+    static char * length = NULL;
+
+    if (!nanbox_is_pointer(object)) return false;
+    if (!length) length = Symbol_Intern("length");
+    switch (((object_t *)nanbox_to_pointer(object))->type) {
+        case ARRAY_OBJECT:
+            if (name != length) return false;
+            *value = nanbox_from_int(ArrayObject_GetLength(object));
+            return true;
+        default:
+            return false;
     }
 }
 
@@ -122,14 +229,13 @@ nanbox_t Object_GetField(nanbox_t object, char * name) {
     nanbox_t val = nanbox_null();
 
     if (nanbox_is_pointer(object)) {
-        object_t * obj_ptr = nanbox_to_pointer(object);
-        if (!HashMap_Get(obj_ptr->fields, name, &val)) {
-            nanbox_t proto = Object_GetPrototype(object);
-            if (nanbox_is_pointer(proto)) {
-                val = Object_GetField(proto, name);
-            } else {
-                val = nanbox_null();
-            }
+        size_t slot;
+        object_t * holder = Object_Lookup(object, name, &slot);
+
+        if (holder) {
+            val = holder->slots[slot];
+        } else {
+            Object_GetIntrinsic(object, name, &val);
         }
     } else {
         loc_t loc = {__LINE__ + 1, 0, __FILE__};
@@ -143,6 +249,8 @@ void Object_SetPrototype(nanbox_t object, nanbox_t prototype) {
     if (nanbox_is_pointer(object)) {
         object_t * obj_ptr = nanbox_to_pointer(object);
         obj_ptr->prototype = prototype;
+        GC_WRITE_BARRIER(obj_ptr, prototype);
+        Object_LayoutChanged(obj_ptr);
     } else {
         loc_t loc = {__LINE__ + 1, 0, __FILE__};
         Err_Throw(Err_NewWithLocation("NaN boxed value is not an object", loc));
@@ -0,0 +1,141 @@
+/**
+ * @file shape.c
+ * Hidden classes shared by the objects that got the same fields
+ * in the same order
+ */
+#include <stdlib.h>
+#include "shape.h"
+#include "hashmap.h"
+#include "vector.h"
+#include "nanbox.h"
+#include "Common/include/error.h"
+
+/** Shape of the objects without fields, it is never freed */
+static shape_t * root_shape = NULL;
+
+/** Identifier of the next allocated shape, 0 is kept for non-objects */
+static size_t next_shape_id = 1;
+
+static shape_t * Shape_New(shape_t * parent, char * name) {
+    shape_t * shape = (shape_t *)malloc(sizeof(shape_t));
+
+    if (shape) {
+        shape->ref_count = 1;
+        shape->id = next_shape_id++;
+        shape->parent = parent;
+        shape->name = name;
+        shape->fields_count = parent ? parent->fields_count + 1 : 0;
+        shape->transitions = NULL;
+        shape->slots = NULL;
+        if (parent) Shape_IncRef(parent);
+    } else {
+        Err_Throw(Err_New("Cannot allocate shape"));
+    }
+    return shape;
+}
+
+static void Shape_Free(shape_t * shape) {
+    shape_t * parent = shape->parent;
+
+    if (parent) {
+        HashMap_Remove(parent->transitions, shape->name);
+    }
+    if (shape->transitions) HashMap_Free(shape->transitions);
+    if (shape->slots) HashMap_Free(shape->slots);
+    free(shape);
+    if (parent) Shape_DecRef(parent);
+}
+
+/**
+ * Returns the shape of the objects without fields
+ * @returns The root shape (borrowed reference)
+ */
+shape_t * Shape_Root(void) {
+    if (!root_shape) root_shape = Shape_New(NULL, NULL);
+    return root_shape;
+}
+
+/**
+ * Takes a new reference to a shape
+ * @param[in] shape The shape
+ */
+void Shape_IncRef(shape_t * shape) {
+    if (!shape) Err_Throw(Err_New("NULL pointer to shape"));
+    shape->ref_count++;
+}
+
+/**
+ * Releases a reference to a shape, it is freed with its last reference
+ * @param[in] shape The shape
+ */
+void Shape_DecRef(shape_t * shape) {
+    if (!shape) Err_Throw(Err_New("NULL pointer to shape"));
+    if (--shape->ref_count < 1) {
+        Shape_Free(shape);
+    }
+}
+
+/**
+ * Follows or creates the transition that adds a field
+ * @param[in] shape The shape
+ * @param[in] name  The name of the field (a symbol)
+ * @returns         The shape with the added field (new reference)
+ */
+shape_t * Shape_AddField(shape_t * shape, char * name) {
+    nanbox_t child;
+
+    if (!shape->transitions) {
+        shape->transitions = HashMap_NewWithCapacity(4);
+    }
+    if (HashMap_Get(shape->transitions, name, &child)) {
+        Shape_IncRef(nanbox_to_pointer(child));
+        return nanbox_to_pointer(child);
+    }
+    child = nanbox_from_pointer(Shape_New(shape, name));
+    HashMap_Set(shape->transitions, name, child);
+    return nanbox_to_pointer(child);
+}
+
+/**
+ * Finds the slot of a field
+ * @param[in] shape The shape
+ * @param[in] name  The name of the field (a symbol)
+ * @returns         The slot or -1 if the shape has no such field
+ */
+ssize_t Shape_Lookup(shape_t * shape, char * name) {
+    nanbox_t slot;
+
+    if (shape->fields_count <= SHAPE_LINEAR_LOOKUP_MAX) {
+        for (shape_t * cur = shape; cur->parent; cur = cur->parent) {
+            if (cur->name == name) return cur->fields_count - 1;
+        }
+        return -1;
+    }
+    if (!shape->slots) {
+        shape->slots = HashMap_NewWithCapacity(shape->fields_count * 2);
+        for (shape_t * cur = shape; cur->parent; cur = cur->parent) {
+            HashMap_Set(shape->slots, cur->name, nanbox_from_int(cur->fields_count - 1));
+        }
+    }
+    if (HashMap_Get(shape->slots, name, &slot)) {
+        return nanbox_to_int(slot);
+    }
+    return -1;
+}
+
+/**
+ * Returns the names of the fields in slot order
+ * @param[in] shape The shape
+ * @returns         The names (vector_t<char *> of symbols)
+ */
+vector_t * Shape_GetNames(shape_t * shape) {
+    vector_t * names = Vec_NewWithIncrementLength(shape->fields_count ? shape->fields_count : 1);
+
+    for (size_t i = 0; i < shape->fields_count; i++) {
+        Vec_Append(names, nanbox_null());
+    }
+    for (shape_t * cur = shape; cur->parent; cur = cur->parent) {
+        Vec_SetAt(names, cur->fields_count - 1, nanbox_from_pointer(cur->name));
+    }
+    return names;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file stringobject.c
+ * Strings Implementation
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "stringobject.h"
+#include "object.h"
+#include "objects_types.h"
+#include "gc.h"
+#include "nanbox.h"
+#include "Common/include/error.h"
+
+static void StringObject_CustomFree(void * object_ptr) {
+    stringobject_t * stringobject_ptr = (stringobject_t *)object_ptr;
+    GC_RemoveExternalSize(stringobject_ptr->length + 1);
+    free(stringobject_ptr->value);
+}
+
+/**
+ * Allocates a new stringobject that takes ownership of an allocated C string
+ * @param[in] value The C string (will be freed with the stringobject)
+ * @returns         The newly allocated stringobject
+ */
+nanbox_t StringObject_NewFromBuffer(char * value) {
+    stringobject_t * stringobject_ptr;
+    nanbox_t stringobject;
+
+    if (!value) Err_Throw(Err_New("NULL pointer to string value"));
+    stringobject = Object_New(sizeof(stringobject_t), StringObject_CustomFree, NULL);
+    stringobject_ptr = nanbox_to_pointer(stringobject);
+    stringobject_ptr->type = STRING_OBJECT;
+    stringobject_ptr->value = value;
+    stringobject_ptr->length = strlen(value);
+    GC_AddExternalSize(stringobject_ptr->length + 1);
+    return stringobject;
+}
+
+/**
+ * Allocates a new stringobject
+ * @param[in] value The C string to build the stringobject from
+ *                  (a copy will be performed)
+ * @returns         The newly allocated stringobject
+ */
+nanbox_t StringObject_New(char * value) {
+    char * copy;
+
+    if (!value) Err_Throw(Err_New("NULL pointer to string value"));
+    copy = strdup(value);
+    if (!copy) Err_Throw(Err_New("Cannot copy string value"));
+    return StringObject_NewFromBuffer(copy);
+}
+
+/**
+ * Retrieves the C string stored in the stringobject
+ * @param stringobject A reference to the stringobject
+ * @returns            The C string (do not free it)
+ */
+char * StringObject_GetValue(nanbox_t stringobject) {
+    stringobject_t * stringobject_ptr = nanbox_to_pointer(stringobject);
+    return stringobject_ptr->value;
+}
+
+/**
+ * Get the length of the stringobject
+ * @param stringobject A reference to the stringobject
+ * @returns            The stringobject length
+ */
+size_t StringObject_GetLength(nanbox_t stringobject) {
+    stringobject_t * stringobject_ptr = nanbox_to_pointer(stringobject);
+    return stringobject_ptr->length;
+}
+
+/**
+ * Checks if a value is a stringobject
+ * @param value The value to check
+ * @returns     Whether the value references a stringobject
+ */
+bool StringObject_Check(nanbox_t value) {
+    return nanbox_is_pointer(value)
+        && ((object_t *)nanbox_to_pointer(value))->type == STRING_OBJECT;
+}
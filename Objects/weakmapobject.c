@@ -0,0 +1,181 @@
+/**
+ * @file weakmapobject.c
+ * Weak maps Implementation
+ */
+#include <stdlib.h>
+#include "weakmapobject.h"
+#include "object.h"
+#include "objects_types.h"
+#include "nanbox.h"
+#include "gc.h"
+#include "Common/include/error.h"
+
+/**
+ * Returns the entry of a key, or the free entry where it must be added
+ */
+static weakmap_entry_t * WeakMapObject_Find(weakmapobject_t * map, object_t * key) {
+    size_t mask = map->capacity - 1;
+    size_t index = (key->id * 2654435761u) & mask;
+
+    // the keys don't move between collections, they can be compared by address
+    while (nanbox_is_pointer(map->entries[index].key)
+            && nanbox_to_pointer(map->entries[index].key) != key) {
+        index = (index + 1) & mask;
+    }
+    return &map->entries[index];
+}
+
+/**
+ * Moves the used entries of a map to new entries
+ */
+static void WeakMapObject_Rehash(weakmapobject_t * map, size_t capacity) {
+    weakmap_entry_t * entries = map->entries;
+    size_t old_capacity = map->capacity;
+
+    map->entries = (weakmap_entry_t *)malloc(capacity * sizeof(weakmap_entry_t));
+    if (!map->entries) Err_Throw(Err_New("Cannot allocate weak map entries"));
+    map->capacity = capacity;
+    for (size_t i = 0; i < capacity; i++) {
+        map->entries[i].key = map->entries[i].value = nanbox_null();
+    }
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (nanbox_is_pointer(entries[i].key)) {
+            *WeakMapObject_Find(map, nanbox_to_pointer(entries[i].key)) = entries[i];
+        }
+    }
+    free(entries);
+    GC_RemoveExternalSize(old_capacity * sizeof(weakmap_entry_t));
+    GC_AddExternalSize(capacity * sizeof(weakmap_entry_t));
+}
+
+static void WeakMapObject_CustomFree(void * object_ptr) {
+    weakmapobject_t * weakmapobject_ptr = (weakmapobject_t *)object_ptr;
+    GC_RemoveExternalSize(weakmapobject_ptr->capacity * sizeof(weakmap_entry_t));
+    free(weakmapobject_ptr->entries);
+}
+
+static void WeakMapObject_ProcessWeak(void * object_ptr, bool clear) {
+    weakmapobject_t * weakmapobject_ptr = (weakmapobject_t *)object_ptr;
+    size_t count = weakmapobject_ptr->count;
+
+    for (size_t i = 0; i < weakmapobject_ptr->capacity; i++) {
+        weakmap_entry_t * entry = &weakmapobject_ptr->entries[i];
+
+        if (!nanbox_is_pointer(entry->key)) continue;
+        if (GC_IsMarked(&entry->key)) {
+            // the values of the live keys may reach other keys
+            if (!clear) GC_Mark(&entry->value);
+        } else if (clear) {
+            entry->key = entry->value = nanbox_null();
+            weakmapobject_ptr->count--;
+        }
+    }
+    // the removed entries may split the sequences of colliding keys
+    if (weakmapobject_ptr->count != count) {
+        WeakMapObject_Rehash(weakmapobject_ptr, weakmapobject_ptr->capacity);
+    }
+}
+
+static void WeakMapObject_Trace(void * object_ptr) {
+    GC_DeferWeak((object_t *)object_ptr, WeakMapObject_ProcessWeak);
+}
+
+/**
+ * Allocates a new empty weakmapobject
+ * @returns The newly allocated weakmapobject
+ */
+nanbox_t WeakMapObject_New(void) {
+    weakmapobject_t * weakmapobject_ptr;
+    nanbox_t weakmapobject;
+
+    weakmapobject = Object_New(sizeof(weakmapobject_t), WeakMapObject_CustomFree,
+                               WeakMapObject_Trace);
+    weakmapobject_ptr = nanbox_to_pointer(weakmapobject);
+    weakmapobject_ptr->type = WEAKMAP_OBJECT;
+    weakmapobject_ptr->entries = NULL;
+    weakmapobject_ptr->capacity = 0;
+    weakmapobject_ptr->count = 0;
+    WeakMapObject_Rehash(weakmapobject_ptr, WEAKMAP_INITIAL_CAPACITY);
+    return weakmapobject;
+}
+
+/**
+ * Retrieves the value associated to a key
+ * @param weakmapobject A reference to the weakmapobject
+ * @param key           The key (an object)
+ * @returns             The value or null if the key isn't in the map
+ */
+nanbox_t WeakMapObject_Get(nanbox_t weakmapobject, nanbox_t key) {
+    weakmapobject_t * weakmapobject_ptr = nanbox_to_pointer(weakmapobject);
+    return WeakMapObject_Find(weakmapobject_ptr, nanbox_to_pointer(key))->value;
+}
+
+/**
+ * Associates a value to a key
+ * @param weakmapobject A reference to the weakmapobject
+ * @param key           The key (an object)
+ * @param value         The value
+ */
+void WeakMapObject_Set(nanbox_t weakmapobject, nanbox_t key, nanbox_t value) {
+    weakmapobject_t * weakmapobject_ptr = nanbox_to_pointer(weakmapobject);
+    weakmap_entry_t * entry = WeakMapObject_Find(weakmapobject_ptr, nanbox_to_pointer(key));
+
+    if (!nanbox_is_pointer(entry->key)) {
+        // a quarter of the entries stays free
+        if ((weakmapobject_ptr->count + 1) * 4 > weakmapobject_ptr->capacity * 3) {
+            WeakMapObject_Rehash(weakmapobject_ptr, weakmapobject_ptr->capacity * 2);
+            entry = WeakMapObject_Find(weakmapobject_ptr, nanbox_to_pointer(key));
+        }
+        entry->key = key;
+        weakmapobject_ptr->count++;
+        GC_WRITE_BARRIER(weakmapobject_ptr, key);
+    }
+    entry->value = value;
+    GC_WRITE_BARRIER(weakmapobject_ptr, value);
+}
+
+/**
+ * Removes a key and its value
+ * @param weakmapobject A reference to the weakmapobject
+ * @param key           The key (an object)
+ * @returns             Whether the key was in the map
+ */
+bool WeakMapObject_Remove(nanbox_t weakmapobject, nanbox_t key) {
+    weakmapobject_t * weakmapobject_ptr = nanbox_to_pointer(weakmapobject);
+    weakmap_entry_t * entry = WeakMapObject_Find(weakmapobject_ptr, nanbox_to_pointer(key));
+    size_t mask = weakmapobject_ptr->capacity - 1;
+
+    if (!nanbox_is_pointer(entry->key)) return false;
+    entry->key = entry->value = nanbox_null();
+    weakmapobject_ptr->count--;
+    // the following colliding keys are added again so that they are still found
+    for (size_t i = (entry - weakmapobject_ptr->entries + 1) & mask;
+            nanbox_is_pointer(weakmapobject_ptr->entries[i].key); i = (i + 1) & mask) {
+        weakmap_entry_t moved = weakmapobject_ptr->entries[i];
+
+        weakmapobject_ptr->entries[i].key = weakmapobject_ptr->entries[i].value = nanbox_null();
+        *WeakMapObject_Find(weakmapobject_ptr, nanbox_to_pointer(moved.key)) = moved;
+    }
+    return true;
+}
+
+/**
+ * Get the number of entries of the weakmapobject
+ * @param weakmapobject A reference to the weakmapobject
+ * @returns             The number of keys, the collected ones are removed
+ *                      by the collections
+ */
+size_t WeakMapObject_GetCount(nanbox_t weakmapobject) {
+    weakmapobject_t * weakmapobject_ptr = nanbox_to_pointer(weakmapobject);
+    return weakmapobject_ptr->count;
+}
+
+/**
+ * Checks if a value is a weakmapobject
+ * @param value The value to check
+ * @returns     Whether the value references a weakmapobject
+ */
+bool WeakMapObject_Check(nanbox_t value) {
+    return nanbox_is_pointer(value)
+        && ((object_t *)nanbox_to_pointer(value))->type == WEAKMAP_OBJECT;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file weakrefobject.c
+ * Weak references Implementation
+ */
+#include "weakrefobject.h"
+#include "object.h"
+#include "objects_types.h"
+#include "nanbox.h"
+#include "gc.h"
+
+static void WeakRefObject_ProcessWeak(void * object_ptr, bool clear) {
+    weakrefobject_t * weakrefobject_ptr = (weakrefobject_t *)object_ptr;
+    if (clear && !GC_IsMarked(&weakrefobject_ptr->referent)) {
+        weakrefobject_ptr->referent = nanbox_null();
+    }
+}
+
+static void WeakRefObject_Trace(void * object_ptr) {
+    GC_DeferWeak((object_t *)object_ptr, WeakRefObject_ProcessWeak);
+}
+
+/**
+ * Allocates a new weakrefobject
+ * @param referent The referenced value
+ * @returns        The newly allocated weakrefobject
+ */
+nanbox_t WeakRefObject_New(nanbox_t referent) {
+    weakrefobject_t * weakrefobject_ptr;
+    nanbox_t weakrefobject;
+
+    weakrefobject = Object_New(sizeof(weakrefobject_t), NULL, WeakRefObject_Trace);
+    weakrefobject_ptr = nanbox_to_pointer(weakrefobject);
+    weakrefobject_ptr->type = WEAKREF_OBJECT;
+    weakrefobject_ptr->referent = referent;
+    return weakrefobject;
+}
+
+/**
+ * Retrieves the referent of a weakrefobject
+ * @param weakrefobject A reference to the weakrefobject
+ * @returns             The referent or null if it was collected
+ */
+nanbox_t WeakRefObject_Get(nanbox_t weakrefobject) {
+    weakrefobject_t * weakrefobject_ptr = nanbox_to_pointer(weakrefobject);
+    return weakrefobject_ptr->referent;
+}
+
+/**
+ * Checks if a value is a weakrefobject
+ * @param value The value to check
+ * @returns     Whether the value references a weakrefobject
+ */
+bool WeakRefObject_Check(nanbox_t value) {
+    return nanbox_is_pointer(value)
+        && ((object_t *)nanbox_to_pointer(value))->type == WEAKREF_OBJECT;
+}
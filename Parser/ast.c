@@ -111,7 +111,7 @@ void ASTNode_Free(ast_node_t * node) {
                 break;
 
             case NODE_IDENTIFIER:
-                free(node->as_ident.value);
+                // identifiers are symbols, they are never freed
                 break;
 
             case NODE_STRING:
@@ -7,6 +7,7 @@
 #include "vector.h"
 #include "tokens.h"
 #include "str.h"
+#include "location.h"
 
 typedef enum {
     NODE__ROOT_,
@@ -45,6 +46,7 @@ typedef struct ast_root_s {
 } ast_root_t;
 
 typedef struct ast_identifier_s {
+    /** The name (a symbol) */
     char * value;
 } ast_identifier_t;
 
@@ -145,7 +147,11 @@ typedef struct ast_statement_s {
 
 struct ast_node_s {
     ast_node_type_t type;
-    // loc_t loc;
+    /**
+     * Location of the first token of the node, only set for the statements,
+     * the message sends and the litterals (its line is 0 otherwise)
+     */
+    loc_t loc;
     union {
         ast_root_t           as_root;
         ast_identifier_t     as_ident;
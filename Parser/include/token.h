@@ -20,7 +20,7 @@ typedef struct {
 
     /**
      * Value of the token
-     * Useful for "special" tokens
+     * Useful for "special" tokens, identifiers are symbols
      */
     char * value;
 } token_t;
@@ -37,6 +37,7 @@ bool Token_IsWhitespace(token_t * token);
  * @param     type  Token type
  * @param     span  Span of the token
  * @param[in] value Value of the token in case of a "special" token
+ *                  (identifiers are interned)
  * @returns         A pointer to the newly allocated token
  */
 token_t * Token_New(token_type_t type, span_t span, char * value);
@@ -68,6 +68,19 @@ static void Parser_ConsumeLookahead(parser_t * parser) {
     parser->token_lookahead_index = 0;
 }
 
+/**
+ * Returns the location of the next token that isn't a whitespace or a
+ * comment, without consuming it
+ */
+static loc_t Parser_NextTokenLocation(parser_t * parser) {
+    size_t lookahead_index = parser->token_lookahead_index;
+    token_t * token = Parser_NextToken(parser, false, false);
+    loc_t loc = token ? token->span.start : parser->lexer->pos;
+
+    parser->token_lookahead_index = lookahead_index;
+    return loc;
+}
+
 static loc_t Parser_CurrentLocation(parser_t * parser) {
     loc_t loc;
 
@@ -183,7 +196,8 @@ ast_node_t * Parser_ParseIdentifier(parser_t * parser, bool directly) {
     if (token) {
         if (token->type == TOKTYPE_IDENT) {
             node = ASTNode_New(NODE_IDENTIFIER);
-            node->as_ident.value = strdup(token->value);
+            // identifiers are symbols
+            node->as_ident.value = token->value;
         } else {
             Parser_PushBackTokenList(parser);
         }
@@ -510,6 +524,7 @@ ast_node_t * Parser_ParseMsgPassExpr(parser_t * parser) {
     bool must_loop = true;
 
     node = ASTNode_New(NODE_MSG_PASS_EXPR);
+    node->loc = Parser_NextTokenLocation(parser);
 
     do {
         switch (state) {
@@ -761,6 +776,7 @@ ast_node_t * Parser_ParseStatement(parser_t * parser, bool module_scope) {
     size_t lookahead_index_backup;
 
     node = ASTNode_New(NODE_STATEMENT);
+    node->loc = Parser_NextTokenLocation(parser);
 
     tok = Parser_NextToken(parser, false, false);
     if (tok && tok->type == TOKTYPE_CIRCUMFLEX) {
@@ -1193,14 +1209,46 @@ ast_node_t * Parser_ParseAtomExpr(parser_t * parser) {
     return node;
 }
 
+/**
+ * Tells whether the next '{' opens an object litteral or a block without
+ * consuming any token.
+ * An object litteral is either empty or starts by a field name followed
+ * by ':' or '{', anything else is a block
+ */
+static bool Parser_LooksLikeObjLitteral(parser_t * parser) {
+    size_t lookahead_index = parser->token_lookahead_index;
+    bool is_obj_litteral = false;
+    token_t * tok;
+
+    tok = Parser_NextToken(parser, false, false);
+    if (tok && tok->type == TOKTYPE_LCBRACKET) {
+        tok = Parser_NextToken(parser, false, false);
+        if (tok && tok->type == TOKTYPE_RCBRACKET) {
+            is_obj_litteral = true;
+        } else if (tok && tok->type == TOKTYPE_IDENT) {
+            tok = Parser_NextToken(parser, false, false);
+            is_obj_litteral = tok && (tok->type == TOKTYPE_COLON
+                    || tok->type == TOKTYPE_LCBRACKET);
+        }
+    }
+    parser->token_lookahead_index = lookahead_index;
+
+    return is_obj_litteral;
+}
+
 ast_node_t * Parser_ParseLitteralExpr(parser_t * parser) {
-    ast_node_t * value;
+    ast_node_t * value = NULL;
     ast_node_t * (*funcs[])(parser_t *) = {
         Parser_ParseInt, Parser_ParseDouble, Parser_ParseString,
         Parser_ParseArrayLitteral, Parser_ParseObjLitteral, Parser_ParseBlock
     };
+    bool obj_litteral = Parser_LooksLikeObjLitteral(parser);
 
-    for (size_t i = 0; i < 5; i++) {
+    for (size_t i = 0; i < sizeof(funcs) / sizeof(funcs[0]); i++) {
+        // '{' is ambiguous, only try the rule the lookahead agrees with
+        if (funcs[i] == (obj_litteral ? Parser_ParseBlock : Parser_ParseObjLitteral)) {
+            continue;
+        }
         value = funcs[i](parser);
         if (value || Parser_GetStatus(parser) == PARSER_ERROR) return value;
     }
@@ -1230,6 +1278,7 @@ ast_node_t * Parser_ParseArrayLitteral(parser_t * parser) {
     bool must_loop = true;
 
     node = ASTNode_New(NODE_ARRAY_LITTERAL);
+    node->loc = Parser_NextTokenLocation(parser);
 
     do {
         switch (state) {
@@ -1338,6 +1387,7 @@ ast_node_t * Parser_ParseBlock(parser_t * parser) {
     size_t  lookahead_index = parser->token_lookahead_index;
 
     node = ASTNode_New(NODE_BLOCK);
+    node->loc = Parser_NextTokenLocation(parser);
 
     do {
         switch (state) {
@@ -1771,6 +1821,7 @@ ast_node_t * Parser_ParseObjLitteral(parser_t * parser) {
     bool must_loop = true;
 
     node = ASTNode_New(NODE_OBJ_LITTERAL);
+    node->loc = Parser_NextTokenLocation(parser);
 
     do {
         switch (state) {
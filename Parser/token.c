@@ -9,6 +9,7 @@
 #include "error.h"
 #include "token.h"
 #include "tokens.h"
+#include "symbol.h"
 
 /**
  * @param[in] token A pointer to the token
@@ -26,7 +27,8 @@ bool Token_IsWhitespace(token_t * token) {
  * @param     type  Token type
  * @param     span  Span of the token
  * @param[in] value Value of the token in case of a "special" token
- *                  The string is duplicated so the caller can free its copy
+ *                  The string is duplicated so the caller can free its copy,
+ *                  identifiers are interned
  * @returns         A pointer to the newly allocated token
  */
 token_t * Token_New(token_type_t type, span_t span, char * value) {
@@ -36,7 +38,11 @@ token_t * Token_New(token_type_t type, span_t span, char * value) {
     if (token) {
         token->type = type;
         token->span = span;
-        token->value = value ? strdup(value) : NULL;
+        if (type == TOKTYPE_IDENT) {
+            token->value = Symbol_Intern(value);
+        } else {
+            token->value = value ? strdup(value) : NULL;
+        }
     } else {
         Err_Throw(Err_New("Cannot allocated token"));
     }
@@ -49,7 +55,7 @@ token_t * Token_New(token_type_t type, span_t span, char * value) {
  */
 void Token_Free(token_t * token) {
     if (token) {
-        if (token->value) free(token->value);
+        if (token->value && token->type != TOKTYPE_IDENT) free(token->value);
         free(token);
     } else {
         Err_Throw(Err_New("NULL pointer to token"));
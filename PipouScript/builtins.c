@@ -0,0 +1,616 @@
+/**
+ * @file builtins.c
+ * Builtin objects and messages
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "builtins.h"
+#include "interpreter.h"
+#include "misc.h"
+#include "object.h"
+#include "arrayobject.h"
+#include "stringobject.h"
+#include "blockobject.h"
+#include "nativeblockobject.h"
+#include "weakrefobject.h"
+#include "weakmapobject.h"
+#include "gc.h"
+#include "nanbox.h"
+#include "hashmap.h"
+#include "str.h"
+#include "symbol.h"
+
+/**
+ * Defines a native message in a prototype
+ */
+static void Builtins_AddNative(nanbox_t proto, char * selector, native_block_func_t func,
+                               size_t params_count) {
+    Object_SetField(proto, Symbol_Intern(selector), NativeBlockObject_New(func, params_count));
+}
+
+/**
+ * Adds a native message that only calls the blocks it receives
+ * (see OP_SEND_BLOCKS)
+ */
+static void Builtins_AddBlocksNative(nanbox_t proto, char * selector, native_block_func_t func,
+                                     size_t params_count) {
+    nanbox_t native = NativeBlockObject_New(func, params_count);
+
+    ((nativeblockobject_t *)nanbox_to_pointer(native))->borrows_blocks = true;
+    Object_SetField(proto, Symbol_Intern(selector), native);
+}
+
+/**
+ * Creates a builtin prototype inheriting from another one
+ */
+static nanbox_t Builtins_NewProto(nanbox_t parent) {
+    nanbox_t proto = Object_New(sizeof(object_t), NULL, NULL);
+
+    if (nanbox_is_pointer(parent)) {
+        Object_SetPrototype(proto, parent);
+    }
+    return proto;
+}
+
+/********************** Object ******************************/
+
+/**
+ * Creates a new object whose prototype is the receiver
+ */
+static nanbox_t Builtins_ObjectClone(interpreter_t * interp, nanbox_t this,
+                                     nanbox_t * args, size_t argc) {
+    nanbox_t object;
+
+    UNUSED(interp); UNUSED(args); UNUSED(argc);
+    if (!nanbox_is_pointer(this)) return this;
+    object = Object_New(sizeof(object_t), NULL, NULL);
+    Object_SetPrototype(object, this);
+    return object;
+}
+
+static nanbox_t Builtins_ObjectPrint(interpreter_t * interp, nanbox_t this,
+                                     nanbox_t * args, size_t argc) {
+    string * str = Interpreter_ValueToString(this);
+
+    UNUSED(interp); UNUSED(args); UNUSED(argc);
+    printf("%s\n", str->c_str);
+    Str_Free(str);
+    return this;
+}
+
+/**
+ * Calls the argument once the receiver is collected
+ */
+static nanbox_t Builtins_ObjectWhenCollected(interpreter_t * interp, nanbox_t this,
+                                             nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    if (!nanbox_is_pointer(this)) {
+        Interpreter_RaiseError(interp, "Only objects can be collected");
+        return nanbox_null();
+    }
+    Interpreter_AddFinalizer(interp, this, args[0]);
+    return this;
+}
+
+/********************** Boolean ******************************/
+
+static nanbox_t Builtins_BooleanIfTrue(interpreter_t * interp, nanbox_t this,
+                                       nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    return nanbox_to_boolean(this) ? Interpreter_Value(interp, args[0]) : nanbox_null();
+}
+
+static nanbox_t Builtins_BooleanIfFalse(interpreter_t * interp, nanbox_t this,
+                                        nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    return !nanbox_to_boolean(this) ? Interpreter_Value(interp, args[0]) : nanbox_null();
+}
+
+static nanbox_t Builtins_BooleanIfTrueIfFalse(interpreter_t * interp, nanbox_t this,
+                                              nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    return Interpreter_Value(interp, args[nanbox_to_boolean(this) ? 0 : 1]);
+}
+
+static nanbox_t Builtins_BooleanIfFalseIfTrue(interpreter_t * interp, nanbox_t this,
+                                              nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    return Interpreter_Value(interp, args[nanbox_to_boolean(this) ? 1 : 0]);
+}
+
+static nanbox_t Builtins_BooleanNot(interpreter_t * interp, nanbox_t this,
+                                    nanbox_t * args, size_t argc) {
+    UNUSED(interp); UNUSED(args); UNUSED(argc);
+    return nanbox_from_boolean(!nanbox_to_boolean(this));
+}
+
+static nanbox_t Builtins_BooleanAnd(interpreter_t * interp, nanbox_t this,
+                                    nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    return nanbox_to_boolean(this) ? Interpreter_Value(interp, args[0]) : this;
+}
+
+static nanbox_t Builtins_BooleanOr(interpreter_t * interp, nanbox_t this,
+                                   nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    return nanbox_to_boolean(this) ? this : Interpreter_Value(interp, args[0]);
+}
+
+/********************** Block ******************************/
+
+static nanbox_t Builtins_BlockValue(interpreter_t * interp, nanbox_t this,
+                                    nanbox_t * args, size_t argc) {
+    nanbox_t block_this = nanbox_null();
+
+    if (BlockObject_Check(this)) {
+        block_this = ((blockobject_t *)nanbox_to_pointer(this))->this;
+    }
+    return Interpreter_CallBlock(interp, this, block_this, args, argc);
+}
+
+/**
+ * Evaluates the argument while the receiver evaluates to an expected value
+ */
+static nanbox_t Builtins_BlockWhile(interpreter_t * interp, nanbox_t this,
+                                    nanbox_t body, bool expected) {
+    nanbox_t condition;
+    bool must_loop = true;
+
+    // the blocks run collections that can move them
+    GC_AddHandle(&this);
+    GC_AddHandle(&body);
+    while (must_loop) {
+        condition = Interpreter_Value(interp, this);
+        if (Interpreter_GetStatus(interp) != INTERPRETER_OK) break;
+        must_loop = Interpreter_IsTruthy(condition) == expected;
+        if (must_loop) {
+            Interpreter_Value(interp, body);
+            if (Interpreter_GetStatus(interp) != INTERPRETER_OK) break;
+        }
+    }
+    GC_RemoveHandle(&body);
+    GC_RemoveHandle(&this);
+    return nanbox_null();
+}
+
+static nanbox_t Builtins_BlockWhileTrue(interpreter_t * interp, nanbox_t this,
+                                        nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    return Builtins_BlockWhile(interp, this, args[0], true);
+}
+
+static nanbox_t Builtins_BlockWhileFalse(interpreter_t * interp, nanbox_t this,
+                                         nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    return Builtins_BlockWhile(interp, this, args[0], false);
+}
+
+/**
+ * Evaluates the receiver, on error the argument is called with the error
+ * message and its result is answered instead
+ */
+static nanbox_t Builtins_BlockOnError(interpreter_t * interp, nanbox_t this,
+                                      nanbox_t * args, size_t argc) {
+    nanbox_t handler = args[0], result, message;
+
+    UNUSED(argc);
+    GC_AddHandle(&handler);
+    result = Interpreter_Value(interp, this);
+    GC_RemoveHandle(&handler);
+    // the non-local returns are not errors
+    if (Interpreter_GetStatus(interp) != INTERPRETER_ERROR) return result;
+    message = StringObject_New(Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+    // the handler runs even if the memory the error left is above the limit
+    interp->heap_limit_skip = true;
+    result = Interpreter_CallBlock(interp, handler, nanbox_null(), &message, 1);
+    interp->heap_limit_skip = false;
+    return result;
+}
+
+/********************** Number ******************************/
+
+static nanbox_t Builtins_NumberToDo(interpreter_t * interp, nanbox_t this,
+                                    nanbox_t * args, size_t argc) {
+    nanbox_t index;
+
+    UNUSED(argc);
+    if (!nanbox_is_int(this) || !nanbox_is_int(args[0])) {
+        Interpreter_RaiseError(interp, "to:do: expects integer bounds");
+        return nanbox_null();
+    }
+    for (int32_t i = nanbox_to_int(this); i <= nanbox_to_int(args[0]); i++) {
+        index = nanbox_from_int(i);
+        Interpreter_CallBlock(interp, args[1], nanbox_null(), &index, 1);
+        if (Interpreter_GetStatus(interp) != INTERPRETER_OK) break;
+        if (i == INT32_MAX) break;
+    }
+    return nanbox_null();
+}
+
+static nanbox_t Builtins_NumberTimesRepeat(interpreter_t * interp, nanbox_t this,
+                                           nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    if (!nanbox_is_int(this)) {
+        Interpreter_RaiseError(interp, "timesRepeat expects an integer receiver");
+        return nanbox_null();
+    }
+    for (int32_t i = 0; i < nanbox_to_int(this); i++) {
+        Interpreter_Value(interp, args[0]);
+        if (Interpreter_GetStatus(interp) != INTERPRETER_OK) break;
+    }
+    return nanbox_null();
+}
+
+static nanbox_t Builtins_NumberAbs(interpreter_t * interp, nanbox_t this,
+                                   nanbox_t * args, size_t argc) {
+    UNUSED(interp); UNUSED(args); UNUSED(argc);
+    if (nanbox_is_int(this)) {
+        int64_t value = nanbox_to_int(this);
+        if (value < 0) value = -value;
+        return value > INT32_MAX ? nanbox_from_double((double)value)
+                                 : nanbox_from_int((int32_t)value);
+    }
+    return nanbox_to_double(this) < 0 ? nanbox_from_double(-nanbox_to_double(this)) : this;
+}
+
+static nanbox_t Builtins_NumberMax(interpreter_t * interp, nanbox_t this,
+                                   nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    if (!nanbox_is_number(args[0])) {
+        Interpreter_RaiseError(interp, "max expects a number");
+        return nanbox_null();
+    }
+    return nanbox_to_number(args[0]) > nanbox_to_number(this) ? args[0] : this;
+}
+
+static nanbox_t Builtins_NumberMin(interpreter_t * interp, nanbox_t this,
+                                   nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    if (!nanbox_is_number(args[0])) {
+        Interpreter_RaiseError(interp, "min expects a number");
+        return nanbox_null();
+    }
+    return nanbox_to_number(args[0]) < nanbox_to_number(this) ? args[0] : this;
+}
+
+/********************** Array ******************************/
+
+static nanbox_t Builtins_ArrayNew(interpreter_t * interp, nanbox_t this,
+                                  nanbox_t * args, size_t argc) {
+    UNUSED(interp); UNUSED(this); UNUSED(args); UNUSED(argc);
+    return ArrayObject_New();
+}
+
+static bool Builtins_CheckArray(interpreter_t * interp, nanbox_t array) {
+    if (!ArrayObject_Check(array)) {
+        Interpreter_RaiseError(interp, "Receiver is not an array");
+        return false;
+    }
+    return true;
+}
+
+static bool Builtins_CheckIndex(interpreter_t * interp, nanbox_t index, size_t length) {
+    if (!nanbox_is_int(index)) {
+        Interpreter_RaiseError(interp, "Index must be an integer");
+        return false;
+    }
+    if (nanbox_to_int(index) < 0 || (size_t)nanbox_to_int(index) >= length) {
+        char buf[64];
+        snprintf(buf, 64, "Index %d out of range", nanbox_to_int(index));
+        Interpreter_RaiseError(interp, buf);
+        return false;
+    }
+    return true;
+}
+
+static nanbox_t Builtins_ArrayAt(interpreter_t * interp, nanbox_t this,
+                                 nanbox_t * args, size_t argc) {
+    nanbox_t item = nanbox_null();
+
+    UNUSED(argc);
+    if (Builtins_CheckArray(interp, this)
+            && Builtins_CheckIndex(interp, args[0], ArrayObject_GetLength(this))) {
+        item = ArrayObject_GetAt(this, nanbox_to_int(args[0]));
+    }
+    return item;
+}
+
+static nanbox_t Builtins_ArrayAtPut(interpreter_t * interp, nanbox_t this,
+                                    nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    // a store after the end extends the array
+    if (Builtins_CheckArray(interp, this) && Builtins_CheckIndex(interp, args[0], SIZE_MAX)) {
+        ArrayObject_SetAt(this, nanbox_to_int(args[0]), args[1]);
+    }
+    return args[1];
+}
+
+static nanbox_t Builtins_ArrayPush(interpreter_t * interp, nanbox_t this,
+                                   nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    if (!Builtins_CheckArray(interp, this)) return nanbox_null();
+    ArrayObject_Append(this, args[0]);
+    return this;
+}
+
+static nanbox_t Builtins_ArrayPop(interpreter_t * interp, nanbox_t this,
+                                  nanbox_t * args, size_t argc) {
+    UNUSED(args); UNUSED(argc);
+    if (!Builtins_CheckArray(interp, this)) return nanbox_null();
+    if (ArrayObject_GetLength(this) == 0) {
+        Interpreter_RaiseError(interp, "Cannot pop an empty array");
+        return nanbox_null();
+    }
+    return ArrayObject_Pop(this);
+}
+
+static nanbox_t Builtins_ArrayLength(interpreter_t * interp, nanbox_t this,
+                                     nanbox_t * args, size_t argc) {
+    UNUSED(args); UNUSED(argc);
+    if (!Builtins_CheckArray(interp, this)) return nanbox_null();
+    return nanbox_from_int(ArrayObject_GetLength(this));
+}
+
+static nanbox_t Builtins_ArraySum(interpreter_t * interp, nanbox_t this,
+                                  nanbox_t * args, size_t argc) {
+    nanbox_t sum;
+
+    UNUSED(args); UNUSED(argc);
+    if (!Builtins_CheckArray(interp, this)) return nanbox_null();
+    sum = ArrayObject_Sum(this);
+    if (nanbox_is_null(sum)) Interpreter_RaiseError(interp, "Cannot sum an array of non-numbers");
+    return sum;
+}
+
+static nanbox_t Builtins_ArrayCopyFromTo(interpreter_t * interp, nanbox_t this,
+                                        nanbox_t * args, size_t argc) {
+    size_t length;
+    int32_t from, to;
+
+    UNUSED(argc);
+    if (!Builtins_CheckArray(interp, this)) return nanbox_null();
+    length = ArrayObject_GetLength(this);
+    // an empty slice ends just before its first index, which may be the length
+    if (!Builtins_CheckIndex(interp, args[0], length + 1)) return nanbox_null();
+    if (!nanbox_is_int(args[1])) {
+        Interpreter_RaiseError(interp, "Index must be an integer");
+        return nanbox_null();
+    }
+    from = nanbox_to_int(args[0]);
+    to = nanbox_to_int(args[1]);
+    if (to < from - 1 || (to >= 0 && (size_t)to >= length)) {
+        char buf[64];
+        snprintf(buf, 64, "Index %d out of range", to);
+        Interpreter_RaiseError(interp, buf);
+        return nanbox_null();
+    }
+    // the items are shared until one of the arrays is modified
+    return ArrayObject_Slice(this, from, to - from + 1);
+}
+
+static nanbox_t Builtins_ArrayDo(interpreter_t * interp, nanbox_t this,
+                                 nanbox_t * args, size_t argc) {
+    nanbox_t item;
+
+    UNUSED(argc);
+    if (!Builtins_CheckArray(interp, this)) return nanbox_null();
+    GC_AddHandle(&this);
+    // the length is read at each iteration since the block can modify the array
+    for (size_t i = 0; i < ArrayObject_GetLength(this); i++) {
+        item = ArrayObject_GetAt(this, i);
+        Interpreter_CallBlock(interp, args[0], nanbox_null(), &item, 1);
+        if (Interpreter_GetStatus(interp) != INTERPRETER_OK) break;
+    }
+    GC_RemoveHandle(&this);
+    return nanbox_null();
+}
+
+static nanbox_t Builtins_ArrayDetect(interpreter_t * interp, nanbox_t this,
+                                     nanbox_t * args, size_t argc) {
+    nanbox_t item = nanbox_null(), result;
+    bool found = false;
+
+    UNUSED(argc);
+    if (!Builtins_CheckArray(interp, this)) return nanbox_null();
+    GC_AddHandle(&this);
+    GC_AddHandle(&item);
+    for (size_t i = 0; i < ArrayObject_GetLength(this) && !found; i++) {
+        item = ArrayObject_GetAt(this, i);
+        result = Interpreter_CallBlock(interp, args[0], nanbox_null(), &item, 1);
+        if (Interpreter_GetStatus(interp) != INTERPRETER_OK) break;
+        found = Interpreter_IsTruthy(result);
+    }
+    GC_RemoveHandle(&item);
+    GC_RemoveHandle(&this);
+    return found ? item : nanbox_null();
+}
+
+/********************** String ******************************/
+
+static bool Builtins_CheckString(interpreter_t * interp, nanbox_t string) {
+    if (!StringObject_Check(string)) {
+        Interpreter_RaiseError(interp, "Receiver is not a string");
+        return false;
+    }
+    return true;
+}
+
+static nanbox_t Builtins_StringLength(interpreter_t * interp, nanbox_t this,
+                                      nanbox_t * args, size_t argc) {
+    UNUSED(args); UNUSED(argc);
+    if (!Builtins_CheckString(interp, this)) return nanbox_null();
+    return nanbox_from_int(StringObject_GetLength(this));
+}
+
+static nanbox_t Builtins_StringConcat(interpreter_t * interp, nanbox_t this,
+                                      nanbox_t * args, size_t argc) {
+    string * str, * str2;
+    nanbox_t result;
+
+    UNUSED(argc);
+    if (!Builtins_CheckString(interp, this)) return nanbox_null();
+    str = Str_New(StringObject_GetValue(this));
+    str2 = Interpreter_ValueToString(args[0]);
+    Str_Append(str, str2);
+    Str_Free(str2);
+    result = StringObject_New(str->c_str);
+    Str_Free(str);
+    return result;
+}
+
+/********************** WeakRef ******************************/
+
+/**
+ * Creates a weak reference to the argument whose prototype is the receiver
+ */
+static nanbox_t Builtins_WeakRefOn(interpreter_t * interp, nanbox_t this,
+                                   nanbox_t * args, size_t argc) {
+    nanbox_t weakref = WeakRefObject_New(args[0]);
+
+    UNUSED(interp); UNUSED(argc);
+    Object_SetPrototype(weakref, this);
+    return weakref;
+}
+
+static nanbox_t Builtins_WeakRefValue(interpreter_t * interp, nanbox_t this,
+                                      nanbox_t * args, size_t argc) {
+    UNUSED(args); UNUSED(argc);
+    if (!WeakRefObject_Check(this)) {
+        Interpreter_RaiseError(interp, "Receiver is not a weak reference");
+        return nanbox_null();
+    }
+    return WeakRefObject_Get(this);
+}
+
+/********************** WeakMap ******************************/
+
+/**
+ * Creates an empty weak map whose prototype is the receiver
+ */
+static nanbox_t Builtins_WeakMapNew(interpreter_t * interp, nanbox_t this,
+                                    nanbox_t * args, size_t argc) {
+    nanbox_t weakmap = WeakMapObject_New();
+
+    UNUSED(interp); UNUSED(args); UNUSED(argc);
+    Object_SetPrototype(weakmap, this);
+    return weakmap;
+}
+
+static bool Builtins_CheckWeakMap(interpreter_t * interp, nanbox_t weakmap, nanbox_t key) {
+    if (!WeakMapObject_Check(weakmap)) {
+        Interpreter_RaiseError(interp, "Receiver is not a weak map");
+        return false;
+    }
+    if (!nanbox_is_pointer(key)) {
+        Interpreter_RaiseError(interp, "Weak map keys must be objects");
+        return false;
+    }
+    return true;
+}
+
+static nanbox_t Builtins_WeakMapAt(interpreter_t * interp, nanbox_t this,
+                                   nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    if (!Builtins_CheckWeakMap(interp, this, args[0])) return nanbox_null();
+    return WeakMapObject_Get(this, args[0]);
+}
+
+static nanbox_t Builtins_WeakMapAtPut(interpreter_t * interp, nanbox_t this,
+                                      nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    if (Builtins_CheckWeakMap(interp, this, args[0])) {
+        WeakMapObject_Set(this, args[0], args[1]);
+    }
+    return args[1];
+}
+
+static nanbox_t Builtins_WeakMapRemoveKey(interpreter_t * interp, nanbox_t this,
+                                          nanbox_t * args, size_t argc) {
+    UNUSED(argc);
+    if (!Builtins_CheckWeakMap(interp, this, args[0])) return nanbox_null();
+    return nanbox_from_boolean(WeakMapObject_Remove(this, args[0]));
+}
+
+static nanbox_t Builtins_WeakMapLength(interpreter_t * interp, nanbox_t this,
+                                       nanbox_t * args, size_t argc) {
+    UNUSED(args); UNUSED(argc);
+    if (!WeakMapObject_Check(this)) {
+        Interpreter_RaiseError(interp, "Receiver is not a weak map");
+        return nanbox_null();
+    }
+    return nanbox_from_int(WeakMapObject_GetCount(this));
+}
+
+/**
+ * Creates the builtin prototypes of an interpreter and its global variables
+ * @param[in] interpreter The interpreter
+ */
+void Builtins_Install(interpreter_t * interpreter) {
+    nanbox_t proto;
+
+    proto = interpreter->object_proto = Builtins_NewProto(nanbox_null());
+    Builtins_AddNative(proto, "clone", Builtins_ObjectClone, 0);
+    Builtins_AddNative(proto, "new", Builtins_ObjectClone, 0);
+    Builtins_AddNative(proto, "print", Builtins_ObjectPrint, 0);
+    Builtins_AddNative(proto, "whenCollected", Builtins_ObjectWhenCollected, 1);
+
+    proto = interpreter->boolean_proto = Builtins_NewProto(interpreter->object_proto);
+    Builtins_AddBlocksNative(proto, "ifTrue", Builtins_BooleanIfTrue, 1);
+    Builtins_AddBlocksNative(proto, "ifFalse", Builtins_BooleanIfFalse, 1);
+    Builtins_AddBlocksNative(proto, "ifTrue:ifFalse", Builtins_BooleanIfTrueIfFalse, 2);
+    Builtins_AddBlocksNative(proto, "ifFalse:ifTrue", Builtins_BooleanIfFalseIfTrue, 2);
+    Builtins_AddNative(proto, "not", Builtins_BooleanNot, 0);
+    Builtins_AddBlocksNative(proto, "and", Builtins_BooleanAnd, 1);
+    Builtins_AddBlocksNative(proto, "or", Builtins_BooleanOr, 1);
+
+    proto = interpreter->block_proto = Builtins_NewProto(interpreter->object_proto);
+    Builtins_AddNative(proto, "value", Builtins_BlockValue, NATIVE_BLOCK_VARIADIC);
+    Builtins_AddNative(proto, "value:value", Builtins_BlockValue, 2);
+    Builtins_AddNative(proto, "value:value:value", Builtins_BlockValue, 3);
+    Builtins_AddBlocksNative(proto, "whileTrue", Builtins_BlockWhileTrue, 1);
+    Builtins_AddBlocksNative(proto, "whileFalse", Builtins_BlockWhileFalse, 1);
+    Builtins_AddBlocksNative(proto, "onError", Builtins_BlockOnError, 1);
+
+    proto = interpreter->number_proto = Builtins_NewProto(interpreter->object_proto);
+    Builtins_AddBlocksNative(proto, "to:do", Builtins_NumberToDo, 2);
+    Builtins_AddBlocksNative(proto, "timesRepeat", Builtins_NumberTimesRepeat, 1);
+    Builtins_AddNative(proto, "abs", Builtins_NumberAbs, 0);
+    Builtins_AddNative(proto, "max", Builtins_NumberMax, 1);
+    Builtins_AddNative(proto, "min", Builtins_NumberMin, 1);
+
+    proto = interpreter->array_proto = Builtins_NewProto(interpreter->object_proto);
+    Builtins_AddNative(proto, "new", Builtins_ArrayNew, 0);
+    Builtins_AddNative(proto, "at", Builtins_ArrayAt, 1);
+    Builtins_AddNative(proto, "at:put", Builtins_ArrayAtPut, 2);
+    Builtins_AddNative(proto, "push", Builtins_ArrayPush, 1);
+    Builtins_AddNative(proto, "pop", Builtins_ArrayPop, 0);
+    Builtins_AddNative(proto, "length", Builtins_ArrayLength, 0);
+    Builtins_AddNative(proto, "sum", Builtins_ArraySum, 0);
+    Builtins_AddNative(proto, "copyFrom:to", Builtins_ArrayCopyFromTo, 2);
+    Builtins_AddBlocksNative(proto, "do", Builtins_ArrayDo, 1);
+    Builtins_AddBlocksNative(proto, "detect", Builtins_ArrayDetect, 1);
+
+    proto = interpreter->string_proto = Builtins_NewProto(interpreter->object_proto);
+    Builtins_AddNative(proto, "length", Builtins_StringLength, 0);
+    Builtins_AddNative(proto, "+", Builtins_StringConcat, 1);
+
+    proto = Builtins_NewProto(interpreter->object_proto);
+    Builtins_AddNative(proto, "on", Builtins_WeakRefOn, 1);
+    Builtins_AddNative(proto, "value", Builtins_WeakRefValue, 0);
+    HashMap_Set(interpreter->globals, Symbol_Intern("WeakRef"), proto);
+
+    proto = Builtins_NewProto(interpreter->object_proto);
+    Builtins_AddNative(proto, "new", Builtins_WeakMapNew, 0);
+    Builtins_AddNative(proto, "at", Builtins_WeakMapAt, 1);
+    Builtins_AddNative(proto, "at:put", Builtins_WeakMapAtPut, 2);
+    Builtins_AddNative(proto, "removeKey", Builtins_WeakMapRemoveKey, 1);
+    Builtins_AddNative(proto, "length", Builtins_WeakMapLength, 0);
+    HashMap_Set(interpreter->globals, Symbol_Intern("WeakMap"), proto);
+
+    HashMap_Set(interpreter->globals, Symbol_Intern("Object"), interpreter->object_proto);
+    HashMap_Set(interpreter->globals, Symbol_Intern("Array"), interpreter->array_proto);
+    HashMap_Set(interpreter->globals, Symbol_Intern("String"), interpreter->string_proto);
+}
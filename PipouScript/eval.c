@@ -15,6 +15,11 @@
 #include "ast.h"
 #include "str.h"
 #include "repl.h"
+#include "compiler.h"
+#include "code.h"
+#include "interpreter.h"
+#include "nanbox.h"
+#include "gc.h"
 
 #ifdef BUILD_VERSION
 #define PRINT_VERSION BUILD_VERSION
@@ -22,6 +27,9 @@
 #define PRINT_VERSION "<unspecified>"
 #endif
 
+/** Number of lines of the allocation profile rankings */
+#define EVAL_ALLOCATION_SITES 10
+
 /**
  * Reads one line from the shell
  * @param[out] line_ptr Pointer to the allocated memory storing the line read
@@ -99,6 +107,118 @@ static void Eval_PrintAST(char * buffer, char * filename) {
     Parser_Free(parser);
 }
 
+/**
+ * Prints the bytecode compiled from a buffer that contains code
+ * @param[in] buffer   The buffer to compile
+ * @param[in] filename The name of the file that contains the code
+ */
+static void Eval_PrintBytecode(char * buffer, char * filename) {
+    parser_t * parser;
+    compiler_t * compiler;
+    ast_node_t * ast_root;
+    code_t * code;
+
+    parser = Parser_New(buffer, strlen(buffer), filename, true);
+    ast_root = Parser_CreateAST(parser, false);
+    if (ast_root) {
+        compiler = Compiler_New();
+        code = Compiler_Compile(compiler, ast_root);
+        if (code) {
+            string * code_string = Code_Disassemble(code);
+            printf("\n%s\n", code_string->c_str);
+            Str_Free(code_string);
+            Code_Free(code);
+        }
+        Compiler_Free(compiler);
+        ASTNode_Free(ast_root);
+    }
+    Parser_Free(parser);
+}
+
+/**
+ * Prints the statistics of the heap
+ */
+static void Eval_PrintHeapStats(void) {
+    static const char * type_names[OBJECT_TYPES_COUNT] = {
+        "objects", "arrays", "native blocks", "strings", "blocks", "contexts",
+        "weak references", "weak maps"
+    };
+    gc_stats_t stats = GC_GetStats();
+
+    printf("Heap: %ld bytes, nursery: %ld bytes, peak: %ld bytes\n",
+           stats.heap_size, stats.nursery_size, stats.peak_size);
+    for (size_t i = 0; i < OBJECT_TYPES_COUNT; i++) {
+        printf("%s%ld %s", i ? ", " : "Live: ", stats.objects[i], type_names[i]);
+    }
+    printf(" (%ld bytes)\n", stats.objects_bytes);
+    printf("Fields: %ld bytes, array items: %ld bytes, strings: %ld bytes\n",
+           stats.slots_bytes, stats.arrays_bytes, stats.strings_bytes);
+    printf("Allocated: %ld bytes (%.0f bytes/s), collections: %ld young, %ld full\n",
+           stats.allocated_bytes, stats.allocation_rate, stats.young_collections,
+           stats.full_collections);
+    printf("Pauses: %ld, longest %ld us, 99%% under %ld us\n", stats.pauses, stats.max_pause,
+           stats.p99_pause);
+}
+
+/**
+ * Evaluates code and prints the error that occured if any
+ * @param[in] interpreter The interpreter
+ * @param[in] buffer      The code
+ * @param[in] filename    The name of the file that contains the code
+ * @returns               The value of the code
+ */
+static nanbox_t Eval_Buffer(interpreter_t * interpreter, char * buffer, char * filename) {
+    nanbox_t result = Interpreter_Eval(interpreter, buffer, filename);
+
+    if (Interpreter_GetStatus(interpreter) == INTERPRETER_ERROR) {
+        error_t * error = Interpreter_GetError(interpreter);
+        Err_Print(error);
+        if (error->with_location) {
+            char * line = Err_GetLineString(error->location, buffer);
+            printf("%s\n", line);
+            free(line);
+        }
+    }
+    return result;
+}
+
+/**
+ * Runs the code of a file
+ * @param[in] filename The name of the file
+ * @retval 0 on termination without error
+ * @retval Non-zero on failure
+ */
+int Eval_File(char * filename) {
+    interpreter_t * interpreter;
+    FILE * file;
+    char * buffer;
+    long length;
+    int ret = 0;
+
+    file = fopen(filename, "rb");
+    if (!file) {
+        perror("[Eval] ");
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    buffer = malloc(length + 1);
+    if (!buffer) Err_Throw(Err_New("[Eval] File buffer cannot be allocated"));
+    length = fread(buffer, 1, length, file);
+    buffer[length] = '\0';
+    fclose(file);
+
+    interpreter = Interpreter_New();
+    Eval_Buffer(interpreter, buffer, filename);
+    if (Interpreter_GetStatus(interpreter) == INTERPRETER_ERROR) ret = -1;
+    Interpreter_WriteOpcodeProfile(interpreter, stderr);
+    Interpreter_WriteAllocationProfile(interpreter, stderr, EVAL_ALLOCATION_SITES);
+    Interpreter_Free(interpreter);
+    free(buffer);
+    return ret;
+}
+
 /**
  * Puts the interpreter in REPL mode and waits for input
  * @retval 0 on termination without error
@@ -110,6 +230,8 @@ int Eval_REPL() {
     ssize_t line_length;
     bool must_loop = true;
     bool multi_line = false;
+    bool debug = false;
+    interpreter_t * interpreter = Interpreter_New();
 
     printf("Welcome to PipouScript shell v%s\n", PRINT_VERSION);
     while(must_loop) {
@@ -124,20 +246,49 @@ int Eval_REPL() {
             if (feof(stdin)) must_loop = false;
             else {
                 perror("[REPL] ");
+                Interpreter_Free(interpreter);
                 return -1;
             }
         } else if (line_length > 1) {
             repl_cmd_type_t cmd = REPL_IsCommand(line);
             if (cmd == REPL_CMD_NONE) {
-                /// @todo only when some flag is set
-                Eval_PrintTokens(line, NULL);
-                Eval_PrintAST(line, NULL);
-            } if (cmd == REPL_CMD_MULTILINE) {
+                nanbox_t result;
+                if (debug) {
+                    Eval_PrintTokens(line, NULL);
+                    Eval_PrintAST(line, NULL);
+                    Eval_PrintBytecode(line, NULL);
+                }
+                result = Eval_Buffer(interpreter, line, NULL);
+                if (Interpreter_GetStatus(interpreter) == INTERPRETER_ERROR) {
+                    Interpreter_ClearError(interpreter);
+                } else if (!nanbox_is_null(result)) {
+                    string * result_string = Interpreter_ValueToString(result);
+                    printf("%s\n", result_string->c_str);
+                    Str_Free(result_string);
+                }
+            } else if (cmd == REPL_CMD_MULTILINE) {
                 multi_line = true;
+            } else if (cmd == REPL_CMD_DEBUG) {
+                debug = !debug;
+                printf("Debug output %s\n", debug ? "enabled" : "disabled");
+            } else if (cmd == REPL_CMD_CACHE) {
+                interpreter_cache_stats_t stats = Interpreter_GetCacheStats(interpreter);
+                printf("Send sites: %ld hits, %ld misses\n", stats.hits, stats.misses);
+                printf("Global cache: %ld hits, %ld misses\n",
+                       stats.megamorphic_hits, stats.megamorphic_misses);
+            } else if (cmd == REPL_CMD_HEAP) {
+                Eval_PrintHeapStats();
+            } else if (cmd == REPL_CMD_ALLOCATIONS) {
+                if (interpreter->allocation_profile) {
+                    Interpreter_WriteAllocationProfile(interpreter, stdout, EVAL_ALLOCATION_SITES);
+                } else {
+                    printf("Allocation sites are only profiled by \"make PROFILE=allocations\" builds\n");
+                }
             }
         }
         free(line);
     }
+    Interpreter_Free(interpreter);
 
     return 0;
 }
@@ -0,0 +1,12 @@
+/**
+ * @file builtins.h
+ * Builtin objects and messages
+ */
+#pragma once
+#include "interpreter.h"
+
+/**
+ * Creates the builtin prototypes of an interpreter and its global variables
+ * @param[in] interpreter The interpreter
+ */
+void Builtins_Install(interpreter_t * interpreter);
@@ -10,3 +10,11 @@
  * @retval Non-zero on failure
  */
 int Eval_REPL();
+
+/**
+ * Runs the code of a file
+ * @param[in] filename The name of the file
+ * @retval 0 on termination without error
+ * @retval Non-zero on failure
+ */
+int Eval_File(char * filename);
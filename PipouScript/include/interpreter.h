@@ -0,0 +1,392 @@
+/**
+ * @file interpreter.h
+ * Bytecode interpreter implementation
+ */
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "nanbox.h"
+#include "hashmap.h"
+#include "vector.h"
+#include "str.h"
+#include "code.h"
+#include "blockobject.h"
+#include "gc.h"
+#include "Common/include/error.h"
+
+/** Maximum number of nested calls */
+#define INTERPRETER_MAX_FRAMES 1024
+
+/** Number of values the stack can hold */
+#define INTERPRETER_STACK_SIZE (INTERPRETER_MAX_FRAMES * 64)
+
+/** Number of blocks the active frames can create in place of heap blocks */
+#define INTERPRETER_FRAME_BLOCKS 2048
+
+/** Number of entries of the global lookup cache (power of 2) */
+#define INTERPRETER_MEGAMORPHIC_CACHE_SIZE 1024
+
+typedef enum {
+    INTERPRETER_OK,
+    INTERPRETER_ERROR = -1,
+    /**
+     * A block returns from its home method, the native calls between them
+     * are unwound like on an error
+     */
+    INTERPRETER_RETURNING = -2
+} interpreter_status_t;
+
+/**
+ * Represents the activation of a block
+ */
+typedef struct frame_s {
+    /** The code being executed */
+    code_t * code;
+
+    /** Next instruction to execute */
+    uint8_t * ip;
+
+    /** The executed block */
+    nanbox_t block;
+
+    /** Value of "this" */
+    nanbox_t this;
+
+    /**
+     * Heap context holding the local variables when they can be captured
+     * by inner blocks (or null)
+     */
+    nanbox_t context;
+
+    /** Local variables, either on the stack or in the context */
+    nanbox_t * locals;
+
+    /**
+     * First stack slot used by the frame, the result of the
+     * block is stored there when it returns
+     */
+    nanbox_t * base;
+
+    /** Activation number, unique among the frames ever pushed */
+    size_t activation;
+
+    /**
+     * Storage of the blocks created by OP_MAKE_FRAME_BLOCK, one per block
+     * litteral of the code (NULL when the interpreter storage is exhausted,
+     * the blocks are then allocated in the heap)
+     */
+    blockobject_t * blocks;
+} frame_t;
+
+/**
+ * Counters of the message lookup caches
+ */
+typedef struct {
+    /** Lookups answered by the cache of a send site */
+    size_t hits;
+
+    /** Lookups a send site had to perform */
+    size_t misses;
+
+    /** Lookups answered by the global cache */
+    size_t megamorphic_hits;
+
+    /** Lookups the global cache had to perform */
+    size_t megamorphic_misses;
+} interpreter_cache_stats_t;
+
+/**
+ * Execution counts of the opcode sequences, only gathered by the builds
+ * that define INTERPRETER_PROFILE_OPCODES (make PROFILE=opcodes)
+ */
+typedef struct {
+    /** Executions of each opcode */
+    uint64_t singles[OPCODES_NUMBER];
+
+    /** Executions of each opcode right after another */
+    uint64_t pairs[OPCODES_NUMBER][OPCODES_NUMBER];
+
+    /** Executions of each opcode right after two others */
+    uint64_t triples[OPCODES_NUMBER][OPCODES_NUMBER][OPCODES_NUMBER];
+
+    /** Last executed opcodes, the most recent first */
+    opcode_t previous[2];
+
+    /** Number of valid entries of previous */
+    size_t previous_count;
+} interpreter_opcode_profile_t;
+
+/** Number of source lines an allocation profile can tell apart */
+#define INTERPRETER_ALLOCATION_SITES 4096
+
+/**
+ * Allocations performed by the instructions of a source line
+ */
+typedef struct {
+    /** Code of the instructions (NULL for an unused site) */
+    code_t * code;
+
+    /** Line of the instructions */
+    size_t line;
+
+    /** Number of allocated objects */
+    size_t count;
+
+    /** Size of the allocated objects, in bytes */
+    size_t bytes;
+} interpreter_allocation_site_t;
+
+/**
+ * Allocations counted by source line, only gathered by the builds that
+ * define INTERPRETER_PROFILE_ALLOCATIONS (make PROFILE=allocations)
+ */
+typedef struct {
+    /** The sites, by hash of their code and line */
+    interpreter_allocation_site_t sites[INTERPRETER_ALLOCATION_SITES];
+
+    /** Number of used sites */
+    size_t sites_count;
+
+    /**
+     * Allocations performed outside of the scripts (by the runtime
+     * itself) or once all the sites are used
+     */
+    interpreter_allocation_site_t others;
+} interpreter_allocation_profile_t;
+
+typedef struct interpreter_s {
+    /**
+     * Compiled chunks, they are kept alive as long as the interpreter
+     * because blocks reference their code
+     * vector_t<code_t *>
+     */
+    vector_t * chunks;
+
+    /** Global variables */
+    hashmap_t * globals;
+
+    /** Prototypes used for values that don't have one */
+    nanbox_t object_proto;
+    nanbox_t number_proto;
+    nanbox_t boolean_proto;
+    nanbox_t string_proto;
+    nanbox_t array_proto;
+    nanbox_t block_proto;
+
+    /** Call stack */
+    frame_t frames[INTERPRETER_MAX_FRAMES];
+    size_t frames_count;
+
+    /** Number of frames pushed so far */
+    size_t activations;
+
+    /** Storage of the frame blocks, the frames reserve it in stack order */
+    blockobject_t frame_blocks[INTERPRETER_FRAME_BLOCKS];
+    size_t frame_blocks_count;
+
+    /**
+     * Frame of the method a non-local return is unwinding to and the value
+     * it returns, when the status is INTERPRETER_RETURNING
+     */
+    size_t return_home;
+    nanbox_t return_value;
+
+    /** Values stack */
+    nanbox_t stack[INTERPRETER_STACK_SIZE];
+    nanbox_t * sp;
+
+    /**
+     * Lookups of the send sites that saw too many receiver kinds and of
+     * the messages sent by native code, indexed by receiver and selector
+     */
+    inline_cache_entry_t megamorphic_cache[INTERPRETER_MEGAMORPHIC_CACHE_SIZE];
+
+    /** Counters of the lookup caches */
+    interpreter_cache_stats_t cache_stats;
+
+    /** Opcode sequences counts, NULL when the build doesn't profile them */
+    interpreter_opcode_profile_t * opcode_profile;
+
+    /** Allocations by source line, NULL when the build doesn't profile them */
+    interpreter_allocation_profile_t * allocation_profile;
+
+    /**
+     * Finalizers whose object was collected, they are called by the next
+     * call (vector_t<nanbox_t>)
+     */
+    vector_t * finalizers;
+
+    /** Whether the finalizers are being called */
+    bool finalizing;
+
+    /** Heap account the memory the interpreter allocates is charged to */
+    gc_account_t heap_account;
+
+    /**
+     * Size of the memory charged to the interpreter above which its code
+     * raises "Out of memory" errors, in bytes (0 for no limit)
+     */
+    size_t heap_limit;
+
+    /** Whether the next call ignores the limit, to run an error handler */
+    bool heap_limit_skip;
+
+    /** Status of the interpreter */
+    interpreter_status_t status;
+
+    /** Last error that occured if any */
+    error_t * error;
+} interpreter_t;
+
+/**
+ * Allocates a new interpreter with its builtin objects
+ * @returns The newly allocated interpreter
+ */
+interpreter_t * Interpreter_New(void);
+
+/**
+ * Frees an interpreter, its globals and its compiled code
+ * @param[in] interpreter The interpreter to free
+ */
+void Interpreter_Free(interpreter_t * interpreter);
+
+/**
+ * Returns the status of the interpreter
+ * @returns the status of the interpreter
+ */
+interpreter_status_t Interpreter_GetStatus(interpreter_t * interpreter);
+
+/**
+ * Returns the error that the interpreter encountered if any
+ * @retval NULL if no error
+ * @retval A pointer to an error if any
+ */
+error_t * Interpreter_GetError(interpreter_t * interpreter);
+
+/**
+ * Returns the counters of the message lookup caches
+ * @param[in] interpreter The interpreter
+ * @returns               The counters
+ */
+interpreter_cache_stats_t Interpreter_GetCacheStats(interpreter_t * interpreter);
+
+/**
+ * Writes the opcode sequences counts, one sequence per line: its count
+ * followed by the names of its opcodes. Nothing is written when the
+ * build doesn't profile them
+ * @param[in] interpreter The interpreter
+ * @param[in] file        The file to write to
+ */
+void Interpreter_WriteOpcodeProfile(interpreter_t * interpreter, FILE * file);
+
+/**
+ * Writes the source lines that allocated the most objects, then those
+ * that allocated the most bytes. Nothing is written when the build
+ * doesn't profile them
+ * @param[in] interpreter The interpreter
+ * @param[in] file        The file to write to
+ * @param     top         Number of lines of each ranking
+ */
+void Interpreter_WriteAllocationProfile(interpreter_t * interpreter, FILE * file, size_t top);
+
+/**
+ * Calls a block once an object is collected, at the first call that
+ * follows, the errors it raises are ignored. The block must not reference
+ * the object, else the object is never collected
+ * @param[in] interpreter The interpreter
+ * @param     object      The object
+ * @param     finalizer   The block
+ */
+void Interpreter_AddFinalizer(interpreter_t * interpreter, nanbox_t object, nanbox_t finalizer);
+
+/**
+ * Limits the memory of an interpreter: when a call finds that the memory
+ * charged to the interpreter exceeds the limit, the heap is collected and
+ * the call raises an "Out of memory" error if it still does. The memory
+ * is charged to the interpreter that allocates it, the other interpreters
+ * sharing the heap have their own limits. The handlers of onError: are
+ * called even above the limit
+ * @param[in] interpreter The interpreter
+ * @param     limit       The size, in bytes (0 for no limit)
+ */
+void Interpreter_SetHeapLimit(interpreter_t * interpreter, size_t limit);
+
+/**
+ * Forgets the last error so the interpreter can run code again
+ * @param[in] interpreter The interpreter
+ */
+void Interpreter_ClearError(interpreter_t * interpreter);
+
+/**
+ * Raises a runtime error, the running code is unwound
+ * @param[in] interpreter The interpreter
+ * @param[in] message     The error message (a copy will be performed)
+ */
+void Interpreter_RaiseError(interpreter_t * interpreter, char * message);
+
+/**
+ * Parses, compiles and runs code
+ * @param[in] interpreter The interpreter
+ * @param[in] buffer      The code
+ * @param[in] filename    Name of the file that contains the code (or NULL)
+ * @returns               The value of the code,
+ *                        null if an error occured
+ */
+nanbox_t Interpreter_Eval(interpreter_t * interpreter, char * buffer, char * filename);
+
+/**
+ * Runs a compiled chunk
+ * @param[in] interpreter The interpreter
+ * @param[in] chunk       The chunk (ownership is transfered)
+ * @returns               The value of the chunk,
+ *                        null if an error occured
+ */
+nanbox_t Interpreter_Run(interpreter_t * interpreter, code_t * chunk);
+
+/**
+ * Calls a block
+ * @param[in] interpreter The interpreter
+ * @param     block       The block
+ * @param     this        Value of "this" in the block
+ * @param[in] args        The arguments
+ * @param     argc        Number of arguments
+ * @returns               The value returned by the block,
+ *                        null if an error occured
+ */
+nanbox_t Interpreter_CallBlock(interpreter_t * interpreter, nanbox_t block, nanbox_t this,
+                               nanbox_t * args, size_t argc);
+
+/**
+ * Calls a block with its own "this" or returns the value itself if it's not a block
+ * @param[in] interpreter The interpreter
+ * @param     value       The block or the value
+ * @returns               The result
+ */
+nanbox_t Interpreter_Value(interpreter_t * interpreter, nanbox_t value);
+
+/**
+ * Sends a message to a value
+ * @param[in] interpreter The interpreter
+ * @param     receiver    The receiver of the message
+ * @param[in] selector    The selector of the message (it will be interned)
+ * @param[in] args        The arguments
+ * @param     argc        Number of arguments
+ * @returns               The answer, null if an error occured
+ */
+nanbox_t Interpreter_Send(interpreter_t * interpreter, nanbox_t receiver, char * selector,
+                          nanbox_t * args, size_t argc);
+
+/**
+ * Indicates whether a value is considered true by conditions
+ * @param value The value
+ * @returns     false for False and Null, true otherwise
+ */
+bool Interpreter_IsTruthy(nanbox_t value);
+
+/**
+ * Builds a printable representation of a value
+ * @param value The value
+ * @returns     The representation
+ */
+string * Interpreter_ValueToString(nanbox_t value);
@@ -0,0 +1,263 @@
+/**
+ * @file opcode_targets.h
+ * (Auto-generated) Dispatch table of the interpreter loop
+ * Must be included in the function that defines the TARGET_* labels
+ */
+static void * opcode_targets[256] = {
+    &&TARGET_OP_NOP,
+    &&TARGET_OP_POP,
+    &&TARGET_OP_DUP,
+    &&TARGET_OP_PUSH_CONST,
+    &&TARGET_OP_PUSH_NULL,
+    &&TARGET_OP_PUSH_TRUE,
+    &&TARGET_OP_PUSH_FALSE,
+    &&TARGET_OP_PUSH_THIS,
+    &&TARGET_OP_LOAD_LOCAL,
+    &&TARGET_OP_STORE_LOCAL,
+    &&TARGET_OP_LOAD_CAPTURED,
+    &&TARGET_OP_STORE_CAPTURED,
+    &&TARGET_OP_LOAD_GLOBAL,
+    &&TARGET_OP_STORE_GLOBAL,
+    &&TARGET_OP_DECL_GLOBAL,
+    &&TARGET_OP_NEW_OBJECT,
+    &&TARGET_OP_INIT_FIELD,
+    &&TARGET_OP_GET_FIELD,
+    &&TARGET_OP_SET_FIELD,
+    &&TARGET_OP_NEW_ARRAY,
+    &&TARGET_OP_GET_INDEX,
+    &&TARGET_OP_SET_INDEX,
+    &&TARGET_OP_MAKE_BLOCK,
+    &&TARGET_OP_MAKE_FRAME_BLOCK,
+    &&TARGET_OP_SEND,
+    &&TARGET_OP_SEND_BLOCKS,
+    &&TARGET_OP_ADD,
+    &&TARGET_OP_SUB,
+    &&TARGET_OP_MUL,
+    &&TARGET_OP_DIV,
+    &&TARGET_OP_EQ,
+    &&TARGET_OP_NE,
+    &&TARGET_OP_LT,
+    &&TARGET_OP_GT,
+    &&TARGET_OP_LE,
+    &&TARGET_OP_GE,
+    &&TARGET_OP_NOT,
+    &&TARGET_OP_NEG,
+    &&TARGET_OP_POS,
+    &&TARGET_OP_JUMP,
+    &&TARGET_OP_JUMP_IF_FALSE,
+    &&TARGET_OP_JUMP_IF_FALSE_OR_POP,
+    &&TARGET_OP_JUMP_IF_TRUE_OR_POP,
+    &&TARGET_OP_RETURN,
+    &&TARGET_OP_NON_LOCAL_RETURN,
+    &&TARGET_OP_MOVE,
+    &&TARGET_OP_ADD_R,
+    &&TARGET_OP_SUB_R,
+    &&TARGET_OP_MUL_R,
+    &&TARGET_OP_DIV_R,
+    &&TARGET_OP_EQ_R,
+    &&TARGET_OP_NE_R,
+    &&TARGET_OP_LT_R,
+    &&TARGET_OP_GT_R,
+    &&TARGET_OP_LE_R,
+    &&TARGET_OP_GE_R,
+    &&TARGET_OP_SEND_R0,
+    &&TARGET_OP_SEND_R1,
+    &&TARGET_OP_SEND_R2,
+    &&TARGET_OP_PUSH_NULL_RETURN,
+    &&TARGET_OP_PUSH_CONST_ADD,
+    &&TARGET_OP_PUSH_CONST_SUB,
+    &&TARGET_OP_PUSH_CONST_LT,
+    &&TARGET_OP_PUSH_THIS_GET_FIELD,
+    &&TARGET_OP_LOAD_LOCAL_GET_FIELD,
+    &&TARGET_OP_LOAD_LOCAL_SEND,
+    &&TARGET_OP_GET_FIELD_SEND,
+    &&TARGET_OP_LOAD_LOCAL_GET_FIELD_SEND,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+    &&TARGET_UNKNOWN,
+};
@@ -10,6 +10,10 @@
 typedef enum {
     REPL_CMD_NONE,
     REPL_CMD_MULTILINE,
+    REPL_CMD_DEBUG,
+    REPL_CMD_CACHE,
+    REPL_CMD_HEAP,
+    REPL_CMD_ALLOCATIONS,
 } repl_cmd_type_t;
 
 /**
@@ -0,0 +1,1987 @@
+/**
+ * @file interpreter.c
+ * Bytecode interpreter implementation
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include "interpreter.h"
+#include "builtins.h"
+#include "code.h"
+#include "opcodes.h"
+#include "compiler.h"
+#include "Parser/include/parser.h"
+#include "ast.h"
+#include "object.h"
+#include "arrayobject.h"
+#include "stringobject.h"
+#include "blockobject.h"
+#include "nativeblockobject.h"
+#include "contextobject.h"
+#include "shape.h"
+#include "gc.h"
+#include "nanbox.h"
+#include "hashmap.h"
+#include "vector.h"
+#include "str.h"
+#include "symbol.h"
+#include "Common/include/error.h"
+
+// labels as values are a GNU extension
+#if !defined(__GNUC__) && !defined(INTERPRETER_SWITCH_DISPATCH)
+#define INTERPRETER_SWITCH_DISPATCH
+#endif
+
+// int32 operations that report an overflow instead of wrapping
+#if defined(__GNUC__)
+#define INT32_ADD_OVERFLOW(x, y, result) __builtin_add_overflow((x), (y), (result))
+#define INT32_SUB_OVERFLOW(x, y, result) __builtin_sub_overflow((x), (y), (result))
+#define INT32_MUL_OVERFLOW(x, y, result) __builtin_mul_overflow((x), (y), (result))
+#else
+static bool Interpreter_Int32Overflow(int64_t value, int32_t * result) {
+    *result = (int32_t)value;
+    return value < INT32_MIN || value > INT32_MAX;
+}
+#define INT32_ADD_OVERFLOW(x, y, result) Interpreter_Int32Overflow((int64_t)(x) + (y), (result))
+#define INT32_SUB_OVERFLOW(x, y, result) Interpreter_Int32Overflow((int64_t)(x) - (y), (result))
+#define INT32_MUL_OVERFLOW(x, y, result) Interpreter_Int32Overflow((int64_t)(x) * (y), (result))
+#endif
+
+/** Nesting level after which values are not printed anymore */
+#define MAX_PRINT_DEPTH 3
+
+#define STACK_END(interp) ((interp)->stack + INTERPRETER_STACK_SIZE)
+
+/**
+ * Raises a runtime error with a formatted message
+ */
+static void Interpreter_RaiseErrorf(interpreter_t * interp, char * format, ...) {
+    char buf[256];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buf, 256, format, args);
+    va_end(args);
+    Interpreter_RaiseError(interp, buf);
+}
+
+/**
+ * Drops the values of the stack down to a given slot
+ */
+static void Interpreter_PopValues(interpreter_t * interp, nanbox_t * base) {
+    interp->sp = base;
+}
+
+/********************** Messages lookup ******************************/
+
+typedef enum {
+    /** A message: the receiver, its prototypes then the prototype of its type */
+    LOOKUP_MESSAGE,
+    /** A field read: the receiver and its prototypes */
+    LOOKUP_FIELD,
+    /** A field write: the receiver only */
+    LOOKUP_OWN_FIELD
+} lookup_kind_t;
+
+/**
+ * Returns the prototype that holds the builtin messages of a value
+ */
+static nanbox_t Interpreter_TypeProto(interpreter_t * interp, nanbox_t value) {
+    if (nanbox_is_number(value)) return interp->number_proto;
+    if (nanbox_is_boolean(value)) return interp->boolean_proto;
+    if (nanbox_is_pointer(value)) {
+        switch (((object_t *)nanbox_to_pointer(value))->type) {
+            case STRING_OBJECT: return interp->string_proto;
+            case ARRAY_OBJECT:  return interp->array_proto;
+            case BLOCK_OBJECT:
+            case NATIVE_BLOCK:  return interp->block_proto;
+            default:            break;
+        }
+    }
+    return interp->object_proto;
+}
+
+/**
+ * Looks for a field without using the caches of the sites, the
+ * prototypes are searched through the global cache of the objects
+ * (see Object_Lookup)
+ * @param[out] slot The slot of the field in the object that holds it
+ * @returns         The object that holds the field or NULL if not found
+ */
+static object_t * Interpreter_Lookup(interpreter_t * interp, nanbox_t receiver, char * name,
+                                     lookup_kind_t kind, size_t * slot) {
+    object_t * holder = NULL;
+    object_t * type_proto_ptr;
+    ssize_t found;
+
+    switch (kind) {
+        case LOOKUP_MESSAGE:
+            holder = Object_Lookup(receiver, name, slot);
+            if (!holder) {
+                type_proto_ptr = nanbox_to_pointer(Interpreter_TypeProto(interp, receiver));
+                type_proto_ptr->in_lookup_cache = true;
+                holder = Object_Lookup(nanbox_from_pointer(type_proto_ptr), name, slot);
+            }
+            break;
+        case LOOKUP_FIELD:
+            holder = Object_Lookup(receiver, name, slot);
+            break;
+        case LOOKUP_OWN_FIELD:
+            found = Shape_Lookup(((object_t *)nanbox_to_pointer(receiver))->shape, name);
+            if (found >= 0) {
+                holder = nanbox_to_pointer(receiver);
+                *slot = found;
+            }
+            break;
+    }
+    return holder;
+}
+
+/**
+ * Computes the key of the receivers that resolve a name the same way:
+ * their shape and, unless only the receiver is searched, what follows
+ * the receiver in the lookup
+ * @returns An entry whose shape_id and proto_key are set
+ */
+static inline_cache_entry_t Interpreter_CacheKey(interpreter_t * interp, nanbox_t receiver,
+                                                 lookup_kind_t kind) {
+    inline_cache_entry_t key = { 0, 0, 0, NULL, 0, NULL };
+    object_t * object_ptr = NULL;
+    object_t * next_ptr = NULL;
+
+    if (nanbox_is_pointer(receiver)) {
+        object_ptr = nanbox_to_pointer(receiver);
+        key.shape_id = object_ptr->shape->id;
+        if (nanbox_is_pointer(object_ptr->prototype)) {
+            next_ptr = nanbox_to_pointer(object_ptr->prototype);
+        }
+    }
+    if (kind == LOOKUP_MESSAGE) {
+        // the prototype of the type is searched at the end of the lookup
+        if (!next_ptr) next_ptr = nanbox_to_pointer(Interpreter_TypeProto(interp, receiver));
+        key.proto_key = next_ptr->id << 3 | (object_ptr ? object_ptr->type + 1 : 0);
+    } else if (kind == LOOKUP_FIELD) {
+        key.proto_key = next_ptr ? next_ptr->id : 0;
+    }
+    return key;
+}
+
+/**
+ * Returns the address of the field a cached lookup found
+ */
+static nanbox_t * Interpreter_CachedSlot(inline_cache_entry_t * cached, nanbox_t receiver) {
+    object_t * holder = cached->holder ? cached->holder : nanbox_to_pointer(receiver);
+    return &holder->slots[cached->slot];
+}
+
+/**
+ * Remembers the result of a lookup in a cache entry whose key is already set
+ */
+static void Interpreter_StoreLookup(inline_cache_entry_t * cached, nanbox_t receiver, char * name,
+                                    object_t * holder, size_t slot) {
+    // the entry serves every receiver with the same key
+    bool own = nanbox_is_pointer(receiver) && holder == nanbox_to_pointer(receiver);
+    cached->holder = own ? NULL : holder;
+    cached->slot = slot;
+    cached->epoch = object_lookup_epoch;
+    cached->name = name;
+}
+
+/**
+ * Looks for a message in the global cache, performs the lookup on a miss
+ * @returns The address of the field or NULL if not found
+ */
+static nanbox_t * Interpreter_MegamorphicLookup(interpreter_t * interp, nanbox_t receiver,
+                                                char * selector, inline_cache_entry_t * key) {
+    size_t hash = (key->shape_id * 31 + key->proto_key) * 31 ^ (uintptr_t)selector >> 3;
+    inline_cache_entry_t * cached = &interp->megamorphic_cache[hash & (INTERPRETER_MEGAMORPHIC_CACHE_SIZE - 1)];
+    object_t * holder;
+    size_t slot;
+
+    // selectors are symbols
+    if (cached->name == selector && cached->shape_id == key->shape_id
+            && cached->proto_key == key->proto_key && cached->epoch == object_lookup_epoch) {
+        interp->cache_stats.megamorphic_hits++;
+        return Interpreter_CachedSlot(cached, receiver);
+    }
+    interp->cache_stats.megamorphic_misses++;
+    holder = Interpreter_Lookup(interp, receiver, selector, LOOKUP_MESSAGE, &slot);
+    if (!holder) return NULL;
+    *cached = *key;
+    Interpreter_StoreLookup(cached, receiver, selector, holder, slot);
+    return &holder->slots[slot];
+}
+
+/**
+ * Looks for a name using the cache of a site: up to INLINE_CACHE_SIZE
+ * receiver shapes are remembered, then message sends use the global cache
+ * of the interpreter and field reads the one of the objects
+ * @param[in] cache The cache of the site or NULL to use the global cache
+ * @returns         The address of the field or NULL if not found
+ */
+static nanbox_t * Interpreter_CachedLookup(interpreter_t * interp, nanbox_t receiver, char * name,
+                                           inline_cache_t * cache, lookup_kind_t kind) {
+    inline_cache_entry_t key = Interpreter_CacheKey(interp, receiver, kind);
+    inline_cache_entry_t * cached = NULL;
+    object_t * holder;
+    size_t slot;
+
+    if (kind == LOOKUP_MESSAGE && (!cache || cache->megamorphic)) {
+        return Interpreter_MegamorphicLookup(interp, receiver, name, &key);
+    }
+    for (size_t i = 0; i < cache->count && !cache->megamorphic; i++) {
+        cached = &cache->entries[i];
+        if (cached->shape_id == key.shape_id && cached->proto_key == key.proto_key
+                && cached->epoch == object_lookup_epoch) {
+            interp->cache_stats.hits++;
+            return Interpreter_CachedSlot(cached, receiver);
+        }
+    }
+    interp->cache_stats.misses++;
+    holder = Interpreter_Lookup(interp, receiver, name, kind, &slot);
+    if (!holder || cache->megamorphic) {
+        return holder ? &holder->slots[slot] : NULL;
+    }
+
+    // reuse the entries invalidated by a change of the prototypes
+    cached = NULL;
+    for (size_t i = 0; i < cache->count && !cached; i++) {
+        if (cache->entries[i].epoch != object_lookup_epoch) {
+            cached = &cache->entries[i];
+        }
+    }
+    if (!cached && cache->count < INLINE_CACHE_SIZE) {
+        cached = &cache->entries[cache->count++];
+    }
+    if (cached) {
+        *cached = key;
+        Interpreter_StoreLookup(cached, receiver, name, holder, slot);
+    } else {
+        cache->megamorphic = true;
+    }
+    return &holder->slots[slot];
+}
+
+/**
+ * Reads a name no field of an object has, only its intrinsic properties
+ * (see Object_GetIntrinsic) are not Null
+ */
+static nanbox_t Interpreter_GetIntrinsic(nanbox_t object, char * name) {
+    nanbox_t value;
+
+    return Object_GetIntrinsic(object, name, &value) ? value : nanbox_null();
+}
+
+/********************** Frames ******************************/
+
+/**
+ * Deactivates the current frame and releases its blocks
+ */
+static void Interpreter_PopFrame(interpreter_t * interp) {
+    frame_t * frame = &interp->frames[--interp->frames_count];
+
+    Interpreter_PopValues(interp, frame->base);
+    // the locals written since an incremental marking traced the context
+    if (gc_marking && nanbox_is_pointer(frame->context)) {
+        GC_Rescan(nanbox_to_pointer(frame->context));
+    }
+    if (frame->blocks) {
+        for (size_t i = 0; i < frame->code->frame_blocks_count; i++) {
+            // the storage of the block is reused by the next frames
+            if (frame->blocks[i].code) Object_Free((object_t *)&frame->blocks[i]);
+        }
+        interp->frame_blocks_count = frame->blocks - interp->frame_blocks;
+    }
+}
+
+/**
+ * Calls the finalizers whose object was collected, their errors are ignored
+ */
+static void Interpreter_RunFinalizers(interpreter_t * interp) {
+    interp->finalizing = true;
+    while (Vec_GetLength(interp->finalizers) > 0) {
+        Interpreter_Value(interp, Vec_Pop(interp->finalizers));
+        if (interp->status != INTERPRETER_OK) Interpreter_ClearError(interp);
+    }
+    interp->finalizing = false;
+}
+
+/**
+ * Activates a block whose "this" and arguments are on the stack
+ * @param     block The block
+ * @param[in] base  Slot holding "this", followed by the arguments
+ * @param     argc  Number of arguments
+ * @returns         false if the block cannot be called
+ */
+static bool Interpreter_PushFrame(interpreter_t * interp, nanbox_t block, nanbox_t * base,
+                                  size_t argc) {
+    blockobject_t * block_ptr = nanbox_to_pointer(block);
+    code_t * code = block_ptr->code;
+    frame_t * frame;
+
+    if (argc != code->params_count) {
+        Interpreter_RaiseErrorf(interp, "Block expects %ld argument(s) but %ld were given",
+                                code->params_count, argc);
+        return false;
+    }
+    if (interp->frames_count == INTERPRETER_MAX_FRAMES
+            || base + 1 + code->locals_count > STACK_END(interp)) {
+        Interpreter_RaiseError(interp, "Stack overflow");
+        return false;
+    }
+
+    // the memory the call allocates is charged to the interpreter
+    GC_SetAccount(interp->heap_account);
+    frame = &interp->frames[interp->frames_count++];
+    frame->code = code;
+    frame->ip = code->bytecode;
+    frame->block = block;
+    // the frame takes the value of the stack slot
+    frame->this = *base;
+    *base = nanbox_null();
+    frame->base = base;
+    frame->activation = ++interp->activations;
+
+    if (code->frame_blocks_count > 0
+            && interp->frame_blocks_count + code->frame_blocks_count <= INTERPRETER_FRAME_BLOCKS) {
+        frame->blocks = &interp->frame_blocks[interp->frame_blocks_count];
+        interp->frame_blocks_count += code->frame_blocks_count;
+        // a free slot has no code
+        for (size_t i = 0; i < code->frame_blocks_count; i++) {
+            frame->blocks[i].code = NULL;
+        }
+    } else {
+        frame->blocks = NULL;
+    }
+
+    if (code->needs_context) {
+        contextobject_t * context_ptr;
+        // the context of a frame block's creator may only be created later
+        // (see Interpreter_BoxFrame)
+        frame->context = ContextObject_New(block_ptr->outer_frame ? block_ptr->outer_frame->context
+                                                                  : block_ptr->outer,
+                                           code->locals_count);
+        context_ptr = nanbox_to_pointer(frame->context);
+        for (size_t i = 0; i < argc; i++) {
+            context_ptr->values[i] = base[1 + i];
+        }
+        interp->sp = base + 1;
+        frame->locals = context_ptr->values;
+    } else {
+        frame->context = nanbox_null();
+        for (size_t i = argc; i < code->locals_count; i++) {
+            base[1 + i] = nanbox_null();
+        }
+        interp->sp = base + 1 + code->locals_count;
+        frame->locals = base + 1;
+    }
+    // every value the running code holds is now reachable from the frames
+    // and the stack, it's the point where the heap can be collected
+    GC_CollectIfNeeded();
+    if (interp->heap_limit && GC_GetAccountSize(interp->heap_account) > interp->heap_limit) {
+        // the garbage may be enough to exceed the limit
+        GC_Collect();
+        // an error handler runs anyway, it may release the memory
+        if (GC_GetAccountSize(interp->heap_account) > interp->heap_limit && !interp->heap_limit_skip) {
+            Interpreter_PopFrame(interp);
+            Interpreter_RaiseError(interp, "Out of memory");
+            return false;
+        }
+    }
+    interp->heap_limit_skip = false;
+    // the finalizers run on top of the new frame, before its code
+    if (interp->finalizers->length > 0 && !interp->finalizing) Interpreter_RunFinalizers(interp);
+    return true;
+}
+
+/**
+ * Moves the local variables of a frame to a heap context, if they are not
+ * already there, so blocks can capture them beyond the frame blocks
+ * @param depth Number of contexts the captures reach, from the one of the frame
+ * @returns     The context
+ */
+static nanbox_t Interpreter_BoxFrame(frame_t * frame, size_t depth) {
+    blockobject_t * block_ptr = nanbox_to_pointer(frame->block);
+    contextobject_t * context_ptr;
+    nanbox_t parent = block_ptr->outer;
+
+    if (nanbox_is_pointer(frame->context)) {
+        // a frame block may have created its context before its creator had one
+        context_ptr = nanbox_to_pointer(frame->context);
+        if (block_ptr->outer_frame && depth > 1 && !nanbox_is_pointer(context_ptr->parent)) {
+            context_ptr->parent = Interpreter_BoxFrame(block_ptr->outer_frame, depth - 1);
+        }
+        return frame->context;
+    }
+    if (block_ptr->outer_frame && depth > 1) {
+        parent = Interpreter_BoxFrame(block_ptr->outer_frame, depth - 1);
+    }
+    frame->context = ContextObject_New(parent, frame->code->locals_count);
+    context_ptr = nanbox_to_pointer(frame->context);
+    for (size_t i = 0; i < frame->code->locals_count; i++) {
+        context_ptr->values[i] = frame->locals[i];
+        frame->locals[i] = nanbox_null();
+    }
+    frame->locals = context_ptr->values;
+    return frame->context;
+}
+
+/**
+ * Records the method activation a new block returns from with "^": the
+ * frame that creates it if it runs a method, otherwise the home of the
+ * block that runs in the frame
+ */
+static void Interpreter_SetHome(interpreter_t * interp, blockobject_t * block_ptr, frame_t * frame) {
+    if (frame->code->kind == CODE_METHOD) {
+        block_ptr->home_frame = frame - interp->frames;
+        block_ptr->home_activation = frame->activation;
+    } else if (BlockObject_Check(frame->block)) {
+        blockobject_t * outer_ptr = nanbox_to_pointer(frame->block);
+        block_ptr->home_frame = outer_ptr->home_frame;
+        block_ptr->home_activation = outer_ptr->home_activation;
+    }
+}
+
+/**
+ * Allocates in the heap a block created in a frame, the frames it
+ * captures variables from move them to contexts
+ * @param[in] code  The code of the block
+ * @param[in] frame The frame that creates the block
+ * @returns         The block
+ */
+static nanbox_t Interpreter_NewHeapBlock(interpreter_t * interp, code_t * code, frame_t * frame) {
+    nanbox_t outer = code->captured_depth > 0 ? Interpreter_BoxFrame(frame, code->captured_depth)
+                                              : nanbox_null();
+    nanbox_t block = BlockObject_New(code, outer, frame->this);
+
+    Interpreter_SetHome(interp, nanbox_to_pointer(block), frame);
+    return block;
+}
+
+/**
+ * Replaces the frame blocks among values by heap copies, because the code
+ * they are given to may keep them
+ * @param[in] values The values
+ * @param     count  Number of values
+ */
+static void Interpreter_MoveBlocksToHeap(interpreter_t * interp, nanbox_t * values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        blockobject_t * block_ptr;
+
+        if (!BlockObject_Check(values[i])) continue;
+        block_ptr = nanbox_to_pointer(values[i]);
+        if (block_ptr->outer_frame) {
+            nanbox_t block = Interpreter_NewHeapBlock(interp, block_ptr->code, block_ptr->outer_frame);
+            values[i] = block;
+        }
+    }
+}
+
+/**
+ * Starts the unwinding of the frames up to the home method of the block
+ * that runs in a frame
+ * @param[in] frame The frame that returns
+ * @param     value The returned value
+ */
+static void Interpreter_NonLocalReturn(interpreter_t * interp, frame_t * frame, nanbox_t value) {
+    blockobject_t * block_ptr = nanbox_to_pointer(frame->block);
+    size_t home = block_ptr->home_frame;
+
+    if (block_ptr->home_activation == 0 || home >= interp->frames_count
+            || interp->frames[home].activation != block_ptr->home_activation) {
+        Interpreter_RaiseError(interp, "Cannot return from a method that already returned");
+        return;
+    }
+    interp->status = INTERPRETER_RETURNING;
+    interp->return_home = home;
+    interp->return_value = value;
+}
+
+/**
+ * Sends a message to a receiver that is on the stack followed by the arguments.
+ * If the message resolves to a block a frame is pushed, otherwise the answer
+ * replaces the receiver and the arguments
+ * @param[in] cache        The lookup cache of the send site or NULL
+ * @param     frame_blocks Whether the receiver or the arguments can be frame blocks
+ * @returns                false if an error occured
+ */
+static bool Interpreter_SendOnStack(interpreter_t * interp, char * selector, size_t argc,
+                                    inline_cache_t * cache, bool frame_blocks) {
+    nanbox_t * base = interp->sp - argc - 1;
+    nanbox_t receiver = *base;
+    nanbox_t * field = Interpreter_CachedLookup(interp, receiver, selector, cache, LOOKUP_MESSAGE);
+    nanbox_t method;
+
+    if (!field) {
+        Interpreter_RaiseErrorf(interp, "Message '%s' not understood", selector);
+        return false;
+    }
+    method = *field;
+    // only the builtins that just call the blocks can receive frame blocks
+    if (frame_blocks && !(NativeBlockObject_Check(method)
+                          && ((nativeblockobject_t *)nanbox_to_pointer(method))->borrows_blocks)) {
+        Interpreter_MoveBlocksToHeap(interp, base, argc + 1);
+    }
+
+    if (BlockObject_Check(method)) {
+        return Interpreter_PushFrame(interp, method, base, argc);
+    } else if (NativeBlockObject_Check(method)) {
+        nativeblockobject_t * native_ptr = nanbox_to_pointer(method);
+        nanbox_t result;
+
+        if (native_ptr->params_count != NATIVE_BLOCK_VARIADIC && native_ptr->params_count != argc) {
+            Interpreter_RaiseErrorf(interp, "Message '%s' expects %ld argument(s) but %ld were given",
+                                    selector, native_ptr->params_count, argc);
+            return false;
+        }
+        result = native_ptr->func(interp, receiver, base + 1, argc);
+        Interpreter_PopValues(interp, base);
+        *interp->sp++ = result;
+    } else if (argc == 0) {
+        // a field is its own getter
+        *base = method;
+    } else {
+        Interpreter_RaiseErrorf(interp, "Message '%s' not understood", selector);
+        return false;
+    }
+    return interp->status == INTERPRETER_OK;
+}
+
+/********************** Operations ******************************/
+
+static nanbox_t Interpreter_FromInt64(int64_t value) {
+    if (value < INT32_MIN || value > INT32_MAX) {
+        return nanbox_from_double((double)value);
+    }
+    return nanbox_from_int((int32_t)value);
+}
+
+/**
+ * Applies a binary operator to two numbers
+ */
+static nanbox_t Interpreter_NumericOp(interpreter_t * interp, opcode_t opcode,
+                                      nanbox_t a, nanbox_t b) {
+    if (nanbox_is_int(a) && nanbox_is_int(b)) {
+        int64_t x = nanbox_to_int(a), y = nanbox_to_int(b);
+        switch (opcode) {
+            case OP_ADD: return Interpreter_FromInt64(x + y);
+            case OP_SUB: return Interpreter_FromInt64(x - y);
+            case OP_MUL: return Interpreter_FromInt64(x * y);
+            case OP_DIV:
+                if (y == 0) break;
+                // the division of two integers stays an integer when it's exact
+                if (x % y == 0) return Interpreter_FromInt64(x / y);
+                return nanbox_from_double((double)x / (double)y);
+            case OP_EQ:  return nanbox_from_boolean(x == y);
+            case OP_NE:  return nanbox_from_boolean(x != y);
+            case OP_LT:  return nanbox_from_boolean(x < y);
+            case OP_GT:  return nanbox_from_boolean(x > y);
+            case OP_LE:  return nanbox_from_boolean(x <= y);
+            case OP_GE:  return nanbox_from_boolean(x >= y);
+            default:     break;
+        }
+    } else {
+        double x = nanbox_to_number(a), y = nanbox_to_number(b);
+        switch (opcode) {
+            case OP_ADD: return nanbox_from_double(x + y);
+            case OP_SUB: return nanbox_from_double(x - y);
+            case OP_MUL: return nanbox_from_double(x * y);
+            case OP_DIV:
+                if (y == 0) break;
+                return nanbox_from_double(x / y);
+            case OP_EQ:  return nanbox_from_boolean(x == y);
+            case OP_NE:  return nanbox_from_boolean(x != y);
+            case OP_LT:  return nanbox_from_boolean(x < y);
+            case OP_GT:  return nanbox_from_boolean(x > y);
+            case OP_LE:  return nanbox_from_boolean(x <= y);
+            case OP_GE:  return nanbox_from_boolean(x >= y);
+            default:     break;
+        }
+    }
+    Interpreter_RaiseError(interp, "Division by zero");
+    return nanbox_null();
+}
+
+/**
+ * Compares two values: numbers and strings by value, other values by identity
+ */
+static bool Interpreter_Equals(nanbox_t a, nanbox_t b) {
+    if (nanbox_is_number(a) && nanbox_is_number(b)) {
+        return nanbox_to_number(a) == nanbox_to_number(b);
+    }
+    if (StringObject_Check(a) && StringObject_Check(b)) {
+        return strcmp(StringObject_GetValue(a), StringObject_GetValue(b)) == 0;
+    }
+    return a.as_int64 == b.as_int64;
+}
+
+/**
+ * Returns the message sent when an operator is applied to a non-number
+ */
+static char * Interpreter_OperatorSelector(opcode_t opcode) {
+    char * selector;
+
+    switch (opcode) {
+        case OP_ADD: selector = "+"; break;
+        case OP_SUB: selector = "-"; break;
+        case OP_MUL: selector = "*"; break;
+        case OP_DIV: selector = "/"; break;
+        case OP_LT:  selector = "<"; break;
+        case OP_GT:  selector = ">"; break;
+        case OP_LE:  selector = "<="; break;
+        case OP_GE:  selector = ">="; break;
+        default:     selector = "?"; break;
+    }
+    return Symbol_Intern(selector);
+}
+
+/**
+ * Checks that a value can be used to index an indexable value of a given length
+ */
+static bool Interpreter_CheckIndex(interpreter_t * interp, nanbox_t index, size_t length) {
+    if (!nanbox_is_int(index)) {
+        Interpreter_RaiseError(interp, "Index must be an integer");
+        return false;
+    }
+    if (nanbox_to_int(index) < 0 || (size_t)nanbox_to_int(index) >= length) {
+        Interpreter_RaiseErrorf(interp, "Index %d out of range", nanbox_to_int(index));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads an item of an array or a character of a string
+ * @returns The item
+ */
+static nanbox_t Interpreter_GetIndex(interpreter_t * interp, nanbox_t object, nanbox_t index) {
+    nanbox_t item = nanbox_null();
+
+    if (ArrayObject_Check(object)) {
+        if (Interpreter_CheckIndex(interp, index, ArrayObject_GetLength(object))) {
+            item = ArrayObject_GetAt(object, nanbox_to_int(index));
+        }
+    } else if (StringObject_Check(object)) {
+        if (Interpreter_CheckIndex(interp, index, StringObject_GetLength(object))) {
+            char buf[2] = { StringObject_GetValue(object)[nanbox_to_int(index)], '\0' };
+            item = StringObject_New(buf);
+        }
+    } else {
+        Interpreter_RaiseError(interp, "Value is not indexable");
+    }
+    return item;
+}
+
+/**
+ * Writes an item of an array, a store after the end extends the array
+ */
+static void Interpreter_SetIndex(interpreter_t * interp, nanbox_t object, nanbox_t index,
+                                 nanbox_t value) {
+    if (ArrayObject_Check(object)) {
+        if (Interpreter_CheckIndex(interp, index, SIZE_MAX)) {
+            ArrayObject_SetAt(object, nanbox_to_int(index), value);
+        }
+    } else {
+        Interpreter_RaiseError(interp, "Value does not support item assignment");
+    }
+}
+
+/**
+ * Finds the variables of the block that declares a captured variable:
+ * frame blocks read them in the frames that created them, the other
+ * blocks in the contexts they captured
+ * @param      depth   Number of blocks between the current one and the one
+ *                     that declares the variable
+ * @param[out] context The context holding the variables, NULL when they
+ *                     belong to an active frame
+ */
+static nanbox_t * Interpreter_CapturedLocals(frame_t * frame, size_t depth,
+                                             contextobject_t ** context) {
+    blockobject_t * block_ptr = nanbox_to_pointer(frame->block);
+    contextobject_t * context_ptr;
+
+    while (block_ptr->outer_frame) {
+        frame = block_ptr->outer_frame;
+        if (--depth == 0) {
+            *context = NULL;
+            return frame->locals;
+        }
+        block_ptr = nanbox_to_pointer(frame->block);
+    }
+    context_ptr = nanbox_to_pointer(block_ptr->outer);
+    for (size_t i = 1; i < depth; i++) {
+        context_ptr = nanbox_to_pointer(context_ptr->parent);
+    }
+    *context = context_ptr;
+    return context_ptr->values;
+}
+
+/********************** Execution ******************************/
+
+#ifdef INTERPRETER_PROFILE_OPCODES
+/**
+ * Counts an executed opcode and the sequences it ends
+ * @returns The opcode
+ */
+static opcode_t Interpreter_ProfileOpcode(interpreter_opcode_profile_t * profile, opcode_t opcode) {
+    profile->singles[opcode]++;
+    if (profile->previous_count > 0) {
+        profile->pairs[profile->previous[0]][opcode]++;
+    }
+    if (profile->previous_count > 1) {
+        profile->triples[profile->previous[1]][profile->previous[0]][opcode]++;
+    }
+    profile->previous[1] = profile->previous[0];
+    profile->previous[0] = opcode;
+    if (profile->previous_count < 2) profile->previous_count++;
+    return opcode;
+}
+#endif
+
+#ifdef INTERPRETER_PROFILE_ALLOCATIONS
+/**
+ * Counts an allocation in the site of the instruction being executed
+ * (see gc_allocation_hook_t)
+ */
+static void Interpreter_ProfileAllocation(size_t size, void * data) {
+    interpreter_t * interp = (interpreter_t *)data;
+    interpreter_allocation_profile_t * profile = interp->allocation_profile;
+    interpreter_allocation_site_t * site = &profile->others;
+
+    if (interp->frames_count > 0) {
+        frame_t * frame = &interp->frames[interp->frames_count - 1];
+        size_t offset = frame->ip - frame->code->bytecode;
+        size_t line = offset ? Code_GetLine(frame->code, offset - 1) : 0;
+        size_t index = (((uintptr_t)frame->code >> 4) * 31 + line) & (INTERPRETER_ALLOCATION_SITES - 1);
+        interpreter_allocation_site_t * candidate;
+
+        // one site is never used so that the search ends
+        while ((candidate = &profile->sites[index])->code
+                && (candidate->code != frame->code || candidate->line != line)) {
+            index = (index + 1) & (INTERPRETER_ALLOCATION_SITES - 1);
+        }
+        if (candidate->code) {
+            site = candidate;
+        } else if (profile->sites_count < INTERPRETER_ALLOCATION_SITES - 1) {
+            candidate->code = frame->code;
+            candidate->line = line;
+            profile->sites_count++;
+            site = candidate;
+        }
+    }
+    site->count++;
+    site->bytes += size;
+}
+#endif
+
+/**
+ * Runs the current frame until the frame at base_frame returns
+ * @returns The value returned by the frame
+ */
+static nanbox_t Interpreter_Execute(interpreter_t * interp, size_t base_frame) {
+    #define PUSH(value)    (*interp->sp++ = (value))
+    #define POP()          (*--interp->sp)
+    #define PEEK(n)        (interp->sp[-1 - (n)])
+    #define READ_OPERAND() (frame->ip += 2, (uint16_t)(frame->ip[-2] | (frame->ip[-1] << 8)))
+    #define NAME(index)    Code_GetName(frame->code, (index))
+    #define CHECK_STACK()  if (interp->sp >= STACK_END(interp)) goto stack_overflow
+#ifdef INTERPRETER_PROFILE_OPCODES
+    #define FETCH()          (opcode = *frame->ip++, Interpreter_ProfileOpcode(interp->opcode_profile, opcode))
+#else
+    #define FETCH()          (opcode = *frame->ip++)
+#endif
+#ifdef INTERPRETER_SWITCH_DISPATCH
+    #define TARGET(op)       case op:
+    #define TARGET_DEFAULT   default
+    #define DISPATCH()       continue
+    #define DISPATCH_START() for (;;) switch (FETCH()) {
+    #define DISPATCH_END()   }
+#else
+    // each handler jumps directly to the handler of the next instruction
+    #define TARGET(op)       TARGET_##op:
+    #define TARGET_DEFAULT   TARGET_UNKNOWN
+    #define DISPATCH()       do { FETCH(); goto *opcode_targets[opcode]; } while (0)
+    #define DISPATCH_START() DISPATCH()
+    #define DISPATCH_END()
+    #include "opcode_targets.h"
+#endif
+    // a superinstruction runs its first instruction and goes on with the
+    // handler of the next one, skipping its opcode instead of dispatching it
+    #define FUSED_TARGET(op)   fused_##op:
+    #define DISPATCH_FUSED(op) do { frame->ip++; opcode = (op); goto fused_##op; } while (0)
+    frame_t * frame = &interp->frames[interp->frames_count - 1];
+    blockobject_t * block_ptr;
+    contextobject_t * context_ptr;
+    nanbox_t * field;
+    nanbox_t a, b, c, result;
+    uint16_t operand, operand2;
+    size_t count;
+    opcode_t opcode;
+
+    DISPATCH_START();
+        TARGET(OP_NOP)
+            DISPATCH();
+
+        TARGET(OP_POP)
+            (void)POP();
+            DISPATCH();
+
+        TARGET(OP_DUP)
+            CHECK_STACK();
+            a = PEEK(0);
+            PUSH(a);
+            DISPATCH();
+
+    // instructions also run by superinstructions
+    #define PUSH_CONST() \
+            CHECK_STACK(); \
+            a = Vec_GetAt(frame->code->constants, READ_OPERAND()); \
+            PUSH(a)
+    #define PUSH_THIS() \
+            CHECK_STACK(); \
+            PUSH(frame->this)
+    #define LOAD_LOCAL() \
+            CHECK_STACK(); \
+            a = frame->locals[READ_OPERAND()]; \
+            PUSH(a)
+
+        TARGET(OP_PUSH_CONST)
+            PUSH_CONST();
+            DISPATCH();
+
+        TARGET(OP_PUSH_NULL)
+            CHECK_STACK();
+            PUSH(nanbox_null());
+            DISPATCH();
+
+        TARGET(OP_PUSH_TRUE)
+            CHECK_STACK();
+            PUSH(nanbox_true());
+            DISPATCH();
+
+        TARGET(OP_PUSH_FALSE)
+            CHECK_STACK();
+            PUSH(nanbox_false());
+            DISPATCH();
+
+        TARGET(OP_PUSH_THIS)
+            PUSH_THIS();
+            DISPATCH();
+
+        TARGET(OP_LOAD_LOCAL)
+            LOAD_LOCAL();
+            DISPATCH();
+
+        TARGET(OP_STORE_LOCAL)
+            operand = READ_OPERAND();
+            frame->locals[operand] = POP();
+            DISPATCH();
+
+        TARGET(OP_LOAD_CAPTURED)
+            CHECK_STACK();
+            operand = READ_OPERAND();
+            operand2 = READ_OPERAND();
+            a = Interpreter_CapturedLocals(frame, operand, &context_ptr)[operand2];
+            PUSH(a);
+            DISPATCH();
+
+        TARGET(OP_STORE_CAPTURED)
+            operand = READ_OPERAND();
+            operand2 = READ_OPERAND();
+            field = &Interpreter_CapturedLocals(frame, operand, &context_ptr)[operand2];
+            *field = POP();
+            if (context_ptr) GC_WRITE_BARRIER(context_ptr, *field);
+            DISPATCH();
+
+        TARGET(OP_LOAD_GLOBAL)
+            CHECK_STACK();
+            operand = READ_OPERAND();
+            if (!HashMap_Get(interp->globals, NAME(operand), &a)) {
+                Interpreter_RaiseErrorf(interp, "Undefined variable '%s'", NAME(operand));
+                goto error;
+            }
+            PUSH(a);
+            DISPATCH();
+
+        TARGET(OP_STORE_GLOBAL)
+            operand = READ_OPERAND();
+            if (!HashMap_Get(interp->globals, NAME(operand), &b)) {
+                Interpreter_RaiseErrorf(interp, "Undefined variable '%s'", NAME(operand));
+                goto error;
+            }
+            HashMap_Set(interp->globals, NAME(operand), POP());
+            DISPATCH();
+
+        TARGET(OP_DECL_GLOBAL)
+            operand = READ_OPERAND();
+            HashMap_Set(interp->globals, NAME(operand), POP());
+            DISPATCH();
+
+        TARGET(OP_NEW_OBJECT)
+            CHECK_STACK();
+            PUSH(Object_New(sizeof(object_t), NULL, NULL));
+            DISPATCH();
+
+        TARGET(OP_INIT_FIELD)
+            a = POP();
+            Object_SetField(PEEK(0), NAME(READ_OPERAND()), a);
+            DISPATCH();
+
+    #define GET_FIELD() \
+            operand = READ_OPERAND(); \
+            operand2 = READ_OPERAND(); \
+            a = POP(); \
+            if (!nanbox_is_pointer(a)) { \
+                Interpreter_RaiseErrorf(interp, "Cannot read field '%s' of a non-object value", \
+                                        NAME(operand)); \
+                goto error; \
+            } \
+            field = Interpreter_CachedLookup(interp, a, NAME(operand), \
+                                             &frame->code->caches[operand2], LOOKUP_FIELD); \
+            b = field ? *field : Interpreter_GetIntrinsic(a, NAME(operand)); \
+            PUSH(b)
+
+        TARGET(OP_GET_FIELD)
+        FUSED_TARGET(OP_GET_FIELD)
+            GET_FIELD();
+            DISPATCH();
+
+        TARGET(OP_SET_FIELD)
+            operand = READ_OPERAND();
+            operand2 = READ_OPERAND();
+            b = POP();
+            a = POP();
+            if (!nanbox_is_pointer(a)) {
+                Interpreter_RaiseErrorf(interp, "Cannot set field '%s' of a non-object value",
+                                        NAME(operand));
+                goto error;
+            }
+            field = Interpreter_CachedLookup(interp, a, NAME(operand),
+                                             &frame->code->caches[operand2], LOOKUP_OWN_FIELD);
+            if (field) {
+                *field = b;
+                GC_WRITE_BARRIER((object_t *)nanbox_to_pointer(a), b);
+            } else {
+                Object_SetField(a, NAME(operand), b);
+            }
+            DISPATCH();
+
+        TARGET(OP_NEW_ARRAY)
+            operand = READ_OPERAND();
+            a = ArrayObject_New();
+            for (size_t i = operand; i > 0; i--) {
+                ArrayObject_Append(a, PEEK(i - 1));
+            }
+            Interpreter_PopValues(interp, interp->sp - operand);
+            PUSH(a);
+            DISPATCH();
+
+        TARGET(OP_GET_INDEX)
+            b = POP();
+            a = POP();
+            result = Interpreter_GetIndex(interp, a, b);
+            if (interp->status != INTERPRETER_OK) goto error;
+            PUSH(result);
+            DISPATCH();
+
+        TARGET(OP_SET_INDEX)
+            c = POP();
+            b = POP();
+            a = POP();
+            Interpreter_SetIndex(interp, a, b, c);
+            if (interp->status != INTERPRETER_OK) goto error;
+            DISPATCH();
+
+        TARGET(OP_MAKE_BLOCK)
+            CHECK_STACK();
+            operand = READ_OPERAND();
+            a = BlockObject_New(nanbox_to_pointer(Vec_GetAt(frame->code->codes, operand)),
+                                frame->context, frame->this);
+            Interpreter_SetHome(interp, nanbox_to_pointer(a), frame);
+            PUSH(a);
+            DISPATCH();
+
+        TARGET(OP_MAKE_FRAME_BLOCK)
+            CHECK_STACK();
+            operand = READ_OPERAND();
+            operand2 = READ_OPERAND();
+            if (!frame->blocks) {
+                PUSH(Interpreter_NewHeapBlock(interp, nanbox_to_pointer(Vec_GetAt(frame->code->codes,
+                                                                                  operand)), frame));
+                DISPATCH();
+            }
+            // the block is created once per activation of the frame, the
+            // next evaluations of the litteral reuse it
+            block_ptr = &frame->blocks[operand2];
+            if (!block_ptr->code) {
+                BlockObject_NewInFrame(block_ptr, nanbox_to_pointer(Vec_GetAt(frame->code->codes, operand)),
+                                       frame, frame->this);
+                Interpreter_SetHome(interp, block_ptr, frame);
+            }
+            a = nanbox_from_pointer(block_ptr);
+            PUSH(a);
+            DISPATCH();
+
+        TARGET(OP_SEND)
+        FUSED_TARGET(OP_SEND)
+            operand = READ_OPERAND();
+            operand2 = READ_OPERAND();
+            if (!Interpreter_SendOnStack(interp, NAME(operand), operand2,
+                                         &frame->code->caches[READ_OPERAND()], false)) goto error;
+            frame = &interp->frames[interp->frames_count - 1];
+            DISPATCH();
+
+        TARGET(OP_SEND_BLOCKS)
+            operand = READ_OPERAND();
+            operand2 = READ_OPERAND();
+            if (!Interpreter_SendOnStack(interp, NAME(operand), operand2,
+                                         &frame->code->caches[READ_OPERAND()], true)) goto error;
+            frame = &interp->frames[interp->frames_count - 1];
+            DISPATCH();
+
+    // int/int and double/double operands are computed in place, without
+    // allocation nor message send, other operands take the generic path
+    #define ARITH_FAST_PATH(int32_overflow, op) \
+            b = PEEK(0); \
+            a = PEEK(1); \
+            if (nanbox_is_int(a) && nanbox_is_int(b)) { \
+                int32_t int_result; \
+                interp->sp--; \
+                if (int32_overflow(nanbox_to_int(a), nanbox_to_int(b), &int_result)) { \
+                    PEEK(0) = nanbox_from_double((double)nanbox_to_int(a) op (double)nanbox_to_int(b)); \
+                } else { \
+                    PEEK(0) = nanbox_from_int(int_result); \
+                } \
+                DISPATCH(); \
+            } \
+            if (nanbox_is_double(a) && nanbox_is_double(b)) { \
+                interp->sp--; \
+                PEEK(0) = nanbox_from_double(nanbox_to_double(a) op nanbox_to_double(b)); \
+                DISPATCH(); \
+            } \
+            goto binary_op
+    #define COMPARE_FAST_PATH(op) \
+            b = PEEK(0); \
+            a = PEEK(1); \
+            if (nanbox_is_int(a) && nanbox_is_int(b)) { \
+                interp->sp--; \
+                PEEK(0) = nanbox_from_boolean(nanbox_to_int(a) op nanbox_to_int(b)); \
+                DISPATCH(); \
+            } \
+            if (nanbox_is_double(a) && nanbox_is_double(b)) { \
+                interp->sp--; \
+                PEEK(0) = nanbox_from_boolean(nanbox_to_double(a) op nanbox_to_double(b)); \
+                DISPATCH(); \
+            } \
+            goto binary_op
+
+        TARGET(OP_ADD)
+        FUSED_TARGET(OP_ADD)
+            ARITH_FAST_PATH(INT32_ADD_OVERFLOW, +);
+
+        TARGET(OP_SUB)
+        FUSED_TARGET(OP_SUB)
+            ARITH_FAST_PATH(INT32_SUB_OVERFLOW, -);
+
+        TARGET(OP_MUL)
+            ARITH_FAST_PATH(INT32_MUL_OVERFLOW, *);
+
+        TARGET(OP_DIV)
+            b = PEEK(0);
+            a = PEEK(1);
+            if (nanbox_is_int(a) && nanbox_is_int(b) && nanbox_to_int(b) != 0) {
+                int32_t x = nanbox_to_int(a), y = nanbox_to_int(b);
+                interp->sp--;
+                // the division of two integers stays an integer when it's exact
+                if ((x != INT32_MIN || y != -1) && x % y == 0) {
+                    PEEK(0) = nanbox_from_int(x / y);
+                } else {
+                    PEEK(0) = nanbox_from_double((double)x / (double)y);
+                }
+                DISPATCH();
+            }
+            if (nanbox_is_double(a) && nanbox_is_double(b) && nanbox_to_double(b) != 0) {
+                interp->sp--;
+                PEEK(0) = nanbox_from_double(nanbox_to_double(a) / nanbox_to_double(b));
+                DISPATCH();
+            }
+            goto binary_op;
+
+        TARGET(OP_EQ)
+            COMPARE_FAST_PATH(==);
+
+        TARGET(OP_NE)
+            COMPARE_FAST_PATH(!=);
+
+        TARGET(OP_LT)
+        FUSED_TARGET(OP_LT)
+            COMPARE_FAST_PATH(<);
+
+        TARGET(OP_GT)
+            COMPARE_FAST_PATH(>);
+
+        TARGET(OP_LE)
+            COMPARE_FAST_PATH(<=);
+
+        TARGET(OP_GE)
+            COMPARE_FAST_PATH(>=);
+
+        binary_op:
+            b = PEEK(0);
+            a = PEEK(1);
+            if (nanbox_is_number(a) && nanbox_is_number(b)) {
+                interp->sp -= 2;
+                result = Interpreter_NumericOp(interp, opcode, a, b);
+                if (interp->status != INTERPRETER_OK) goto error;
+                PUSH(result);
+            } else if (opcode == OP_EQ || opcode == OP_NE) {
+                bool equals = Interpreter_Equals(a, b);
+                interp->sp -= 2;
+                PUSH(nanbox_from_boolean(equals == (opcode == OP_EQ)));
+            } else {
+                // let the objects define their own operators
+                if (!Interpreter_SendOnStack(interp, Interpreter_OperatorSelector(opcode), 1, NULL, false)) {
+                    goto error;
+                }
+                frame = &interp->frames[interp->frames_count - 1];
+            }
+            DISPATCH();
+
+        TARGET(OP_NOT)
+            a = POP();
+            PUSH(nanbox_from_boolean(!Interpreter_IsTruthy(a)));
+            DISPATCH();
+
+        TARGET(OP_NEG)
+        TARGET(OP_POS)
+            a = PEEK(0);
+            if (!nanbox_is_number(a)) {
+                Interpreter_RaiseError(interp, "Unary operator applied to a non-number value");
+                goto error;
+            }
+            if (opcode == OP_NEG) {
+                PEEK(0) = nanbox_is_int(a)
+                    ? Interpreter_FromInt64(-(int64_t)nanbox_to_int(a))
+                    : nanbox_from_double(-nanbox_to_double(a));
+            }
+            DISPATCH();
+
+        TARGET(OP_JUMP)
+            operand = READ_OPERAND();
+            frame->ip = frame->code->bytecode + operand;
+            DISPATCH();
+
+        TARGET(OP_JUMP_IF_FALSE)
+            operand = READ_OPERAND();
+            a = POP();
+            if (!Interpreter_IsTruthy(a)) {
+                frame->ip = frame->code->bytecode + operand;
+            }
+            DISPATCH();
+
+        TARGET(OP_JUMP_IF_FALSE_OR_POP)
+            operand = READ_OPERAND();
+            if (!Interpreter_IsTruthy(PEEK(0))) {
+                frame->ip = frame->code->bytecode + operand;
+            } else {
+                (void)POP();
+            }
+            DISPATCH();
+
+        TARGET(OP_JUMP_IF_TRUE_OR_POP)
+            operand = READ_OPERAND();
+            if (Interpreter_IsTruthy(PEEK(0))) {
+                frame->ip = frame->code->bytecode + operand;
+            } else {
+                (void)POP();
+            }
+            DISPATCH();
+
+        TARGET(OP_RETURN)
+        FUSED_TARGET(OP_RETURN)
+            result = POP();
+        return_result:
+            Interpreter_PopFrame(interp);
+            if (interp->frames_count == base_frame) {
+                return result;
+            }
+            PUSH(result);
+            frame = &interp->frames[interp->frames_count - 1];
+            DISPATCH();
+
+        TARGET(OP_NON_LOCAL_RETURN)
+            // the frames up to the home method are unwound like on an error,
+            // the blocks that don't return that way don't pay for it
+            Interpreter_NonLocalReturn(interp, frame, POP());
+            goto error;
+
+        // Registers
+    // an operand of a register instruction is a slot, a constant or this
+    #define REGISTER(op) ((op) == CODE_REGISTER_THIS ? frame->this \
+                          : (op) & CODE_REGISTER_CONSTANT \
+                          ? Vec_GetAt(frame->code->constants, (op) & ~CODE_REGISTER_CONSTANT) \
+                          : frame->locals[(op)])
+    #define REGISTER_OPERANDS() \
+            operand = READ_OPERAND(); \
+            operand2 = READ_OPERAND(); \
+            a = REGISTER(operand2); \
+            operand2 = READ_OPERAND(); \
+            b = REGISTER(operand2)
+    #define REGISTER_ARITH_FAST_PATH(int32_overflow, op) \
+            REGISTER_OPERANDS(); \
+            if (nanbox_is_int(a) && nanbox_is_int(b)) { \
+                int32_t int_result; \
+                if (int32_overflow(nanbox_to_int(a), nanbox_to_int(b), &int_result)) { \
+                    result = nanbox_from_double((double)nanbox_to_int(a) op (double)nanbox_to_int(b)); \
+                } else { \
+                    result = nanbox_from_int(int_result); \
+                } \
+                goto store_register; \
+            } \
+            if (nanbox_is_double(a) && nanbox_is_double(b)) { \
+                result = nanbox_from_double(nanbox_to_double(a) op nanbox_to_double(b)); \
+                goto store_register; \
+            } \
+            goto register_binary_op
+    #define REGISTER_COMPARE_FAST_PATH(op) \
+            REGISTER_OPERANDS(); \
+            if (nanbox_is_int(a) && nanbox_is_int(b)) { \
+                result = nanbox_from_boolean(nanbox_to_int(a) op nanbox_to_int(b)); \
+                goto store_register; \
+            } \
+            if (nanbox_is_double(a) && nanbox_is_double(b)) { \
+                result = nanbox_from_boolean(nanbox_to_double(a) op nanbox_to_double(b)); \
+                goto store_register; \
+            } \
+            goto register_binary_op
+
+        TARGET(OP_MOVE)
+            operand = READ_OPERAND();
+            operand2 = READ_OPERAND();
+            result = REGISTER(operand2);
+            goto store_register;
+
+        TARGET(OP_ADD_R)
+            REGISTER_ARITH_FAST_PATH(INT32_ADD_OVERFLOW, +);
+
+        TARGET(OP_SUB_R)
+            REGISTER_ARITH_FAST_PATH(INT32_SUB_OVERFLOW, -);
+
+        TARGET(OP_MUL_R)
+            REGISTER_ARITH_FAST_PATH(INT32_MUL_OVERFLOW, *);
+
+        TARGET(OP_DIV_R)
+            REGISTER_OPERANDS();
+            if (nanbox_is_int(a) && nanbox_is_int(b) && nanbox_to_int(b) != 0) {
+                int32_t x = nanbox_to_int(a), y = nanbox_to_int(b);
+                if ((x != INT32_MIN || y != -1) && x % y == 0) {
+                    result = nanbox_from_int(x / y);
+                } else {
+                    result = nanbox_from_double((double)x / (double)y);
+                }
+                goto store_register;
+            }
+            if (nanbox_is_double(a) && nanbox_is_double(b) && nanbox_to_double(b) != 0) {
+                result = nanbox_from_double(nanbox_to_double(a) / nanbox_to_double(b));
+                goto store_register;
+            }
+            goto register_binary_op;
+
+        TARGET(OP_EQ_R)
+            REGISTER_COMPARE_FAST_PATH(==);
+
+        TARGET(OP_NE_R)
+            REGISTER_COMPARE_FAST_PATH(!=);
+
+        TARGET(OP_LT_R)
+            REGISTER_COMPARE_FAST_PATH(<);
+
+        TARGET(OP_GT_R)
+            REGISTER_COMPARE_FAST_PATH(>);
+
+        TARGET(OP_LE_R)
+            REGISTER_COMPARE_FAST_PATH(<=);
+
+        TARGET(OP_GE_R)
+            REGISTER_COMPARE_FAST_PATH(>=);
+
+        register_binary_op:
+            // the register opcodes follow the stack ones in the same order
+            opcode = opcode - OP_ADD_R + OP_ADD;
+            if (nanbox_is_number(a) && nanbox_is_number(b)) {
+                result = Interpreter_NumericOp(interp, opcode, a, b);
+            } else if (opcode == OP_EQ || opcode == OP_NE) {
+                result = nanbox_from_boolean(Interpreter_Equals(a, b) == (opcode == OP_EQ));
+            } else {
+                // the answer is needed before the next instruction, the
+                // operator method runs in a nested loop
+                result = Interpreter_Send(interp, a, Interpreter_OperatorSelector(opcode), &b, 1);
+                frame = &interp->frames[interp->frames_count - 1];
+            }
+            if (interp->status != INTERPRETER_OK) goto error;
+        store_register:
+            frame->locals[operand] = result;
+            DISPATCH();
+
+        TARGET(OP_SEND_R0)
+        TARGET(OP_SEND_R1)
+        TARGET(OP_SEND_R2)
+            count = opcode - OP_SEND_R0;
+            if (interp->sp + count + 1 > STACK_END(interp)) goto stack_overflow;
+            // the registers of the receiver and the arguments follow
+            // the selector and the cache
+            for (size_t i = 0; i <= count; i++) {
+                operand = frame->ip[4 + i * 2] | (frame->ip[5 + i * 2] << 8);
+                a = REGISTER(operand);
+                PUSH(a);
+            }
+            operand = READ_OPERAND();
+            operand2 = READ_OPERAND();
+            frame->ip += (count + 1) * 2;
+            if (!Interpreter_SendOnStack(interp, NAME(operand), count,
+                                         &frame->code->caches[operand2], false)) goto error;
+            frame = &interp->frames[interp->frames_count - 1];
+            DISPATCH();
+
+        // Superinstructions
+        TARGET(OP_PUSH_NULL_RETURN)
+            CHECK_STACK();
+            PUSH(nanbox_null());
+            DISPATCH_FUSED(OP_RETURN);
+
+        TARGET(OP_PUSH_CONST_ADD)
+            PUSH_CONST();
+            DISPATCH_FUSED(OP_ADD);
+
+        TARGET(OP_PUSH_CONST_SUB)
+            PUSH_CONST();
+            DISPATCH_FUSED(OP_SUB);
+
+        TARGET(OP_PUSH_CONST_LT)
+            PUSH_CONST();
+            DISPATCH_FUSED(OP_LT);
+
+        TARGET(OP_PUSH_THIS_GET_FIELD)
+            PUSH_THIS();
+            DISPATCH_FUSED(OP_GET_FIELD);
+
+        TARGET(OP_LOAD_LOCAL_GET_FIELD)
+            LOAD_LOCAL();
+            DISPATCH_FUSED(OP_GET_FIELD);
+
+        TARGET(OP_LOAD_LOCAL_SEND)
+            LOAD_LOCAL();
+            DISPATCH_FUSED(OP_SEND);
+
+        TARGET(OP_LOAD_LOCAL_GET_FIELD_SEND)
+            LOAD_LOCAL();
+            DISPATCH_FUSED(OP_GET_FIELD_SEND);
+
+        TARGET(OP_GET_FIELD_SEND)
+        FUSED_TARGET(OP_GET_FIELD_SEND)
+            GET_FIELD();
+            DISPATCH_FUSED(OP_SEND);
+
+        TARGET_DEFAULT:
+            Interpreter_RaiseErrorf(interp, "Unknown opcode %d", opcode);
+            goto error;
+    DISPATCH_END();
+
+stack_overflow:
+    Interpreter_RaiseError(interp, "Stack overflow");
+error:
+    if (interp->status == INTERPRETER_RETURNING && interp->return_home >= base_frame) {
+        // the home method of the non-local return runs in this loop
+        while (interp->frames_count > interp->return_home + 1) {
+            Interpreter_PopFrame(interp);
+        }
+        interp->status = INTERPRETER_OK;
+        result = interp->return_value;
+        goto return_result;
+    }
+    while (interp->frames_count > base_frame) {
+        Interpreter_PopFrame(interp);
+    }
+    return nanbox_null();
+    #undef PUSH
+    #undef POP
+    #undef PEEK
+    #undef READ_OPERAND
+    #undef NAME
+    #undef CHECK_STACK
+    #undef TARGET
+    #undef TARGET_DEFAULT
+    #undef DISPATCH
+    #undef DISPATCH_START
+    #undef FETCH
+    #undef ARITH_FAST_PATH
+    #undef COMPARE_FAST_PATH
+    #undef GET_FIELD
+    #undef PUSH_CONST
+    #undef PUSH_THIS
+    #undef LOAD_LOCAL
+    #undef REGISTER
+    #undef REGISTER_OPERANDS
+    #undef REGISTER_ARITH_FAST_PATH
+    #undef REGISTER_COMPARE_FAST_PATH
+    #undef FUSED_TARGET
+    #undef DISPATCH_FUSED
+    #undef DISPATCH_END
+}
+
+/********************** Public API ******************************/
+
+/**
+ * Calls a block
+ * @param[in] interpreter The interpreter
+ * @param     block       The block
+ * @param     this        Value of "this" in the block
+ * @param[in] args        The arguments
+ * @param     argc        Number of arguments
+ * @returns               The value returned by the block,
+ *                        null if an error occured
+ */
+nanbox_t Interpreter_CallBlock(interpreter_t * interpreter, nanbox_t block, nanbox_t this,
+                               nanbox_t * args, size_t argc) {
+    size_t base_frame = interpreter->frames_count;
+    nanbox_t * base = interpreter->sp;
+
+    if (interpreter->status != INTERPRETER_OK) return nanbox_null();
+    if (NativeBlockObject_Check(block)) {
+        nativeblockobject_t * native_ptr = nanbox_to_pointer(block);
+        return native_ptr->func(interpreter, this, args, argc);
+    }
+    if (!BlockObject_Check(block)) {
+        Interpreter_RaiseError(interpreter, "Value is not a block");
+        return nanbox_null();
+    }
+    if (base + argc + 1 > STACK_END(interpreter)) {
+        Interpreter_RaiseError(interpreter, "Stack overflow");
+        return nanbox_null();
+    }
+
+    *interpreter->sp++ = this;
+    for (size_t i = 0; i < argc; i++) {
+        *interpreter->sp++ = args[i];
+    }
+    if (!Interpreter_PushFrame(interpreter, block, base, argc)) {
+        Interpreter_PopValues(interpreter, base);
+        return nanbox_null();
+    }
+    return Interpreter_Execute(interpreter, base_frame);
+}
+
+/**
+ * Calls a block with its own "this" or returns the value itself if it's not a block
+ * @param[in] interpreter The interpreter
+ * @param     value       The block or the value
+ * @returns               The result
+ */
+nanbox_t Interpreter_Value(interpreter_t * interpreter, nanbox_t value) {
+    if (BlockObject_Check(value)) {
+        blockobject_t * block_ptr = nanbox_to_pointer(value);
+        return Interpreter_CallBlock(interpreter, value, block_ptr->this, NULL, 0);
+    }
+    return value;
+}
+
+/**
+ * Sends a message to a value
+ * @param[in] interpreter The interpreter
+ * @param     receiver    The receiver of the message
+ * @param[in] selector    The selector of the message (it will be interned)
+ * @param[in] args        The arguments
+ * @param     argc        Number of arguments
+ * @returns               The answer, null if an error occured
+ */
+nanbox_t Interpreter_Send(interpreter_t * interpreter, nanbox_t receiver, char * selector,
+                          nanbox_t * args, size_t argc) {
+    size_t base_frame = interpreter->frames_count;
+    nanbox_t * base = interpreter->sp;
+
+    if (interpreter->status != INTERPRETER_OK) return nanbox_null();
+    if (base + argc + 1 > STACK_END(interpreter)) {
+        Interpreter_RaiseError(interpreter, "Stack overflow");
+        return nanbox_null();
+    }
+
+    *interpreter->sp++ = receiver;
+    for (size_t i = 0; i < argc; i++) {
+        *interpreter->sp++ = args[i];
+    }
+    if (!Interpreter_SendOnStack(interpreter, Symbol_Intern(selector), argc, NULL, false)) {
+        Interpreter_PopValues(interpreter, base);
+        return nanbox_null();
+    }
+    if (interpreter->frames_count > base_frame) {
+        return Interpreter_Execute(interpreter, base_frame);
+    }
+    return *--interpreter->sp;
+}
+
+/**
+ * Runs a compiled chunk
+ * @param[in] interpreter The interpreter
+ * @param[in] chunk       The chunk (ownership is transfered)
+ * @returns               The value of the chunk,
+ *                        null if an error occured
+ */
+nanbox_t Interpreter_Run(interpreter_t * interpreter, code_t * chunk) {
+    nanbox_t block, result;
+
+    Vec_Append(interpreter->chunks, nanbox_from_pointer(chunk));
+    block = BlockObject_New(chunk, nanbox_null(), nanbox_null());
+    result = Interpreter_CallBlock(interpreter, block, nanbox_null(), NULL, 0);
+    return result;
+}
+
+/**
+ * Parses, compiles and runs code
+ * @param[in] interpreter The interpreter
+ * @param[in] buffer      The code
+ * @param[in] filename    Name of the file that contains the code (or NULL)
+ * @returns               The value of the code,
+ *                        null if an error occured
+ */
+nanbox_t Interpreter_Eval(interpreter_t * interpreter, char * buffer, char * filename) {
+    parser_t * parser;
+    compiler_t * compiler;
+    ast_node_t * ast_root;
+    code_t * chunk = NULL;
+    nanbox_t result = nanbox_null();
+
+    if (interpreter->status != INTERPRETER_OK) return result;
+
+    parser = Parser_New(buffer, strlen(buffer), filename, true);
+    ast_root = Parser_CreateAST(parser, false);
+    if (ast_root) {
+        compiler = Compiler_New();
+#ifdef INTERPRETER_PROFILE_OPCODES
+        // the profile must show the sequences of the base instructions
+        compiler->superinstructions = false;
+#endif
+        chunk = Compiler_Compile(compiler, ast_root);
+        if (!chunk) {
+            interpreter->status = INTERPRETER_ERROR;
+            interpreter->error = Err_New(Compiler_GetError(compiler)->message);
+        }
+        Compiler_Free(compiler);
+        ASTNode_Free(ast_root);
+    } else if (Parser_GetStatus(parser) == PARSER_ERROR) {
+        error_t * error = Parser_GetError(parser);
+        interpreter->status = INTERPRETER_ERROR;
+        interpreter->error = error->with_location
+            ? Err_NewWithLocation(error->message, error->location)
+            : Err_New(error->message);
+    }
+    Parser_Free(parser);
+
+    if (chunk) {
+        result = Interpreter_Run(interpreter, chunk);
+    }
+    return result;
+}
+
+/**
+ * Indicates whether a value is considered true by conditions
+ * @param value The value
+ * @returns     false for False and Null, true otherwise
+ */
+bool Interpreter_IsTruthy(nanbox_t value) {
+    return !nanbox_is_false(value) && !nanbox_is_null(value);
+}
+
+static string * Interpreter_ValueToStringDepth(nanbox_t value, size_t depth) {
+    #define APPEND_FREE(str1, str2) Str_Append(str1, str2);Str_Free(str2)
+    string * str, * str2;
+    char buf[64];
+
+    if (nanbox_is_int(value)) {
+        snprintf(buf, 64, "%d", nanbox_to_int(value));
+        str = Str_New(buf);
+    } else if (nanbox_is_double(value)) {
+        snprintf(buf, 64, "%.15g", nanbox_to_double(value));
+        str = Str_New(buf);
+    } else if (nanbox_is_true(value)) {
+        str = Str_New("True");
+    } else if (nanbox_is_false(value)) {
+        str = Str_New("False");
+    } else if (!nanbox_is_pointer(value)) {
+        str = Str_New("Null");
+    } else if (StringObject_Check(value)) {
+        // strings are quoted when they are part of another value
+        str = Str_New(depth ? "\"" : "");
+        str2 = Str_New(StringObject_GetValue(value));
+        APPEND_FREE(str, str2);
+        if (depth) {
+            str2 = Str_New("\"");
+            APPEND_FREE(str, str2);
+        }
+    } else if (BlockObject_Check(value)) {
+        str = Str_New("<block>");
+    } else if (NativeBlockObject_Check(value)) {
+        str = Str_New("<native block>");
+    } else if (depth >= MAX_PRINT_DEPTH) {
+        str = Str_New(ArrayObject_Check(value) ? "[...]" : "{...}");
+    } else if (ArrayObject_Check(value)) {
+        str = Str_New("[");
+        for (size_t i = 0; i < ArrayObject_GetLength(value); i++) {
+            if (i > 0) {
+                str2 = Str_New(", ");
+                APPEND_FREE(str, str2);
+            }
+            str2 = Interpreter_ValueToStringDepth(ArrayObject_GetAt(value, i), depth + 1);
+            APPEND_FREE(str, str2);
+        }
+        str2 = Str_New("]");
+        APPEND_FREE(str, str2);
+    } else {
+        object_t * object_ptr = nanbox_to_pointer(value);
+        vector_t * keys = Shape_GetNames(object_ptr->shape);
+
+        str = Str_New("{");
+        for (size_t i = 0; i < Vec_GetLength(keys); i++) {
+            str2 = Str_New(i > 0 ? ", " : "");
+            APPEND_FREE(str, str2);
+            str2 = Str_New(nanbox_to_pointer(Vec_GetAt(keys, i)));
+            APPEND_FREE(str, str2);
+            str2 = Str_New(": ");
+            APPEND_FREE(str, str2);
+            str2 = Interpreter_ValueToStringDepth(object_ptr->slots[i], depth + 1);
+            APPEND_FREE(str, str2);
+        }
+        str2 = Str_New("}");
+        APPEND_FREE(str, str2);
+        Vec_Free(keys);
+    }
+    #undef APPEND_FREE
+
+    return str;
+}
+
+/**
+ * Builds a printable representation of a value
+ * @param value The value
+ * @returns     The representation
+ */
+string * Interpreter_ValueToString(nanbox_t value) {
+    return Interpreter_ValueToStringDepth(value, 0);
+}
+
+/**
+ * Marks the constants of a code unit and of its inner code units
+ */
+static void Interpreter_TraceCode(code_t * code) {
+    GC_MarkAll(code->constants->buffer, Vec_GetLength(code->constants));
+    for (size_t i = 0; i < Vec_GetLength(code->codes); i++) {
+        Interpreter_TraceCode(nanbox_to_pointer(Vec_GetAt(code->codes, i)));
+    }
+}
+
+/**
+ * Marks the values an interpreter keeps alive: its globals, its prototypes,
+ * its compiled code, the stack and the active frames
+ * @param[in] data The interpreter
+ */
+static void Interpreter_TraceRoots(void * data) {
+    interpreter_t * interp = (interpreter_t *)data;
+
+    for (size_t i = 0; i < interp->globals->entries_count; i++) {
+        for (hashmap_entry_t * entry = interp->globals->entries[i]; entry; entry = entry->next) {
+            GC_Mark(&entry->value);
+        }
+    }
+    GC_Mark(&interp->object_proto);
+    GC_Mark(&interp->number_proto);
+    GC_Mark(&interp->boolean_proto);
+    GC_Mark(&interp->string_proto);
+    GC_Mark(&interp->array_proto);
+    GC_Mark(&interp->block_proto);
+    GC_Mark(&interp->return_value);
+    for (size_t i = 0; i < Vec_GetLength(interp->chunks); i++) {
+        Interpreter_TraceCode(nanbox_to_pointer(Vec_GetAt(interp->chunks, i)));
+    }
+    GC_MarkAll(interp->finalizers->buffer, Vec_GetLength(interp->finalizers));
+    GC_MarkAll(interp->stack, interp->sp - interp->stack);
+    for (size_t i = 0; i < interp->frames_count; i++) {
+        frame_t * frame = &interp->frames[i];
+
+        GC_Mark(&frame->block);
+        GC_Mark(&frame->this);
+        // the running code writes its locals and its blocks without write barrier
+        if (nanbox_is_pointer(frame->context)) {
+            GC_MarkRoot(&frame->context);
+            frame->locals = ((contextobject_t *)nanbox_to_pointer(frame->context))->values;
+        }
+        for (size_t j = 0; frame->blocks && j < frame->code->frame_blocks_count; j++) {
+            nanbox_t block = nanbox_from_pointer(&frame->blocks[j]);
+
+            if (frame->blocks[j].code) GC_MarkRoot(&block);
+        }
+    }
+}
+
+/**
+ * Allocates a new interpreter with its builtin objects
+ * @returns The newly allocated interpreter
+ */
+interpreter_t * Interpreter_New(void) {
+    interpreter_t * interpreter = (interpreter_t *)malloc(sizeof(interpreter_t));
+
+    if (interpreter) {
+        interpreter->chunks = Vec_New();
+        interpreter->globals = HashMap_New();
+        interpreter->frames_count = 0;
+        interpreter->activations = 0;
+        interpreter->frame_blocks_count = 0;
+        interpreter->return_home = 0;
+        interpreter->return_value = nanbox_null();
+        interpreter->sp = interpreter->stack;
+        interpreter->status = INTERPRETER_OK;
+        interpreter->error = NULL;
+        interpreter->heap_limit = 0;
+        interpreter->heap_limit_skip = false;
+        interpreter->heap_account = GC_NewAccount();
+        GC_SetAccount(interpreter->heap_account);
+        interpreter->finalizers = Vec_New();
+        interpreter->finalizing = false;
+        memset(interpreter->megamorphic_cache, 0, sizeof(interpreter->megamorphic_cache));
+        memset(&interpreter->cache_stats, 0, sizeof(interpreter->cache_stats));
+#ifdef INTERPRETER_PROFILE_OPCODES
+        interpreter->opcode_profile = calloc(1, sizeof(interpreter_opcode_profile_t));
+        if (!interpreter->opcode_profile) Err_Throw(Err_New("Cannot allocate opcode profile"));
+#else
+        interpreter->opcode_profile = NULL;
+#endif
+#ifdef INTERPRETER_PROFILE_ALLOCATIONS
+        interpreter->allocation_profile = calloc(1, sizeof(interpreter_allocation_profile_t));
+        if (!interpreter->allocation_profile) Err_Throw(Err_New("Cannot allocate allocation profile"));
+        GC_SetAllocationHook(Interpreter_ProfileAllocation, interpreter);
+#else
+        interpreter->allocation_profile = NULL;
+#endif
+        Builtins_Install(interpreter);
+        GC_AddRoots(Interpreter_TraceRoots, interpreter);
+    } else {
+        Err_Throw(Err_New("Cannot allocate interpreter"));
+    }
+    return interpreter;
+}
+
+/**
+ * Frees an interpreter, its globals and its compiled code
+ * @param[in] interpreter The interpreter to free
+ */
+void Interpreter_Free(interpreter_t * interpreter) {
+    if (interpreter) {
+        GC_RemoveRoots(Interpreter_TraceRoots, interpreter);
+        // the finalizers of the objects the interpreter kept alive are not called
+        GC_RemoveFinalizers(interpreter);
+        HashMap_Free(interpreter->globals);
+        // the objects that only the interpreter kept alive are freed
+        GC_Collect();
+        GC_FreeAccount(interpreter->heap_account);
+
+        // code must outlive the blocks that reference it
+        for (size_t i = 0; i < Vec_GetLength(interpreter->chunks); i++) {
+            Code_Free(nanbox_to_pointer(Vec_GetAt(interpreter->chunks, i)));
+        }
+        Vec_Free(interpreter->chunks);
+        Vec_Free(interpreter->finalizers);
+
+        if (interpreter->error) Err_Free(interpreter->error);
+        free(interpreter->opcode_profile);
+        if (interpreter->allocation_profile) {
+            GC_SetAllocationHook(NULL, NULL);
+            free(interpreter->allocation_profile);
+        }
+        free(interpreter);
+    } else {
+        Err_Throw(Err_New("NULL pointer to interpreter"));
+    }
+}
+
+/**
+ * Returns the status of the interpreter
+ * @returns the status of the interpreter
+ */
+interpreter_status_t Interpreter_GetStatus(interpreter_t * interpreter) {
+    interpreter_status_t status = INTERPRETER_OK;
+    if (interpreter) status = interpreter->status;
+    else Err_Throw(Err_New("NULL pointer to interpreter"));
+    return status;
+}
+
+/**
+ * Returns the error that the interpreter encountered if any
+ * @retval NULL if no error
+ * @retval A pointer to an error if any
+ */
+error_t * Interpreter_GetError(interpreter_t * interpreter) {
+    error_t * error = NULL;
+    if (interpreter) error = interpreter->error;
+    else Err_Throw(Err_New("NULL pointer to interpreter"));
+    return error;
+}
+
+/**
+ * Returns the counters of the message lookup caches
+ * @param[in] interpreter The interpreter
+ * @returns               The counters
+ */
+interpreter_cache_stats_t Interpreter_GetCacheStats(interpreter_t * interpreter) {
+    if (!interpreter) Err_Throw(Err_New("NULL pointer to interpreter"));
+    return interpreter->cache_stats;
+}
+
+/**
+ * Writes the opcode sequences counts, one sequence per line: its count
+ * followed by the names of its opcodes. Nothing is written when the
+ * build doesn't profile them
+ * @param[in] interpreter The interpreter
+ * @param[in] file        The file to write to
+ */
+void Interpreter_WriteOpcodeProfile(interpreter_t * interpreter, FILE * file) {
+    interpreter_opcode_profile_t * profile = interpreter->opcode_profile;
+
+    if (!profile) return;
+    for (size_t i = 0; i < OPCODES_NUMBER; i++) {
+        if (profile->singles[i]) {
+            fprintf(file, "%lu %s\n", (unsigned long)profile->singles[i], opcode_names[i]);
+        }
+        for (size_t j = 0; j < OPCODES_NUMBER; j++) {
+            if (profile->pairs[i][j]) {
+                fprintf(file, "%lu %s %s\n", (unsigned long)profile->pairs[i][j],
+                        opcode_names[i], opcode_names[j]);
+            }
+            for (size_t k = 0; k < OPCODES_NUMBER; k++) {
+                if (profile->triples[i][j][k]) {
+                    fprintf(file, "%lu %s %s %s\n", (unsigned long)profile->triples[i][j][k],
+                            opcode_names[i], opcode_names[j], opcode_names[k]);
+                }
+            }
+        }
+    }
+}
+
+static int Interpreter_CompareSitesCount(const void * a, const void * b) {
+    size_t count_a = ((interpreter_allocation_site_t *)a)->count;
+    size_t count_b = ((interpreter_allocation_site_t *)b)->count;
+    return (count_a < count_b) - (count_a > count_b);
+}
+
+static int Interpreter_CompareSitesBytes(const void * a, const void * b) {
+    size_t bytes_a = ((interpreter_allocation_site_t *)a)->bytes;
+    size_t bytes_b = ((interpreter_allocation_site_t *)b)->bytes;
+    return (bytes_a < bytes_b) - (bytes_a > bytes_b);
+}
+
+/**
+ * Writes the first sites of a ranking
+ */
+static void Interpreter_WriteSites(FILE * file, interpreter_allocation_site_t * sites, size_t count,
+                                   size_t top) {
+    fprintf(file, "%10s %12s  %s\n", "objects", "bytes", "site");
+    for (size_t i = 0; i < count && i < top; i++) {
+        if (sites[i].code) {
+            fprintf(file, "%10lu %12lu  %s:%lu (%s)\n", (unsigned long)sites[i].count,
+                    (unsigned long)sites[i].bytes,
+                    sites[i].code->filename ? sites[i].code->filename : "<input>",
+                    (unsigned long)sites[i].line, sites[i].code->name);
+        } else {
+            fprintf(file, "%10lu %12lu  <runtime>\n", (unsigned long)sites[i].count,
+                    (unsigned long)sites[i].bytes);
+        }
+    }
+}
+
+/**
+ * Writes the source lines that allocated the most objects, then those
+ * that allocated the most bytes. Nothing is written when the build
+ * doesn't profile them
+ * @param[in] interpreter The interpreter
+ * @param[in] file        The file to write to
+ * @param     top         Number of lines of each ranking
+ */
+void Interpreter_WriteAllocationProfile(interpreter_t * interpreter, FILE * file, size_t top) {
+    interpreter_allocation_profile_t * profile = interpreter->allocation_profile;
+    interpreter_allocation_site_t * sites;
+    size_t count = 0;
+
+    if (!profile) return;
+    sites = (interpreter_allocation_site_t *)malloc((profile->sites_count + 1) * sizeof(*sites));
+    if (!sites) Err_Throw(Err_New("Cannot allocate allocation sites"));
+    for (size_t i = 0; i < INTERPRETER_ALLOCATION_SITES; i++) {
+        if (profile->sites[i].code) sites[count++] = profile->sites[i];
+    }
+    if (profile->others.count) sites[count++] = profile->others;
+
+    fprintf(file, "Allocation sites by objects:\n");
+    qsort(sites, count, sizeof(*sites), Interpreter_CompareSitesCount);
+    Interpreter_WriteSites(file, sites, count, top);
+    fprintf(file, "Allocation sites by bytes:\n");
+    qsort(sites, count, sizeof(*sites), Interpreter_CompareSitesBytes);
+    Interpreter_WriteSites(file, sites, count, top);
+    free(sites);
+}
+
+/**
+ * Queues a finalizer whose object was collected (see gc_finalizer_func_t)
+ */
+static void Interpreter_QueueFinalizer(nanbox_t finalizer, void * data) {
+    interpreter_t * interpreter = (interpreter_t *)data;
+    Vec_Append(interpreter->finalizers, finalizer);
+}
+
+/**
+ * Calls a block once an object is collected, at the first call that
+ * follows, the errors it raises are ignored. The block must not reference
+ * the object, else the object is never collected
+ * @param[in] interpreter The interpreter
+ * @param     object      The object
+ * @param     finalizer   The block
+ */
+void Interpreter_AddFinalizer(interpreter_t * interpreter, nanbox_t object, nanbox_t finalizer) {
+    GC_AddFinalizer(object, finalizer, Interpreter_QueueFinalizer, interpreter);
+}
+
+/**
+ * Limits the memory of an interpreter: when a call finds that the memory
+ * charged to the interpreter exceeds the limit, the heap is collected and
+ * the call raises an "Out of memory" error if it still does. The memory
+ * is charged to the interpreter that allocates it, the other interpreters
+ * sharing the heap have their own limits. The handlers of onError: are
+ * called even above the limit
+ * @param[in] interpreter The interpreter
+ * @param     limit       The size, in bytes (0 for no limit)
+ */
+void Interpreter_SetHeapLimit(interpreter_t * interpreter, size_t limit) {
+    interpreter->heap_limit = limit;
+}
+
+/**
+ * Forgets the last error so the interpreter can run code again
+ * @param[in] interpreter The interpreter
+ */
+void Interpreter_ClearError(interpreter_t * interpreter) {
+    if (interpreter->error) {
+        Err_Free(interpreter->error);
+        interpreter->error = NULL;
+    }
+    interpreter->status = INTERPRETER_OK;
+}
+
+/**
+ * Raises a runtime error, the running code is unwound
+ * @param[in] interpreter The interpreter
+ * @param[in] message     The error message (a copy will be performed)
+ */
+void Interpreter_RaiseError(interpreter_t * interpreter, char * message) {
+    // the first error is the most relevant one
+    if (interpreter->status == INTERPRETER_OK) {
+        interpreter->status = INTERPRETER_ERROR;
+        interpreter->error = Err_New(message);
+    }
+}
@@ -2,15 +2,12 @@
  * @file main.c
  * Interpreter entrypoint
  */
-#include "misc.h"
 #include "eval.h"
 
 /**
  * Interpreter entrypoint
  */
 int main(int argc, char ** argv) {
-    UNUSED(argc);
-    UNUSED(argv);
-    
+    if (argc > 1) return Eval_File(argv[1]);
     return Eval_REPL();
 }
@@ -15,6 +15,10 @@
 repl_cmd_type_t REPL_IsCommand(char * line) {
     /// @todo Allow whitespaces before and after commands
     if (strcmp(line, ":ml\n") == 0) return REPL_CMD_MULTILINE;
+    if (strcmp(line, ":debug\n") == 0) return REPL_CMD_DEBUG;
+    if (strcmp(line, ":cache\n") == 0) return REPL_CMD_CACHE;
+    if (strcmp(line, ":heap\n") == 0) return REPL_CMD_HEAP;
+    if (strcmp(line, ":allocations\n") == 0) return REPL_CMD_ALLOCATIONS;
     return REPL_CMD_NONE;
 }
 
@@ -4,7 +4,7 @@
 
 TARGET   := pipou-tests
 VERSION  := 1.0.0
-DIRS     := PipouScript Parser Common Objects Tests
+DIRS     := PipouScript Parser Compiler Common Objects Tests
 BUILD    := $(CURDIR)/Build
 MAIN     := $(CURDIR)/PipouScript/main.c
 
@@ -27,6 +27,26 @@ CC       := gcc
 CFLAGS   := -g -Wall -Wextra -DBUILD_VERSION=\"$(VERSION)\"
 LDFLAGS  :=
 
+# Interpreter loop dispatch: "goto" (computed goto) or "switch" (portable)
+DISPATCH := goto
+ifeq ($(DISPATCH),switch)
+DEFINES  += -DINTERPRETER_SWITCH_DISPATCH
+endif
+
+# Bytecode the compiler emits by default: "stack" or "register" (the
+# expressions over local variables address their operands directly)
+VM       := stack
+ifeq ($(VM),register)
+DEFINES  += -DCOMPILER_REGISTER_VM
+endif
+
+# "malloc" allocates the blocks of the pools with malloc, so that the
+# memory checkers see each one of them
+POOL     := slabs
+ifeq ($(POOL),malloc)
+DEFINES  += -DPOOL_MALLOC
+endif
+
 ###############################################################################
 
 .PHONY: all clean paths $(TARGET)
@@ -53,5 +73,5 @@ $(BUILD)/$(TARGET): $(OBJS)
 $(OBJS): $(SOURCES)
 	@echo "\nBuilding test... $@"
 	@mkdir -p $(dir $@)
-	$(CC) $(CFLAGS) $(INCLUDES) -c $(call obj2src,$@) -o $@
+	$(CC) $(CFLAGS) $(DEFINES) $(INCLUDES) -c $(call obj2src,$@) -o $@
 	@echo "Done."
@@ -5,8 +5,10 @@
 #include <stdio.h>
 #include "seatest.h"
 #include "nanbox.h"
+#include "symbol.h"
 #include "arrayobject.h"
 #include "objects_types.h"
+#include "gc.h"
 
 void Test_ArrayObjectCreation(void) {
     nanbox_t arrayobject;
@@ -17,10 +19,12 @@ void Test_ArrayObjectCreation(void) {
     arrayobject_ptr = nanbox_to_pointer(arrayobject);
     assert_int_equal(ARRAY_OBJECT, arrayobject_ptr->type);
 
-    length = nanbox_to_int(Object_GetField(arrayobject, "length"));
+    length = nanbox_to_int(Object_GetField(arrayobject, Symbol_Intern("length")));
     assert_int_equal(0, length);
+    // the length is computed, the array has no field
+    assert_int_equal(0, arrayobject_ptr->shape->fields_count);
 
-    Object_DecRef(&arrayobject);
+    GC_Collect();
 }
 
 void Test_ArrayObjectAppendingPopping(void) {
@@ -30,17 +34,17 @@ void Test_ArrayObjectAppendingPopping(void) {
     arrayobject = ArrayObject_New();
     ArrayObject_Append(arrayobject, nanbox_from_int(1337));
     ArrayObject_Append(arrayobject, nanbox_from_double(13.37));
-    length = nanbox_to_int(Object_GetField(arrayobject, "length"));
+    length = nanbox_to_int(Object_GetField(arrayobject, Symbol_Intern("length")));
     assert_int_equal(2, length);
     assert_int_equal(1337, nanbox_to_int(ArrayObject_GetAt(arrayobject, 0)));
     assert_double_equal(13.37, nanbox_to_double(ArrayObject_GetAt(arrayobject, 1)), 0.0);
 
     ArrayObject_Pop(arrayobject);
-    length = nanbox_to_int(Object_GetField(arrayobject, "length"));
+    length = nanbox_to_int(Object_GetField(arrayobject, Symbol_Intern("length")));
     assert_int_equal(1, length);
     assert_int_equal(1, ArrayObject_GetLength(arrayobject));
 
-    Object_DecRef(&arrayobject);
+    GC_Collect();
 }
 
 void Test_ArrayObjectSettingGetting(void) {
@@ -54,7 +58,172 @@ void Test_ArrayObjectSettingGetting(void) {
     assert_int_equal(1337, nanbox_to_int(ArrayObject_GetAt(arrayobject, 1)));
     assert_int_equal(2, ArrayObject_GetLength(arrayobject));
 
-    Object_DecRef(&arrayobject);
+    GC_Collect();
+}
+
+void Test_ArrayObjectKinds(void) {
+    nanbox_t arrayobject = ArrayObject_New();
+    nanbox_t object = Object_New(sizeof(object_t), NULL, NULL);
+
+    // the integers are packed in half the size of the values
+    for (int i = 0; i < 100; i++) {
+        ArrayObject_Append(arrayobject, nanbox_from_int(i));
+    }
+    assert_int_equal(ARRAY_KIND_INT, ArrayObject_GetKind(arrayobject));
+    assert_int_equal(128 * sizeof(int32_t), ArrayObject_GetItemsSize(arrayobject));
+    assert_int_equal(4950, nanbox_to_int(ArrayObject_Sum(arrayobject)));
+
+    // a double makes it a double array whose integers are still read as integers
+    ArrayObject_SetAt(arrayobject, 1, nanbox_from_double(0.5));
+    assert_int_equal(ARRAY_KIND_DOUBLE, ArrayObject_GetKind(arrayobject));
+    assert_double_equal(0.5, nanbox_to_double(ArrayObject_GetAt(arrayobject, 1)), 0.0);
+    assert_true(nanbox_is_int(ArrayObject_GetAt(arrayobject, 2)));
+    assert_int_equal(2, nanbox_to_int(ArrayObject_GetAt(arrayobject, 2)));
+    ArrayObject_Append(arrayobject, nanbox_from_int(-1));
+    assert_int_equal(ARRAY_KIND_DOUBLE, ArrayObject_GetKind(arrayobject));
+    assert_double_equal(4948.5, nanbox_to_double(ArrayObject_Sum(arrayobject)), 0.0);
+
+    // any other value makes it a generic array
+    ArrayObject_Append(arrayobject, object);
+    assert_int_equal(ARRAY_KIND_GENERIC, ArrayObject_GetKind(arrayobject));
+    assert_true(nanbox_to_pointer(ArrayObject_Pop(arrayobject)) == nanbox_to_pointer(object));
+    assert_int_equal(-1, nanbox_to_int(ArrayObject_Pop(arrayobject)));
+    assert_int_equal(99, nanbox_to_int(ArrayObject_GetAt(arrayobject, 99)));
+    assert_double_equal(4949.5, nanbox_to_double(ArrayObject_Sum(arrayobject)), 0.0);
+    ArrayObject_Append(arrayobject, object);
+    assert_true(nanbox_is_null(ArrayObject_Sum(arrayobject)));
+
+    GC_Collect();
+}
+
+void Test_ArrayObjectHoles(void) {
+    nanbox_t arrayobject = ArrayObject_New();
+
+    GC_AddHandle(&arrayobject);
+
+    // a small hole is stored as null items
+    ArrayObject_SetAt(arrayobject, 10, nanbox_true());
+    assert_int_equal(11, ArrayObject_GetLength(arrayobject));
+    assert_int_equal(ARRAY_KIND_GENERIC, ArrayObject_GetKind(arrayobject));
+    assert_true(nanbox_is_null(ArrayObject_GetAt(arrayobject, 5)));
+    assert_true(nanbox_is_true(ArrayObject_GetAt(arrayobject, 10)));
+
+    // a large one makes the array sparse
+    for (int i = 1; i <= 100; i++) {
+        nanbox_t object = Object_New(sizeof(object_t), NULL, NULL);
+
+        Object_SetField(object, Symbol_Intern("i"), nanbox_from_int(i));
+        ArrayObject_SetAt(arrayobject, i * 1000000, object);
+    }
+    assert_int_equal(ARRAY_KIND_SPARSE, ArrayObject_GetKind(arrayobject));
+    assert_int_equal(100000001, ArrayObject_GetLength(arrayobject));
+    assert_int_equal(256 * sizeof(array_entry_t), ArrayObject_GetItemsSize(arrayobject));
+    assert_true(nanbox_is_null(ArrayObject_GetAt(arrayobject, 999999)));
+    assert_true(nanbox_is_true(ArrayObject_GetAt(arrayobject, 10)));
+    assert_true(nanbox_is_null(ArrayObject_Sum(arrayobject)));
+
+    // the items are traced
+    GC_Collect();
+    for (int i = 1; i <= 100; i++) {
+        nanbox_t object = ArrayObject_GetAt(arrayobject, i * 1000000);
+        assert_int_equal(i, nanbox_to_int(Object_GetField(object, Symbol_Intern("i"))));
+    }
+    ArrayObject_Pop(arrayobject);
+    assert_int_equal(100000000, ArrayObject_GetLength(arrayobject));
+    assert_true(nanbox_is_null(ArrayObject_Pop(arrayobject)));
+    assert_int_equal(99999999, ArrayObject_GetLength(arrayobject));
+
+    // it is dense again once half full
+    arrayobject = ArrayObject_New();
+    ArrayObject_SetAt(arrayobject, 200, nanbox_from_int(200));
+    assert_int_equal(ARRAY_KIND_SPARSE, ArrayObject_GetKind(arrayobject));
+    for (int i = 0; i < 99; i++) {
+        ArrayObject_SetAt(arrayobject, i, nanbox_from_int(i));
+    }
+    assert_int_equal(ARRAY_KIND_SPARSE, ArrayObject_GetKind(arrayobject));
+    ArrayObject_SetAt(arrayobject, 99, nanbox_from_int(99));
+    assert_int_equal(ARRAY_KIND_GENERIC, ArrayObject_GetKind(arrayobject));
+    assert_int_equal(201, ArrayObject_GetLength(arrayobject));
+    assert_int_equal(99, nanbox_to_int(ArrayObject_GetAt(arrayobject, 99)));
+    assert_true(nanbox_is_null(ArrayObject_GetAt(arrayobject, 150)));
+    assert_int_equal(200, nanbox_to_int(ArrayObject_GetAt(arrayobject, 200)));
+    ArrayObject_Append(arrayobject, nanbox_from_int(201));
+    assert_int_equal(202, ArrayObject_GetLength(arrayobject));
+
+    GC_RemoveHandle(&arrayobject);
+    GC_Collect();
+}
+
+void Test_ArrayObjectSlices(void) {
+    nanbox_t arrayobject = ArrayObject_New();
+    nanbox_t slice, other;
+    arrayobject_t * arrayobject_ptr = nanbox_to_pointer(arrayobject);
+    int32_t * items;
+
+    for (int i = 0; i < 100; i++) {
+        ArrayObject_Append(arrayobject, nanbox_from_int(i));
+    }
+    // the slice uses the items of the array
+    slice = ArrayObject_Slice(arrayobject, 10, 20);
+    assert_int_equal(20, ArrayObject_GetLength(slice));
+    assert_true(((arrayobject_t *)nanbox_to_pointer(slice))->items.ints == arrayobject_ptr->items.ints + 10);
+    assert_int_equal(64 * sizeof(int32_t), ArrayObject_GetItemsSize(slice));
+    assert_int_equal(29, nanbox_to_int(ArrayObject_GetAt(slice, 19)));
+    // the empty slices may start at the end of the array
+    assert_int_equal(0, ArrayObject_GetLength(ArrayObject_Slice(arrayobject, 100, 0)));
+    assert_int_equal(0, ArrayObject_GetLength(ArrayObject_Slice(ArrayObject_New(), 0, 0)));
+
+    // they are copied when one of them is modified
+    ArrayObject_SetAt(slice, 0, nanbox_from_double(0.5));
+    assert_int_equal(ARRAY_KIND_DOUBLE, ArrayObject_GetKind(slice));
+    assert_int_equal(10, nanbox_to_int(ArrayObject_GetAt(arrayobject, 10)));
+    assert_int_equal(11, nanbox_to_int(ArrayObject_GetAt(slice, 1)));
+    other = ArrayObject_Slice(arrayobject, 50, 50);
+    ArrayObject_SetAt(arrayobject, 50, nanbox_from_int(-1));
+    assert_int_equal(-1, nanbox_to_int(ArrayObject_GetAt(arrayobject, 50)));
+    assert_int_equal(3725, nanbox_to_int(ArrayObject_Sum(other)));
+    ArrayObject_Append(other, nanbox_from_int(100));
+    assert_int_equal(51, ArrayObject_GetLength(other));
+    assert_int_equal(100, ArrayObject_GetLength(arrayobject));
+
+    // the last array using the items owns them again
+    GC_AddHandle(&arrayobject);
+    ArrayObject_Slice(arrayobject, 0, 10);
+    GC_Collect();
+    arrayobject_ptr = nanbox_to_pointer(arrayobject);
+    items = arrayobject_ptr->items.ints;
+    ArrayObject_Append(arrayobject, nanbox_from_int(100));
+    assert_true(arrayobject_ptr->shared == NULL);
+    assert_true(arrayobject_ptr->items.ints == items);
+    GC_RemoveHandle(&arrayobject);
+
+    // the slices keep the items alive
+    arrayobject = ArrayObject_New();
+    for (int i = 0; i < 10; i++) {
+        nanbox_t object = Object_New(sizeof(object_t), NULL, NULL);
+
+        Object_SetField(object, Symbol_Intern("i"), nanbox_from_int(i));
+        ArrayObject_Append(arrayobject, object);
+    }
+    slice = ArrayObject_Slice(arrayobject, 5, 5);
+    GC_AddHandle(&slice);
+    GC_Collect();
+    for (int i = 0; i < 5; i++) {
+        nanbox_t object = ArrayObject_GetAt(slice, i);
+        assert_int_equal(i + 5, nanbox_to_int(Object_GetField(object, Symbol_Intern("i"))));
+    }
+    GC_RemoveHandle(&slice);
+
+    // the items of a sparse array are copied
+    arrayobject = ArrayObject_New();
+    ArrayObject_SetAt(arrayobject, 1000000, nanbox_from_int(1));
+    slice = ArrayObject_Slice(arrayobject, 999000, 1001);
+    assert_int_equal(ARRAY_KIND_SPARSE, ArrayObject_GetKind(slice));
+    assert_int_equal(1001, ArrayObject_GetLength(slice));
+    assert_int_equal(1, nanbox_to_int(ArrayObject_GetAt(slice, 1000)));
+    assert_true(nanbox_is_null(ArrayObject_GetAt(slice, 999)));
+
+    GC_Collect();
 }
 
 void Test_ArrayObjectTests(void) {
@@ -62,5 +231,8 @@ void Test_ArrayObjectTests(void) {
     run_test(Test_ArrayObjectCreation);
     run_test(Test_ArrayObjectAppendingPopping);
     run_test(Test_ArrayObjectSettingGetting);
+    run_test(Test_ArrayObjectKinds);
+    run_test(Test_ArrayObjectHoles);
+    run_test(Test_ArrayObjectSlices);
     test_fixture_end();
 }
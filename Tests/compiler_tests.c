@@ -0,0 +1,293 @@
+/**
+ * @file compiler_tests.c
+ * Bytecode compiler tests
+ */
+#include <string.h>
+#include "Parser/include/parser.h"
+#include "ast.h"
+#include "compiler.h"
+#include "code.h"
+#include "opcodes.h"
+#include "nanbox.h"
+#include "seatest.h"
+
+/**
+ * Compiles a buffer, with or without superinstructions and register instructions
+ * @returns The compiled chunk or NULL
+ */
+static code_t * Test_CompileWith(char * buffer, bool superinstructions, bool registers,
+                                 compiler_status_t * status) {
+    parser_t * parser = Parser_New(buffer, strlen(buffer), NULL, true);
+    ast_node_t * ast_root = Parser_CreateAST(parser, false);
+    compiler_t * compiler;
+    code_t * code;
+
+    assert_true(ast_root != NULL);
+    compiler = Compiler_New();
+    compiler->superinstructions = superinstructions;
+    compiler->registers = registers;
+    code = Compiler_Compile(compiler, ast_root);
+    *status = Compiler_GetStatus(compiler);
+    Compiler_Free(compiler);
+    ASTNode_Free(ast_root);
+    Parser_Free(parser);
+    return code;
+}
+
+/**
+ * Compiles a buffer
+ * @returns The compiled chunk or NULL
+ */
+static code_t * Test_Compile(char * buffer, compiler_status_t * status) {
+    return Test_CompileWith(buffer, true, false, status);
+}
+
+void Test_CompileArith(void) {
+    compiler_status_t status;
+    code_t * code = Test_Compile("1 + 2 * 3", &status);
+    opcode_t expected[] = {
+        OP_PUSH_CONST, OP_PUSH_CONST, OP_PUSH_CONST, OP_MUL, OP_ADD, OP_RETURN
+    };
+    size_t offset = 0;
+
+    assert_int_equal(COMPILER_OK, status);
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        assert_int_equal(expected[i], code->bytecode[offset]);
+        offset += Code_InstructionSize(code->bytecode[offset]);
+    }
+    // identical numbers share their constant
+    Code_Free(code);
+    code = Test_Compile("1 + 1", &status);
+    assert_int_equal(1, Vec_GetLength(code->constants));
+    assert_int_equal(1, nanbox_to_int(Vec_GetAt(code->constants, 0)));
+    Code_Free(code);
+}
+
+void Test_CompileGlobalsAndLocals(void) {
+    compiler_status_t status;
+    code_t * code = Test_Compile("a := 1; b := { |x| y := x; y };", &status);
+    code_t * block;
+
+    assert_int_equal(COMPILER_OK, status);
+    assert_int_equal(OP_DECL_GLOBAL, code->bytecode[3]);
+    assert_string_equal("a", Code_GetName(code, Code_GetOperand(code, 3, 0)));
+    assert_int_equal(1, Vec_GetLength(code->codes));
+
+    block = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    assert_int_equal(CODE_BLOCK, block->kind);
+    assert_int_equal(1, block->params_count);
+    assert_int_equal(2, block->locals_count);
+    assert_false(block->needs_context);
+    assert_int_equal(OP_LOAD_LOCAL, block->bytecode[0]);
+    assert_int_equal(OP_STORE_LOCAL, block->bytecode[3]);
+    assert_int_equal(1, Code_GetOperand(block, 3, 0));
+    Code_Free(code);
+}
+
+void Test_CompileCapturedVariables(void) {
+    compiler_status_t status;
+    code_t * code = Test_Compile("f := { |n| { |k| n + k } };", &status);
+    code_t * outer, * inner;
+
+    assert_int_equal(COMPILER_OK, status);
+    outer = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    inner = nanbox_to_pointer(Vec_GetAt(outer->codes, 0));
+    assert_true(outer->needs_context);
+    assert_false(inner->needs_context);
+    assert_int_equal(OP_LOAD_CAPTURED, inner->bytecode[0]);
+    assert_int_equal(1, Code_GetOperand(inner, 0, 0));
+    assert_int_equal(0, Code_GetOperand(inner, 0, 1));
+    Code_Free(code);
+}
+
+void Test_CompileMessages(void) {
+    compiler_status_t status;
+    code_t * code = Test_Compile("o := { add: a to: b { ^ a + b } }; o add: 1 to: 2", &status);
+    code_t * method, * block;
+    size_t offset = 0;
+
+    assert_int_equal(COMPILER_OK, status);
+    method = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    assert_int_equal(CODE_METHOD, method->kind);
+    assert_string_equal("add:to", method->name);
+    assert_int_equal(2, method->params_count);
+
+    while (code->bytecode[offset] != OP_SEND) {
+        offset += Code_InstructionSize(code->bytecode[offset]);
+    }
+    assert_string_equal("add:to", Code_GetName(code, Code_GetOperand(code, offset, 0)));
+    assert_int_equal(2, Code_GetOperand(code, offset, 1));
+    assert_int_equal(0, Code_GetOperand(code, offset, 2));
+    assert_int_equal(1, code->caches_count);
+    Code_Free(code);
+
+    // "^" in a block nested in a message returns from the message
+    code = Test_Compile("o := { m { { ^ 1 } } }; f := { ^ 2 };", &status);
+    assert_int_equal(COMPILER_OK, status);
+    method = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    block = nanbox_to_pointer(Vec_GetAt(method->codes, 0));
+    assert_int_equal(OP_NON_LOCAL_RETURN, block->bytecode[3]);
+    block = nanbox_to_pointer(Vec_GetAt(code->codes, 1));
+    assert_int_equal(OP_RETURN, block->bytecode[3]);
+    Code_Free(code);
+}
+
+void Test_CompileSuperinstructions(void) {
+    compiler_status_t status;
+    code_t * code = Test_Compile("f := { |v| v.x abs };", &status);
+    code_t * block;
+
+    // each instruction that starts a declared sequence is rewritten,
+    // the other instructions stay where they are
+    assert_int_equal(COMPILER_OK, status);
+    block = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    assert_int_equal(OP_LOAD_LOCAL_GET_FIELD_SEND, block->bytecode[0]);
+    assert_int_equal(0, Code_GetOperand(block, 0, 0));
+    assert_int_equal(OP_GET_FIELD_SEND, block->bytecode[3]);
+    assert_int_equal(OP_SEND, block->bytecode[8]);
+    assert_int_equal(OP_RETURN, block->bytecode[15]);
+    Code_Free(code);
+
+    code = Test_CompileWith("f := { |v| v.x abs };", false, false, &status);
+    block = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    assert_int_equal(OP_LOAD_LOCAL, block->bytecode[0]);
+    assert_int_equal(OP_GET_FIELD, block->bytecode[3]);
+    Code_Free(code);
+
+    code = Test_Compile("1 + 2", &status);
+    assert_int_equal(OP_PUSH_CONST, code->bytecode[0]);
+    assert_int_equal(OP_PUSH_CONST_ADD, code->bytecode[3]);
+    assert_int_equal(OP_ADD, code->bytecode[6]);
+    Code_Free(code);
+}
+
+/**
+ * Checks if a code contains an instruction
+ */
+static ssize_t Test_FindOpcode(code_t * code, opcode_t opcode) {
+    for (size_t offset = 0; offset < code->length; offset += Code_InstructionSize(code->bytecode[offset])) {
+        if (code->bytecode[offset] == opcode) return offset;
+    }
+    return -1;
+}
+
+static bool Test_HasOpcode(code_t * code, opcode_t opcode) {
+    return Test_FindOpcode(code, opcode) >= 0;
+}
+
+void Test_CompileFrameBlocks(void) {
+    compiler_status_t status;
+    code_t * code = Test_Compile("f := { |n| s := 0; n timesRepeat: { s = s + 1; }; s };", &status);
+    code_t * outer, * inner;
+
+    // a block only called by the message it's given to lives in the frame
+    // and reads the variables of the frame, they don't need a context
+    assert_int_equal(COMPILER_OK, status);
+    outer = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    inner = nanbox_to_pointer(Vec_GetAt(outer->codes, 0));
+    assert_false(outer->needs_context);
+    assert_int_equal(1, outer->frame_blocks_count);
+    assert_true(Test_HasOpcode(outer, OP_MAKE_FRAME_BLOCK));
+    assert_true(Test_HasOpcode(outer, OP_SEND_BLOCKS));
+    assert_false(Test_HasOpcode(outer, OP_MAKE_BLOCK));
+    assert_int_equal(OP_LOAD_CAPTURED, inner->bytecode[0]);
+    assert_int_equal(1, inner->captured_depth);
+    assert_int_equal(0, outer->captured_depth);
+    Code_Free(code);
+
+    // a block that can escape still needs a context
+    code = Test_Compile("f := { |n| s := 0; n timesRepeat: { s = s + 1; }; { s } };", &status);
+    outer = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    assert_true(outer->needs_context);
+    assert_true(Test_HasOpcode(outer, OP_MAKE_FRAME_BLOCK));
+    assert_true(Test_HasOpcode(outer, OP_MAKE_BLOCK));
+    Code_Free(code);
+
+    // other messages get heap blocks
+    code = Test_Compile("f := { |b| x := 1; b value: { x } };", &status);
+    outer = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    assert_true(outer->needs_context);
+    assert_int_equal(0, outer->frame_blocks_count);
+    assert_false(Test_HasOpcode(outer, OP_SEND_BLOCKS));
+    Code_Free(code);
+}
+
+void Test_CompileRegisters(void) {
+    compiler_status_t status;
+    code_t * code = Test_CompileWith("f := { |a b| c := a * b + 1; a = c; this add: c to: 2 };",
+                                     true, true, &status);
+    code_t * block;
+
+    // the operands are addressed in place, only the last operation
+    // writes the variable and the message is sent in one instruction
+    assert_int_equal(COMPILER_OK, status);
+    block = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    assert_int_equal(OP_MUL_R, block->bytecode[0]);
+    assert_int_equal(0, Code_GetOperand(block, 0, 1));
+    assert_int_equal(1, Code_GetOperand(block, 0, 2));
+    assert_int_equal(OP_ADD_R, block->bytecode[7]);
+    assert_int_equal(2, Code_GetOperand(block, 7, 0));
+    assert_int_equal(CODE_REGISTER_CONSTANT, Code_GetOperand(block, 7, 2) & CODE_REGISTER_CONSTANT);
+    assert_int_equal(OP_MOVE, block->bytecode[14]);
+    assert_int_equal(OP_SEND_R2, block->bytecode[19]);
+    assert_int_equal(CODE_REGISTER_THIS, Code_GetOperand(block, 19, 2));
+    assert_false(Test_HasOpcode(block, OP_LOAD_LOCAL));
+    Code_Free(code);
+
+    // globals and captured variables stay on the stack
+    code = Test_CompileWith("g := 1; f := { |a| { a + g } };", true, true, &status);
+    block = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    block = nanbox_to_pointer(Vec_GetAt(block->codes, 0));
+    assert_false(Test_HasOpcode(block, OP_ADD_R));
+    assert_true(Test_HasOpcode(block, OP_ADD));
+    Code_Free(code);
+
+    // without register instructions the operands go through the stack
+    code = Test_Compile("f := { |a b| c := a * b + 1; c };", &status);
+    block = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    assert_false(Test_HasOpcode(block, OP_MUL_R));
+    assert_true(Test_HasOpcode(block, OP_MUL));
+    Code_Free(code);
+}
+
+void Test_CompileLines(void) {
+    compiler_status_t status;
+    code_t * code = Test_Compile("a := 1;\nb := [a,\n    a];\n\nb push: { a };", &status);
+    code_t * block;
+
+    // the instructions know the line of the expression they come from
+    assert_int_equal(COMPILER_OK, status);
+    assert_int_equal(1, Code_GetLine(code, 0));
+    assert_int_equal(2, Code_GetLine(code, Test_FindOpcode(code, OP_NEW_ARRAY)));
+    assert_int_equal(5, Code_GetLine(code, Test_FindOpcode(code, OP_SEND)));
+    // an operand of an instruction has its line
+    assert_int_equal(5, Code_GetLine(code, Test_FindOpcode(code, OP_SEND) + 1));
+    block = nanbox_to_pointer(Vec_GetAt(code->codes, 0));
+    assert_int_equal(5, Code_GetLine(block, 0));
+    Code_Free(code);
+}
+
+void Test_CompileErrors(void) {
+    compiler_status_t status;
+    code_t * code = Test_Compile("this = 1;", &status);
+
+    assert_true(code == NULL);
+    assert_int_equal(COMPILER_ERROR, status);
+}
+
+/**
+ * Runs all compiler tests
+ */
+void Test_CompilerTests(void) {
+    test_fixture_start();
+    run_test(Test_CompileArith);
+    run_test(Test_CompileGlobalsAndLocals);
+    run_test(Test_CompileCapturedVariables);
+    run_test(Test_CompileMessages);
+    run_test(Test_CompileSuperinstructions);
+    run_test(Test_CompileFrameBlocks);
+    run_test(Test_CompileRegisters);
+    run_test(Test_CompileLines);
+    run_test(Test_CompileErrors);
+    test_fixture_end();
+}
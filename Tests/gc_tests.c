@@ -0,0 +1,433 @@
+/**
+ * @file gc_tests.c
+ * Garbage collector tests
+ */
+#include <stdio.h>
+#include "seatest.h"
+#include "gc.h"
+#include "nanbox.h"
+#include "symbol.h"
+#include "object.h"
+#include "arrayobject.h"
+#include "blockobject.h"
+#include "contextobject.h"
+#include "stringobject.h"
+#include "weakrefobject.h"
+#include "weakmapobject.h"
+#include "interpreter.h"
+
+void Test_GCCycles(void) {
+    size_t objects_count = GC_GetObjectsCount();
+    nanbox_t a = Object_New(sizeof(object_t), NULL, NULL);
+    nanbox_t b = Object_New(sizeof(object_t), NULL, NULL);
+    nanbox_t array = ArrayObject_New();
+
+    // the objects reference each other through fields, prototypes and items
+    Object_SetField(a, Symbol_Intern("other"), b);
+    Object_SetField(b, Symbol_Intern("other"), a);
+    Object_SetPrototype(a, b);
+    Object_SetPrototype(b, a);
+    ArrayObject_Append(array, array);
+    ArrayObject_Append(array, a);
+    Object_SetField(a, Symbol_Intern("array"), array);
+    assert_int_equal(objects_count + 3, GC_GetObjectsCount());
+
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
+}
+
+void Test_GCHandles(void) {
+    size_t objects_count = GC_GetObjectsCount();
+    nanbox_t object = Object_New(sizeof(object_t), NULL, NULL);
+
+    GC_AddHandle(&object);
+    Object_SetField(object, Symbol_Intern("child"), Object_New(sizeof(object_t), NULL, NULL));
+    GC_Collect();
+    // the handle keeps the object and what it references alive
+    assert_int_equal(objects_count + 2, GC_GetObjectsCount());
+    assert_true(nanbox_is_pointer(Object_GetField(object, Symbol_Intern("child"))));
+
+    // the handle sees the new values of the variable
+    object = nanbox_null();
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
+    GC_RemoveHandle(&object);
+}
+
+void Test_GCTraces(void) {
+    size_t objects_count = GC_GetObjectsCount();
+    nanbox_t array = ArrayObject_New();
+    nanbox_t context = ContextObject_New(ContextObject_New(nanbox_null(), 0), 1);
+    nanbox_t block = BlockObject_New(NULL, context, Object_New(sizeof(object_t), NULL, NULL));
+
+    // the items of an array, the captured context and the "this" of a block
+    // and the values and parent of a context are kept alive
+    ((contextobject_t *)nanbox_to_pointer(context))->values[0] = Object_New(sizeof(object_t), NULL, NULL);
+    ArrayObject_Append(array, block);
+    GC_AddHandle(&array);
+    GC_Collect();
+    assert_int_equal(objects_count + 6, GC_GetObjectsCount());
+
+    GC_RemoveHandle(&array);
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
+}
+
+void Test_GCNursery(void) {
+    nanbox_t object = Object_New(sizeof(object_t), NULL, NULL);
+    object_t * young = nanbox_to_pointer(object);
+    char name[16];
+
+    // new objects are young, the survivors of a young collection move to the old space
+    assert_true(GC_IsYoung(young));
+    for (int i = 0; i < 8; i++) {
+        snprintf(name, 16, "f%d", i);
+        Object_SetField(object, Symbol_Intern(name), nanbox_from_int(i));
+    }
+    GC_AddHandle(&object);
+    GC_CollectYoung();
+    assert_false(GC_IsYoung(nanbox_to_pointer(object)));
+    assert_false(nanbox_to_pointer(object) == young);
+    assert_int_equal(7, nanbox_to_int(Object_GetField(object, Symbol_Intern("f7"))));
+
+    // the write barrier keeps the young objects an old one references
+    Object_SetField(object, Symbol_Intern("child"), Object_New(sizeof(object_t), NULL, NULL));
+    Object_SetField(Object_GetField(object, Symbol_Intern("child")), Symbol_Intern("x"), nanbox_from_int(42));
+    assert_true(GC_IsYoungValue(Object_GetField(object, Symbol_Intern("child"))));
+    GC_CollectYoung();
+    assert_false(GC_IsYoungValue(Object_GetField(object, Symbol_Intern("child"))));
+    assert_int_equal(42, nanbox_to_int(Object_GetField(Object_GetField(object, Symbol_Intern("child")),
+                                                       Symbol_Intern("x"))));
+    GC_RemoveHandle(&object);
+    GC_Collect();
+}
+
+void Test_GCSweep(void) {
+    size_t objects_count = GC_GetObjectsCount();
+    nanbox_t list = nanbox_null();
+    nanbox_t object;
+    size_t young_collections;
+
+    // a long list is marked and freed without recursion
+    GC_AddHandle(&list);
+    for (int i = 0; i < 200000; i++) {
+        nanbox_t node = Object_New(sizeof(object_t), NULL, NULL);
+
+        Object_SetField(node, Symbol_Intern("next"), list);
+        list = node;
+    }
+    GC_Collect();
+    assert_int_equal(objects_count + 200000, GC_GetObjectsCount());
+    GC_RemoveHandle(&list);
+
+    // the garbage is freed in slices, the objects allocated meanwhile survive
+    GC_CollectLazily();
+    assert_false(GC_SweepStep(1000));
+    assert_true(GC_GetObjectsCount() >= objects_count + 199000);
+    // the nursery is still collected when it fills up during the sweep
+    young_collections = GC_GetStats().young_collections;
+    for (size_t i = 0; i <= GC_NURSERY_LIMIT / sizeof(object_t); i++) {
+        Object_New(sizeof(object_t), NULL, NULL);
+    }
+    GC_CollectIfNeeded();
+    assert_int_equal(young_collections + 1, GC_GetStats().young_collections);
+    assert_true(GC_IsCollecting());
+    object = Object_New(sizeof(object_t), NULL, NULL);
+    GC_AddHandle(&object);
+    GC_CollectYoung();
+    while (!GC_SweepStep(1000));
+    assert_int_equal(objects_count + 1, GC_GetObjectsCount());
+    GC_RemoveHandle(&object);
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
+}
+
+void Test_GCStats(void) {
+    gc_stats_t before = GC_GetStats();
+    gc_stats_t after;
+    size_t peak_size;
+    nanbox_t array = ArrayObject_New();
+    nanbox_t string = StringObject_New("hello");
+
+    // the objects are counted by type with what they hold
+    ArrayObject_Append(array, string);
+    after = GC_GetStats();
+    assert_int_equal(before.objects[ARRAY_OBJECT] + 1, after.objects[ARRAY_OBJECT]);
+    assert_int_equal(before.objects[STRING_OBJECT] + 1, after.objects[STRING_OBJECT]);
+    assert_true(after.arrays_bytes > before.arrays_bytes);
+    assert_int_equal(before.strings_bytes + 6, after.strings_bytes);
+    assert_true(after.allocated_bytes > before.allocated_bytes);
+    assert_true(after.peak_size >= after.heap_size + after.nursery_size);
+
+    // the peak includes the items of the arrays
+    for (size_t i = 0; i <= after.peak_size / sizeof(nanbox_t); i++) {
+        ArrayObject_Append(array, nanbox_from_int(i));
+    }
+    peak_size = after.peak_size;
+    after = GC_GetStats();
+    assert_true(after.arrays_bytes > peak_size);
+    assert_true(after.peak_size >= GC_GetHeapSize());
+
+    GC_Collect();
+    after = GC_GetStats();
+    assert_int_equal(before.objects[ARRAY_OBJECT], after.objects[ARRAY_OBJECT]);
+    assert_true(after.peak_size > peak_size);
+    assert_int_equal(before.full_collections + 1, after.full_collections);
+}
+
+void Test_GCExternalSize(void) {
+    nanbox_t live = ArrayObject_New();
+    size_t full_collections = GC_GetStats().full_collections;
+    size_t max_size = 0;
+
+    // the items of the arrays that die in the old space trigger the full collections
+    GC_AddHandle(&live);
+    for (int i = 0; i < 200; i++) {
+        nanbox_t array = ArrayObject_New();
+
+        for (int j = 0; j < 80000; j++) {
+            ArrayObject_Append(array, nanbox_from_int(j));
+        }
+        ArrayObject_SetAt(live, i % 4, array);
+        GC_CollectYoung();
+        GC_CollectIfNeeded();
+        if (GC_GetHeapSize() > max_size) max_size = GC_GetHeapSize();
+    }
+    assert_true(GC_GetStats().full_collections > full_collections);
+    assert_true(max_size < 16 * 1024 * 1024);
+    GC_RemoveHandle(&live);
+    GC_Collect();
+}
+
+void Test_GCInterpreter(void) {
+    size_t objects_count = GC_GetObjectsCount();
+    interpreter_t * interp = Interpreter_New();
+    nanbox_t result;
+
+    // the cycles the script leaves behind are collected while it runs
+    result = Interpreter_Eval(interp,
+        "i := 0; a := Null; b := Null;"
+        "{ i < 50000 } whileTrue: {"
+        "    a = { other: Null };"
+        "    b = { other: a };"
+        "    a.other = b;"
+        "    i = i + 1;"
+        "};"
+        "a.other.other == a", NULL);
+    assert_int_equal(INTERPRETER_OK, Interpreter_GetStatus(interp));
+    assert_true(nanbox_is_true(result));
+    assert_true(GC_GetObjectsCount() < objects_count + 50000);
+
+    // the closures and the values they captured survive the young collections
+    result = Interpreter_Eval(interp,
+        "counter := { make { n := 0; ^ { n = n + 1; n } } };"
+        "counters := [counter make, counter make];"
+        "i := 0;"
+        "{ i < 50000 } whileTrue: {"
+        "    t := [i, { other: i }];"
+        "    counters do: { |c| c value; };"
+        "    i = i + 1;"
+        "};"
+        "(counters at: 0) value + (counters at: 1) value", NULL);
+    assert_int_equal(INTERPRETER_OK, Interpreter_GetStatus(interp));
+    assert_true(nanbox_is_int(result));
+    assert_int_equal(100002, nanbox_to_int(result));
+
+    // the globals survive the collections
+    GC_Collect();
+    result = Interpreter_Eval(interp, "a.other.other == a", NULL);
+    assert_true(nanbox_is_true(result));
+
+    // the objects of the interpreter are freed with it
+    Interpreter_Free(interp);
+    assert_int_equal(objects_count, GC_GetObjectsCount());
+}
+
+void Test_GCSessions(void) {
+    size_t objects_count;
+    interpreter_t * interp = Interpreter_New();
+    nanbox_t result;
+
+    // each evaluation replaces a cyclic prototype graph, like a REPL session
+    for (int i = 0; i < 100; i++) {
+        result = Interpreter_Eval(interp,
+            "o := { x: 1, getX { ^ this.x } };"
+            "p := o clone;"
+            "o.clone = p; o.items = [o, p]; p.x = 2;"
+            "p getX", NULL);
+        assert_int_equal(INTERPRETER_OK, Interpreter_GetStatus(interp));
+        assert_int_equal(2, nanbox_to_int(result));
+        if (i == 0) {
+            GC_Collect();
+            objects_count = GC_GetObjectsCount();
+        }
+    }
+    // the graphs the globals don't reference anymore are freed
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
+    Interpreter_Free(interp);
+}
+
+/**
+ * Adds the finalizer to the counter given as data
+ */
+static void Test_CountFinalizer(nanbox_t finalizer, void * data) {
+    *(int *)data += nanbox_to_int(finalizer);
+}
+
+void Test_GCWeakReferences(void) {
+    size_t objects_count = GC_GetObjectsCount();
+    nanbox_t object = Object_New(sizeof(object_t), NULL, NULL);
+    nanbox_t weakref = WeakRefObject_New(object);
+    nanbox_t weakmap = WeakMapObject_New();
+    nanbox_t key = Object_New(sizeof(object_t), NULL, NULL);
+    nanbox_t value = Object_New(sizeof(object_t), NULL, NULL);
+    int finalized = 0;
+
+    GC_AddHandle(&object);
+    GC_AddHandle(&weakref);
+    GC_AddHandle(&weakmap);
+    GC_AddHandle(&key);
+    // the value of an entry only keeps its key alive through the map
+    Object_SetField(value, Symbol_Intern("key"), key);
+    WeakMapObject_Set(weakmap, key, value);
+    WeakMapObject_Set(weakmap, value, ArrayObject_New());
+    GC_AddFinalizer(object, nanbox_from_int(1), Test_CountFinalizer, &finalized);
+    GC_AddFinalizer(key, nanbox_from_int(10), Test_CountFinalizer, &finalized);
+
+    // the references follow the objects moved to the old space
+    GC_CollectYoung();
+    assert_true(nanbox_to_pointer(WeakRefObject_Get(weakref)) == nanbox_to_pointer(object));
+    assert_int_equal(2, WeakMapObject_GetCount(weakmap));
+    value = WeakMapObject_Get(weakmap, key);
+    assert_true(ArrayObject_Check(WeakMapObject_Get(weakmap, value)));
+    GC_Collect();
+    assert_int_equal(2, WeakMapObject_GetCount(weakmap));
+    assert_int_equal(0, finalized);
+
+    object = nanbox_null();
+    GC_Collect();
+    assert_true(nanbox_is_null(WeakRefObject_Get(weakref)));
+    assert_int_equal(1, finalized);
+    key = nanbox_null();
+    GC_Collect();
+    assert_int_equal(0, WeakMapObject_GetCount(weakmap));
+    assert_int_equal(11, finalized);
+
+    // the young referents are cleared by the young collections
+    object = Object_New(sizeof(object_t), NULL, NULL);
+    WeakMapObject_Set(weakmap, object, nanbox_from_int(1));
+    weakref = WeakRefObject_New(object);
+    GC_AddFinalizer(object, nanbox_from_int(100), Test_CountFinalizer, &finalized);
+    object = nanbox_null();
+    GC_CollectYoung();
+    assert_true(nanbox_is_null(WeakRefObject_Get(weakref)));
+    assert_int_equal(0, WeakMapObject_GetCount(weakmap));
+    assert_int_equal(111, finalized);
+
+    GC_RemoveHandle(&key);
+    GC_RemoveHandle(&weakmap);
+    GC_RemoveHandle(&weakref);
+    GC_RemoveHandle(&object);
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
+}
+
+void Test_GCWeakMaps(void) {
+    nanbox_t weakmap = WeakMapObject_New();
+    nanbox_t keys[100];
+
+    for (int i = 0; i < 100; i++) {
+        keys[i] = Object_New(sizeof(object_t), NULL, NULL);
+        WeakMapObject_Set(weakmap, keys[i], nanbox_from_int(i));
+    }
+    WeakMapObject_Set(weakmap, keys[7], nanbox_from_int(-7));
+    assert_int_equal(100, WeakMapObject_GetCount(weakmap));
+    assert_int_equal(-7, nanbox_to_int(WeakMapObject_Get(weakmap, keys[7])));
+
+    // the keys that collide with a removed one are still found
+    for (int i = 0; i < 100; i += 2) {
+        assert_true(WeakMapObject_Remove(weakmap, keys[i]));
+    }
+    assert_false(WeakMapObject_Remove(weakmap, keys[0]));
+    assert_int_equal(50, WeakMapObject_GetCount(weakmap));
+    for (int i = 0; i < 100; i++) {
+        nanbox_t value = WeakMapObject_Get(weakmap, keys[i]);
+
+        if (i % 2 == 0) assert_true(nanbox_is_null(value));
+        else assert_int_equal(i == 7 ? -7 : i, nanbox_to_int(value));
+    }
+    GC_Collect();
+}
+
+void Test_GCIncremental(void) {
+    static nanbox_t nodes[100000];
+    size_t objects_count = GC_GetObjectsCount();
+    nanbox_t list = nanbox_null();
+    nanbox_t array = ArrayObject_New();
+    size_t pauses = GC_GetStats().pauses;
+    size_t added = 0;
+    size_t moved = 0;
+
+    GC_AddHandle(&list);
+    GC_AddHandle(&array);
+    for (int i = 0; i < 100000; i++) {
+        nodes[i] = Object_New(sizeof(object_t), NULL, NULL);
+        Object_SetField(nodes[i], Symbol_Intern("next"), list);
+        list = nodes[i];
+    }
+    GC_Collect();
+    // the nodes moved to the old space
+    nodes[99999] = list;
+    for (int i = 99999; i > 0; i--) {
+        nodes[i - 1] = Object_GetField(nodes[i], Symbol_Intern("next"));
+    }
+
+    // the nodes moved from the end of the list to the array while it is
+    // marked are kept by the write barrier, the young survivors too
+    GC_SetPauseTime(50);
+    GC_CollectIncrementally();
+    assert_true(GC_IsCollecting());
+    for (size_t i = 0; GC_IsCollecting(); i++) {
+        if (moved < 99999) {
+            ArrayObject_Append(array, nodes[moved]);
+            Object_SetField(nodes[moved + 1], Symbol_Intern("next"), nanbox_null());
+            moved++;
+        }
+        if (i % 1000 == 0) {
+            ArrayObject_Append(array, Object_New(sizeof(object_t), NULL, NULL));
+            added++;
+            GC_CollectYoung();
+        }
+        GC_CollectIfNeeded();
+    }
+    GC_SetPauseTime(0);
+    GC_Collect();
+    assert_int_equal(objects_count + 100000 + 1 + added, GC_GetObjectsCount());
+    assert_true(GC_GetStats().pauses > pauses);
+
+    GC_RemoveHandle(&array);
+    GC_RemoveHandle(&list);
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
+}
+
+/**
+ * Runs all garbage collector tests
+ */
+void Test_GCTests(void) {
+    test_fixture_start();
+    run_test(Test_GCCycles);
+    run_test(Test_GCHandles);
+    run_test(Test_GCTraces);
+    run_test(Test_GCNursery);
+    run_test(Test_GCSweep);
+    run_test(Test_GCStats);
+    run_test(Test_GCExternalSize);
+    run_test(Test_GCInterpreter);
+    run_test(Test_GCSessions);
+    run_test(Test_GCWeakReferences);
+    run_test(Test_GCWeakMaps);
+    run_test(Test_GCIncremental);
+    test_fixture_end();
+}
@@ -0,0 +1,10 @@
+/**
+ * @file compiler_tests.h
+ * Bytecode compiler tests
+ */
+#pragma once
+
+/**
+ * Runs all compiler tests
+ */
+void Test_CompilerTests(void);
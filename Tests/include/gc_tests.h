@@ -0,0 +1,10 @@
+/**
+ * @file gc_tests.h
+ * Garbage collector tests
+ */
+#pragma once
+
+/**
+ * Runs all garbage collector tests
+ */
+void Test_GCTests(void);
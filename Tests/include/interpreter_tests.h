@@ -0,0 +1,10 @@
+/**
+ * @file interpreter_tests.h
+ * Bytecode interpreter tests
+ */
+#pragma once
+
+/**
+ * Runs all interpreter tests
+ */
+void Test_InterpreterTests(void);
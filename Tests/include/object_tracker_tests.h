@@ -1,10 +0,0 @@
-/**
- * @file object_tracker.h
- * Object Tracker Tests
- */
-#pragma once
-
-/**
- * Runs all object tracker tests
- */
-void Test_ObjectTrackerTests(void);
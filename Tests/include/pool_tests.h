@@ -0,0 +1,10 @@
+/**
+ * @file pool_tests.h
+ * Pool allocator tests
+ */
+#pragma once
+
+/**
+ * Runs all the pool allocator tests
+ */
+void Test_PoolTests(void);
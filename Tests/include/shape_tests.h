@@ -0,0 +1,10 @@
+/**
+ * @file shape_tests.h
+ * Hidden classes tests
+ */
+#pragma once
+
+/**
+ * Runs all hidden classes tests
+ */
+void Test_ShapeTests(void);
@@ -0,0 +1,10 @@
+/**
+ * @file symbol_tests.h
+ * Symbols table tests
+ */
+#pragma once
+
+/**
+ * Runs all symbols table tests
+ */
+void Test_SymbolTests(void);
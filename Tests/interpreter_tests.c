@@ -0,0 +1,472 @@
+/**
+ * @file interpreter_tests.c
+ * Bytecode interpreter tests
+ */
+#include <string.h>
+#include "interpreter.h"
+#include "Parser/include/parser.h"
+#include "ast.h"
+#include "compiler.h"
+#include "stringobject.h"
+#include "arrayobject.h"
+#include "gc.h"
+#include "nanbox.h"
+#include "seatest.h"
+
+/**
+ * Evaluates a buffer that must give an integer
+ */
+static void Test_AssertEvalInt(interpreter_t * interp, char * buffer, int expected) {
+    nanbox_t result = Interpreter_Eval(interp, buffer, NULL);
+    assert_int_equal(INTERPRETER_OK, Interpreter_GetStatus(interp));
+    assert_true(nanbox_is_int(result));
+    assert_int_equal(expected, nanbox_to_int(result));
+}
+
+void Test_EvalArith(void) {
+    interpreter_t * interp = Interpreter_New();
+    nanbox_t result;
+
+    Test_AssertEvalInt(interp, "1 + 2 * 3", 7);
+    Test_AssertEvalInt(interp, "(1 + 2) * 3", 9);
+    Test_AssertEvalInt(interp, "6 / 2", 3);
+    Test_AssertEvalInt(interp, "-(4)", -4);
+
+    result = Interpreter_Eval(interp, "7 / 2", NULL);
+    assert_true(nanbox_is_double(result));
+    assert_double_equal(3.5, nanbox_to_double(result), 0.0001);
+
+    // overflowing integers become doubles
+    result = Interpreter_Eval(interp, "2147483647 + 1", NULL);
+    assert_true(nanbox_is_double(result));
+    assert_double_equal(2147483648.0, nanbox_to_double(result), 0.0001);
+
+    result = Interpreter_Eval(interp, "1 < 2 && 3 >= 3", NULL);
+    assert_true(nanbox_is_true(result));
+    result = Interpreter_Eval(interp, "False || Null", NULL);
+    assert_true(nanbox_is_null(result));
+
+    Interpreter_Free(interp);
+}
+
+void Test_EvalVariables(void) {
+    interpreter_t * interp = Interpreter_New();
+
+    Interpreter_Eval(interp, "a := 20;", NULL);
+    Test_AssertEvalInt(interp, "a = a + 1; a", 21);
+    Test_AssertEvalInt(interp, "f := { |x| y := x * 2; y }; f value: a", 42);
+    Test_AssertEvalInt(interp, "mk := { |n| { |k| n + k } }; add := mk value: 10; add value: 5", 15);
+    Test_AssertEvalInt(interp, "c := 0; inc := { c = c + 1; }; inc value; inc value; c", 2);
+
+    Interpreter_Free(interp);
+}
+
+void Test_EvalObjects(void) {
+    interpreter_t * interp = Interpreter_New();
+
+    Interpreter_Eval(interp, "o := { x: 1, getX { ^ this.x }, add: a to: b { ^ a + b + this.x } };", NULL);
+    Test_AssertEvalInt(interp, "o getX", 1);
+    Test_AssertEvalInt(interp, "o add: 2 to: 3", 6);
+    Test_AssertEvalInt(interp, "o x", 1);
+
+    // clones inherit from their prototype
+    Test_AssertEvalInt(interp, "p := o clone; p.x = 10; p getX", 10);
+    Test_AssertEvalInt(interp, "o.x", 1);
+
+    Test_AssertEvalInt(interp, "f := { fact: n { ^ (n < 2) ifTrue: 1 ifFalse: { n * (this fact: (n - 1)) } } }; f fact: 5", 120);
+    Interpreter_Free(interp);
+}
+
+void Test_EvalArraysAndStrings(void) {
+    interpreter_t * interp = Interpreter_New();
+    nanbox_t result;
+
+    Interpreter_Eval(interp, "a := [1, 2, 3];", NULL);
+    Test_AssertEvalInt(interp, "a[1]", 2);
+    Test_AssertEvalInt(interp, "a[0] = 5; a at: 0", 5);
+    Test_AssertEvalInt(interp, "a push: 4; a length", 4);
+    Test_AssertEvalInt(interp, "a pop; a.length", 3);
+    Test_AssertEvalInt(interp, "a push: 4; a.length", 4);
+    Test_AssertEvalInt(interp, "s := 0; a do: { |i| s = s + i; }; s", 14);
+    Test_AssertEvalInt(interp, "s := 0; 1 to: 4 do: { |i| s = s + i; }; s", 10);
+    Test_AssertEvalInt(interp, "i := 0; { i < 5 } whileTrue: { i = i + 1; }; i", 5);
+    Test_AssertEvalInt(interp, "a sum", 14);
+    Test_AssertEvalInt(interp, "b := [0.5, 1.5, 2]; b[2] = b[0] + b[1]; b[2] + b sum", 6);
+    Interpreter_Eval(interp, "[1, \"a\"] sum", NULL);
+    assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+    Interpreter_ClearError(interp);
+    Test_AssertEvalInt(interp, "c := []; c[10] = True; c.length", 11);
+    Test_AssertEvalInt(interp, "c[100000000] = 7; c at: 50 put: 1; c[100000000] + c[50]", 8);
+    Test_AssertEvalInt(interp, "c length", 100000001);
+    Interpreter_Eval(interp, "c[-1] = 1", NULL);
+    assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+    Interpreter_ClearError(interp);
+    Test_AssertEvalInt(interp, "e := [1, 2, 3, 4, 5]; f := e copyFrom: 1 to: 3; f[0] = 10; f sum + e sum", 32);
+    Test_AssertEvalInt(interp, "f = e copyFrom: 2 to: 1; f length", 0);
+    Test_AssertEvalInt(interp, "f = e copyFrom: 5 to: 4; f length", 0);
+    Test_AssertEvalInt(interp, "f = [] copyFrom: 0 to: -1; f length", 0);
+    Test_AssertEvalInt(interp, "f = [1] copyFrom: 1 to: 0; f push: 2; f length", 1);
+    Interpreter_Eval(interp, "e copyFrom: 0 to: 5", NULL);
+    assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+    Interpreter_ClearError(interp);
+    Interpreter_Eval(interp, "e copyFrom: 3 to: 1", NULL);
+    assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+    Interpreter_ClearError(interp);
+    Interpreter_Eval(interp, "e copyFrom: 6 to: 5", NULL);
+    assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+    Interpreter_ClearError(interp);
+    Interpreter_Eval(interp, "e copyFrom: 0 to: 2147483647", NULL);
+    assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+    Interpreter_ClearError(interp);
+
+    result = Interpreter_Eval(interp, "\"ab\" + \"cd\"", NULL);
+    assert_true(StringObject_Check(result));
+    assert_string_equal("abcd", StringObject_GetValue(result));
+
+    result = Interpreter_Eval(interp, "\"ab\" == \"ab\"", NULL);
+    assert_true(nanbox_is_true(result));
+
+    Interpreter_Free(interp);
+}
+
+void Test_EvalInlineCaches(void) {
+    interpreter_t * interp = Interpreter_New();
+    interpreter_cache_stats_t stats;
+
+    // the send site of the loop only misses once
+    Test_AssertEvalInt(interp, "o := { x: 1, getX { ^ this.x } }; s := 0; 1 to: 10 do: { |i| s = s + (o getX); }; s", 10);
+    stats = Interpreter_GetCacheStats(interp);
+    assert_true(stats.hits >= 9);
+
+    // adding a field to an object that took part in a lookup invalidates the caches
+    Test_AssertEvalInt(interp, "p := o clone; f := { p getX }; f value", 1);
+    Test_AssertEvalInt(interp, "p.getX = { ^ 2 }; f value", 2);
+    Test_AssertEvalInt(interp, "o.getX = { ^ 3 }; (o clone) getX", 3);
+
+    // field accesses are cached by shape
+    Interpreter_Eval(interp, "r := { x: 1 }; q := { y: 0, x: 2 }; gx := { |v| v.x }; sx := { |v n| v.x = n; };", NULL);
+    Test_AssertEvalInt(interp, "(gx value: r) + (gx value: q) + (gx value: r)", 4);
+    Test_AssertEvalInt(interp, "sx value: r value: 5; sx value: q value: 6; sx value: r value: 7; r.x + q.x", 13);
+
+    // receivers of many kinds make a site use the global cache
+    Interpreter_Eval(interp, "vals := [1, \"a\", [1], True, o, p]; g := { |v| v clone };", NULL);
+    Interpreter_Eval(interp, "vals do: { |v| g value: v; }; vals do: { |v| g value: v; };", NULL);
+    assert_int_equal(INTERPRETER_OK, Interpreter_GetStatus(interp));
+    stats = Interpreter_GetCacheStats(interp);
+    assert_true(stats.megamorphic_hits > 0);
+
+    Interpreter_Free(interp);
+}
+
+void Test_EvalNumericFastPaths(void) {
+    interpreter_t * interp = Interpreter_New();
+    nanbox_t result;
+
+    // int32 overflows are promoted to doubles
+    Interpreter_Eval(interp, "max := 2147483647; min := 0 - max - 1;", NULL);
+    result = Interpreter_Eval(interp, "min - 1", NULL);
+    assert_true(nanbox_is_double(result));
+    assert_double_equal(-2147483649.0, nanbox_to_double(result), 0.0001);
+    result = Interpreter_Eval(interp, "max * max", NULL);
+    assert_true(nanbox_is_double(result));
+    assert_double_equal(4611686014132420609.0, nanbox_to_double(result), 1.0);
+    result = Interpreter_Eval(interp, "min / (0 - 1)", NULL);
+    assert_true(nanbox_is_double(result));
+    assert_double_equal(2147483648.0, nanbox_to_double(result), 0.0001);
+    Test_AssertEvalInt(interp, "min + max", -1);
+    Test_AssertEvalInt(interp, "min / 2", -1073741824);
+
+    // doubles stay doubles and mix with integers
+    result = Interpreter_Eval(interp, "1.5 * 3.0 - 0.5", NULL);
+    assert_true(nanbox_is_double(result));
+    assert_double_equal(4.0, nanbox_to_double(result), 0.0001);
+    result = Interpreter_Eval(interp, "1.5 + 1", NULL);
+    assert_double_equal(2.5, nanbox_to_double(result), 0.0001);
+    result = Interpreter_Eval(interp, "1.5 < 2.5 && 2 > 1.5 && 2 == 2.0 && 1.5 != 2.5", NULL);
+    assert_true(nanbox_is_true(result));
+    result = Interpreter_Eval(interp, "(max + 1) > max", NULL);
+    assert_true(nanbox_is_true(result));
+
+    Interpreter_Eval(interp, "1.0 / 0.0", NULL);
+    assert_string_equal("Division by zero", Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+
+    Interpreter_Free(interp);
+}
+
+void Test_EvalSuperinstructions(void) {
+    interpreter_t * interp = Interpreter_New();
+
+    Interpreter_Eval(interp, "o := { x: -3, getX { ^ this.x } }; f := { |v| v.x abs };", NULL);
+    Test_AssertEvalInt(interp, "(f value: o) + (o getX) + 1 - 2", -1);
+    // a jump can land in the middle of a fused sequence
+    Interpreter_Eval(interp, "h := { |v w| w - (v || 1) };", NULL);
+    Test_AssertEvalInt(interp, "(h value: 2 value: 10) + (h value: Null value: 100)", 107);
+    // the operators of the fused instructions still fall back to messages
+    Test_AssertEvalInt(interp, "s := \"ab\" + \"cd\"; s length", 4);
+
+    Interpreter_Free(interp);
+}
+
+void Test_EvalNonLocalReturn(void) {
+    interpreter_t * interp = Interpreter_New();
+
+    Interpreter_Eval(interp,
+        "o := {"
+        "    find: n in: a { a do: { |x| (x == n) ifTrue: { ^ x * 10 }; }; ^ 0 },"
+        "    first: a { ^ a detect: { |x| x > 2 } },"
+        "    nested: a { a do: { |x| a do: { |y| (x + y == 5) ifTrue: { ^ x * y }; }; }; ^ Null },"
+        "    leak { ^ { ^ 5 } }"
+        "};", NULL);
+    // "^" in a block returns from the method through the native loops
+    Test_AssertEvalInt(interp, "o find: 3 in: [1, 2, 3, 4]", 30);
+    Test_AssertEvalInt(interp, "o find: 7 in: [1, 2, 3, 4]", 0);
+    Test_AssertEvalInt(interp, "o first: [1, 2, 3, 4]", 3);
+    Test_AssertEvalInt(interp, "o nested: [1, 2, 3, 4]", 4);
+    Test_AssertEvalInt(interp, "s := 0; 1 to: 3 do: { |i| s = s + (o find: i in: [2, 3]); }; s", 50);
+    assert_int_equal(0, interp->frames_count);
+    assert_true(interp->sp == interp->stack);
+
+    // the method of the block already returned
+    Interpreter_Eval(interp, "b := o leak; b value", NULL);
+    assert_string_equal("Cannot return from a method that already returned",
+                        Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+
+    // outside of a method "^" returns from the block
+    Test_AssertEvalInt(interp, "f := { ^ 2 }; (f value) + 1", 3);
+
+    Interpreter_Free(interp);
+}
+
+void Test_EvalFrameBlocks(void) {
+    interpreter_t * interp = Interpreter_New();
+
+    Interpreter_Eval(interp,
+        "o := {"
+        "    sum: n { s := 0; 1 to: n do: { |i| (i > 2) ifTrue: { s = s + i; }; }; ^ s },"
+        "    count: a { c := 0; a do: { |x| a do: { |y| (x == y) ifTrue: { c = c + 1; }; }; }; ^ c },"
+        "    loop { i := 0; { i < 5 } whileTrue: { i = i + 1; }; ^ i },"
+        "    down: n {"
+        "        (n == 0) ifTrue: { ^ 0 };"
+        "        (n < 0) ifTrue: { ^ -1 } ifFalse: { (n < 0) ifTrue: { ^ -1 }; };"
+        "        (n < 0) ifFalse: { ^ (this down: (n - 1)) + 1 } ifTrue: { ^ -1 }"
+        "    }"
+        "};", NULL);
+    // the blocks read and write the variables of the frames that created them
+    Test_AssertEvalInt(interp, "o sum: 4", 7);
+    Test_AssertEvalInt(interp, "o count: [1, 2, 3]", 3);
+    Test_AssertEvalInt(interp, "o loop", 5);
+    // once the storage of the frames is exhausted the blocks go to the heap
+    Test_AssertEvalInt(interp, "o down: 500", 500);
+    assert_int_equal(0, interp->frame_blocks_count);
+
+    // a message that isn't a builtin can keep the blocks, they move to the heap
+    Interpreter_Eval(interp,
+        "keeper := { saved: Null, do: b { this.saved = b; ^ Null } };"
+        "p := {"
+        "    make { x := 41; keeper do: { x = x + 1; x }; ^ x },"
+        "    nested { x := 1; [1, 2] do: { |i| keeper do: { x = x + i; x }; }; ^ x }"
+        "};", NULL);
+    Test_AssertEvalInt(interp, "p make", 41);
+    Test_AssertEvalInt(interp, "keeper.saved value", 42);
+    Test_AssertEvalInt(interp, "keeper.saved value", 43);
+    Test_AssertEvalInt(interp, "p nested", 1);
+    Test_AssertEvalInt(interp, "keeper.saved value", 3);
+    Test_AssertEvalInt(interp, "keeper.saved value", 5);
+    assert_int_equal(0, interp->frame_blocks_count);
+    assert_int_equal(0, interp->frames_count);
+    assert_true(interp->sp == interp->stack);
+
+    Interpreter_Free(interp);
+}
+
+/**
+ * Evaluates a buffer compiled to register instructions
+ */
+static nanbox_t Test_EvalWithRegisters(interpreter_t * interp, char * buffer) {
+    parser_t * parser = Parser_New(buffer, strlen(buffer), NULL, true);
+    ast_node_t * ast_root = Parser_CreateAST(parser, false);
+    compiler_t * compiler = Compiler_New();
+    code_t * chunk;
+
+    compiler->registers = true;
+    chunk = Compiler_Compile(compiler, ast_root);
+    assert_true(chunk != NULL);
+    Compiler_Free(compiler);
+    ASTNode_Free(ast_root);
+    Parser_Free(parser);
+    return Interpreter_Run(interp, chunk);
+}
+
+void Test_EvalRegisters(void) {
+    interpreter_t * interp = Interpreter_New();
+    nanbox_t result;
+
+    Test_EvalWithRegisters(interp, "o := { add: a to: b { ^ a + b }, "
+                               "poly: x { y := x * x + 1; z := this add: y to: x; z = z * 2 - y; ^ z }, "
+                               "big: x { y := x + 1; ^ y }, "
+                               "half: x { ^ x / 2 }, "
+                               "shout: s { t := s + \"!\"; ^ t length }, "
+                               "min: a or: b { ^ (a < b) ifTrue: a ifFalse: b } };");
+    assert_int_equal(INTERPRETER_OK, Interpreter_GetStatus(interp));
+    // the same messages give the same answers as with the stack instructions
+    Test_AssertEvalInt(interp, "o poly: 3", 16);
+    Test_AssertEvalInt(interp, "o min: 7 or: 4", 4);
+    Test_AssertEvalInt(interp, "o shout: \"abc\"", 4);
+    result = Interpreter_Eval(interp, "o big: 2147483647", NULL);
+    assert_true(nanbox_is_double(result));
+    assert_double_equal(2147483648.0, nanbox_to_double(result), 0.0001);
+    result = Interpreter_Eval(interp, "o half: 7", NULL);
+    assert_double_equal(3.5, nanbox_to_double(result), 0.0001);
+
+    // an operator the operands don't understand is an error
+    Test_EvalWithRegisters(interp, "o2 := { sub: s { t := s - 1; ^ t } }; o2 sub: \"a\"");
+    assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+
+    Interpreter_Free(interp);
+}
+
+void Test_EvalErrors(void) {
+    interpreter_t * interp = Interpreter_New();
+
+    Interpreter_Eval(interp, "undefined_variable", NULL);
+    assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+    assert_string_equal("Undefined variable 'undefined_variable'", Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+
+    Interpreter_Eval(interp, "1 / 0", NULL);
+    assert_string_equal("Division by zero", Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+
+    Interpreter_Eval(interp, "1 foo", NULL);
+    assert_string_equal("Message 'foo' not understood", Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+
+    // errors in nested blocks unwind everything
+    Interpreter_Eval(interp, "[1] do: { |i| i bar }", NULL);
+    assert_string_equal("Message 'bar' not understood", Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+
+    Interpreter_Eval(interp, "r := { |n| r value: n }; r value: 1", NULL);
+    assert_string_equal("Stack overflow", Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+
+    // the interpreter is still usable
+    assert_int_equal(0, interp->frames_count);
+    assert_true(interp->sp == interp->stack);
+    Test_AssertEvalInt(interp, "1 + 1", 2);
+    Interpreter_Free(interp);
+}
+
+void Test_EvalReceiverChecks(void) {
+    interpreter_t * interp = Interpreter_New();
+    char * array_sends[] = {
+        "Array at: 0", "Array at: 0 put: 1", "Array push: 1", "Array pop", "Array length",
+        "Array do: { |i| i }", "Array detect: { |i| i }", "Array sum", "Array copyFrom: 0 to: 0",
+        "o := Array clone; o push: 1"
+    };
+    char * string_sends[] = { "String length", "String + 1", "s := String clone; s length" };
+
+    // the prototypes and the objects inheriting from them are not arrays or strings
+    for (size_t i = 0; i < sizeof(array_sends) / sizeof(array_sends[0]); i++) {
+        Interpreter_Eval(interp, array_sends[i], NULL);
+        assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+        assert_string_equal("Receiver is not an array", Interpreter_GetError(interp)->message);
+        Interpreter_ClearError(interp);
+    }
+    for (size_t i = 0; i < sizeof(string_sends) / sizeof(string_sends[0]); i++) {
+        Interpreter_Eval(interp, string_sends[i], NULL);
+        assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+        assert_string_equal("Receiver is not a string", Interpreter_GetError(interp)->message);
+        Interpreter_ClearError(interp);
+    }
+    Test_AssertEvalInt(interp, "a := Array new; a push: 1; a length", 1);
+    Interpreter_Free(interp);
+}
+
+void Test_EvalHeapLimit(void) {
+    interpreter_t * interp = Interpreter_New();
+    interpreter_t * other = Interpreter_New();
+    nanbox_t result;
+
+    Interpreter_SetHeapLimit(interp, GC_GetAccountSize(interp->heap_account) + 1024 * 1024);
+    // the garbage is collected instead of exceeding the limit
+    Test_AssertEvalInt(interp, "n := 0; 100000 timesRepeat: { a := [n, n]; n = n + 1; }; n", 100000);
+
+    Interpreter_Eval(interp, "f := { a := Array new; { True } whileTrue: { a push: { x: 1 }; } }; f value", NULL);
+    assert_int_equal(INTERPRETER_ERROR, Interpreter_GetStatus(interp));
+    assert_string_equal("Out of memory", Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+    assert_int_equal(0, interp->frames_count);
+
+    // the memory of the unwound calls is freed before the handler runs
+    result = Interpreter_Eval(interp, "{ b := Array new; { True } whileTrue: { b push: \"garbage\"; } }"
+                                      " onError: { |e| e }", NULL);
+    assert_int_equal(INTERPRETER_OK, Interpreter_GetStatus(interp));
+    assert_string_equal("Out of memory", StringObject_GetValue(result));
+    assert_true(GC_GetAccountSize(interp->heap_account) <= interp->heap_limit);
+
+    // the handler runs while the memory is still reachable, and can release it
+    result = Interpreter_Eval(interp, "big := Array new; { { True } whileTrue: { big push: { x: 1 }; } }"
+                                      " onError: { |e| e }", NULL);
+    assert_int_equal(INTERPRETER_OK, Interpreter_GetStatus(interp));
+    assert_string_equal("Out of memory", StringObject_GetValue(result));
+    assert_true(GC_GetAccountSize(interp->heap_account) > interp->heap_limit);
+
+    // the other interpreters are not charged for it
+    Interpreter_SetHeapLimit(other, GC_GetAccountSize(other->heap_account) + 1024 * 1024);
+    Test_AssertEvalInt(other, "n := 0; 1000 timesRepeat: { a := [n]; n = n + 1; }; n", 1000);
+
+    Test_AssertEvalInt(interp, "big = Null; n := 0; 1000 timesRepeat: { n = n + 1; }; n", 1000);
+    assert_true(GC_GetAccountSize(interp->heap_account) <= interp->heap_limit);
+
+    Interpreter_SetHeapLimit(interp, 0);
+    Interpreter_Free(other);
+    Interpreter_Free(interp);
+}
+
+void Test_EvalWeakReferences(void) {
+    interpreter_t * interp = Interpreter_New();
+    nanbox_t result;
+
+    Test_AssertEvalInt(interp, "cache := WeakMap new; k := Object new; cache at: k put: 42; cache at: k", 42);
+    Interpreter_Eval(interp, "r := WeakRef on: k; k = Null; count := 0;"
+                             "o := Object new; o whenCollected: { count = count + 1; }; o = Null;"
+                             "p := Object new; p whenCollected: { 1 foo }; p = Null;", NULL);
+    assert_int_equal(INTERPRETER_OK, Interpreter_GetStatus(interp));
+    GC_Collect();
+    // the finalizers run at the next call, their errors are ignored
+    Test_AssertEvalInt(interp, "count", 1);
+    Test_AssertEvalInt(interp, "cache length", 0);
+    result = Interpreter_Eval(interp, "r value", NULL);
+    assert_true(nanbox_is_null(result));
+    assert_true(interp->sp == interp->stack);
+
+    Interpreter_Eval(interp, "cache at: 1 put: 2", NULL);
+    assert_string_equal("Weak map keys must be objects", Interpreter_GetError(interp)->message);
+    Interpreter_ClearError(interp);
+    Interpreter_Free(interp);
+}
+
+/**
+ * Runs all interpreter tests
+ */
+void Test_InterpreterTests(void) {
+    test_fixture_start();
+    run_test(Test_EvalArith);
+    run_test(Test_EvalVariables);
+    run_test(Test_EvalObjects);
+    run_test(Test_EvalArraysAndStrings);
+    run_test(Test_EvalInlineCaches);
+    run_test(Test_EvalNumericFastPaths);
+    run_test(Test_EvalSuperinstructions);
+    run_test(Test_EvalNonLocalReturn);
+    run_test(Test_EvalFrameBlocks);
+    run_test(Test_EvalRegisters);
+    run_test(Test_EvalErrors);
+    run_test(Test_EvalReceiverChecks);
+    run_test(Test_EvalHeapLimit);
+    run_test(Test_EvalWeakReferences);
+    test_fixture_end();
+}
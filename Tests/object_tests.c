@@ -4,80 +4,132 @@
  */
 #include "seatest.h"
 #include "nanbox.h"
+#include "symbol.h"
 #include "object.h"
+#include "gc.h"
 
 void Test_SimpleFieldAccess(void) {
     nanbox_t object, val;
+    size_t objects_count = GC_GetObjectsCount();
 
-    object = Object_New(sizeof(object_t), NULL);
+    object = Object_New(sizeof(object_t), NULL, NULL);
     assert_true(nanbox_is_pointer(object));
-    val = Object_GetField(object, "hello");
+    val = Object_GetField(object, Symbol_Intern("hello"));
     assert_true(nanbox_is_null(val));
 
-    Object_SetField(object, "hello", nanbox_from_int(1337));
-    val = Object_GetField(object, "hello");
+    Object_SetField(object, Symbol_Intern("hello"), nanbox_from_int(1337));
+    val = Object_GetField(object, Symbol_Intern("hello"));
     assert_true(nanbox_is_int(val));
     assert_int_equal(1337, nanbox_to_int(val));
 
-    Object_DecRef(&object);
-    assert_true(nanbox_is_deleted(object));
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
 }
 
 void Test_FieldAccessViaPrototype(void) {
     nanbox_t object, proto, val;
+    size_t objects_count = GC_GetObjectsCount();
 
-    object = Object_New(sizeof(object_t), NULL);
+    object = Object_New(sizeof(object_t), NULL, NULL);
     assert_true(nanbox_is_pointer(object));
-    val = Object_GetField(object, "hello");
+    val = Object_GetField(object, Symbol_Intern("hello"));
     assert_true(nanbox_is_null(val));
 
-    proto = Object_New(sizeof(object_t), NULL);
+    proto = Object_New(sizeof(object_t), NULL, NULL);
     assert_true(nanbox_is_pointer(proto));
-    Object_SetField(proto, "hello", nanbox_from_int(1337));
+    Object_SetField(proto, Symbol_Intern("hello"), nanbox_from_int(1337));
     Object_SetPrototype(object, proto);
     
-    val = Object_GetField(object, "hello");
+    val = Object_GetField(object, Symbol_Intern("hello"));
     assert_true(nanbox_is_int(val));
     assert_int_equal(1337, nanbox_to_int(val));
 
-    Object_DecRef(&object);
-    assert_true(nanbox_is_deleted(object));
-    // assert_true(nanbox_is_deleted(proto));
+    // nothing references the objects anymore
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
 }
 
 void Test_PrototypeFieldValueOverride(void) {
     nanbox_t object, proto, val;
+    size_t objects_count = GC_GetObjectsCount();
 
-    object = Object_New(sizeof(object_t), NULL);
+    object = Object_New(sizeof(object_t), NULL, NULL);
     assert_true(nanbox_is_pointer(object));
-    val = Object_GetField(object, "hello");
+    val = Object_GetField(object, Symbol_Intern("hello"));
     assert_true(nanbox_is_null(val));
 
-    proto = Object_New(sizeof(object_t), NULL);
+    proto = Object_New(sizeof(object_t), NULL, NULL);
     assert_true(nanbox_is_pointer(proto));
-    Object_SetField(proto, "hello", nanbox_from_int(1337));
+    Object_SetField(proto, Symbol_Intern("hello"), nanbox_from_int(1337));
     Object_SetPrototype(object, proto);
     
     // object should get the value from its prototype
-    val = Object_GetField(object, "hello");
+    val = Object_GetField(object, Symbol_Intern("hello"));
     assert_true(nanbox_is_int(val));
     assert_int_equal(1337, nanbox_to_int(val));
 
     // override the value at "hello" in object
-    Object_SetField(object, "hello", nanbox_from_int(1234));
+    Object_SetField(object, Symbol_Intern("hello"), nanbox_from_int(1234));
     // the value is into object and overrides the one in its prototype
-    val = Object_GetField(object, "hello");
+    val = Object_GetField(object, Symbol_Intern("hello"));
     assert_true(nanbox_is_int(val));
     assert_int_equal(1234, nanbox_to_int(val));
 
     // the value in the prototype has not changed
-    val = Object_GetField(proto, "hello");
+    val = Object_GetField(proto, Symbol_Intern("hello"));
     assert_true(nanbox_is_int(val));
     assert_int_equal(1337, nanbox_to_int(val));
 
-    Object_DecRef(&object);
-    assert_true(nanbox_is_deleted(object));
-    // assert_true(nanbox_is_deleted(proto));
+    // nothing references the objects anymore
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
+}
+
+void Test_CachedPrototypeLookup(void) {
+    nanbox_t protos[5];
+    nanbox_t object, other;
+    char * hello = Symbol_Intern("hello");
+    size_t objects_count = GC_GetObjectsCount();
+
+    // object -> protos[4] -> ... -> protos[0] which holds the field
+    for (int i = 0; i < 5; i++) {
+        protos[i] = Object_New(sizeof(object_t), NULL, NULL);
+        if (i > 0) Object_SetPrototype(protos[i], protos[i - 1]);
+        GC_AddHandle(&protos[i]);
+    }
+    Object_SetField(protos[0], hello, nanbox_from_int(0));
+    object = Object_New(sizeof(object_t), NULL, NULL);
+    Object_SetPrototype(object, protos[4]);
+    GC_AddHandle(&object);
+    assert_int_equal(0, nanbox_to_int(Object_GetField(object, hello)));
+    assert_int_equal(0, nanbox_to_int(Object_GetField(object, hello)));
+
+    // the cached lookup sees the changes of the prototypes
+    Object_SetField(protos[2], hello, nanbox_from_int(2));
+    assert_int_equal(2, nanbox_to_int(Object_GetField(object, hello)));
+    Object_SetPrototype(protos[3], protos[0]);
+    assert_int_equal(0, nanbox_to_int(Object_GetField(object, hello)));
+    Object_SetField(protos[0], hello, nanbox_from_int(10));
+    assert_int_equal(10, nanbox_to_int(Object_GetField(object, hello)));
+
+    // and the prototypes moved by the collector
+    GC_CollectYoung();
+    Object_SetField(protos[0], hello, nanbox_from_int(20));
+    assert_int_equal(20, nanbox_to_int(Object_GetField(object, hello)));
+
+    // the objects of the same shape with other prototypes don't share the result
+    other = Object_New(sizeof(object_t), NULL, NULL);
+    Object_SetPrototype(other, protos[2]);
+    assert_int_equal(2, nanbox_to_int(Object_GetField(other, hello)));
+    assert_int_equal(20, nanbox_to_int(Object_GetField(object, hello)));
+    assert_true(nanbox_is_null(Object_GetField(object, Symbol_Intern("world"))));
+
+    GC_RemoveHandle(&object);
+    for (int i = 0; i < 5; i++) {
+        GC_RemoveHandle(&protos[i]);
+    }
+    GC_Collect();
+    assert_int_equal(objects_count, GC_GetObjectsCount());
 }
 
 /**
@@ -88,5 +140,6 @@ void Test_ObjectTests(void) {
     run_test(Test_SimpleFieldAccess);
     run_test(Test_FieldAccessViaPrototype);
     run_test(Test_PrototypeFieldValueOverride);
+    run_test(Test_CachedPrototypeLookup);
     test_fixture_end();
 }
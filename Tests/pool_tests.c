@@ -0,0 +1,95 @@
+/**
+ * @file pool_tests.c
+ * Pool allocator tests
+ */
+#include "seatest.h"
+#include "pool.h"
+#include "vector.h"
+
+/**
+ * Tests that the blocks are recycled by size class
+ */
+void Test_PoolAllocation(void) {
+    pool_t pool = POOL_INITIALIZER("test");
+    void * a, * b, * c;
+    pool_stats_t stats;
+
+    a = Pool_AllocBlock(&pool, 24);
+    b = Pool_AllocBlock(&pool, 20);
+    assert_true(a != b);
+    stats = Pool_GetStats(&pool);
+    assert_int_equal(2, stats.live_blocks);
+    assert_int_equal(44, stats.live_bytes);
+
+    // a freed block is reused for the sizes of its class
+    Pool_FreeBlock(&pool, a, 24);
+    c = Pool_AllocBlock(&pool, 17);
+#ifndef POOL_MALLOC
+    assert_true(a == c);
+    assert_int_equal(1, Pool_GetStats(&pool).slabs);
+#endif
+
+    // the big blocks don't belong to a size class
+    a = Pool_AllocBlock(&pool, POOL_MAX_BLOCK_SIZE + 1);
+    stats = Pool_GetStats(&pool);
+    assert_int_equal(4, stats.allocations);
+    assert_int_equal(3, stats.live_blocks);
+    assert_int_equal(1, stats.large_blocks);
+    Pool_FreeBlock(&pool, a, POOL_MAX_BLOCK_SIZE + 1);
+    Pool_FreeBlock(&pool, b, 20);
+    Pool_FreeBlock(&pool, c, 17);
+    stats = Pool_GetStats(&pool);
+    assert_int_equal(0, stats.live_blocks);
+    assert_int_equal(0, stats.live_bytes);
+    assert_int_equal(0, stats.large_blocks);
+    Pool_Clear(&pool);
+    assert_int_equal(0, Pool_GetStats(&pool).slabs);
+}
+
+/**
+ * Tests that the pool grows by slabs
+ */
+void Test_PoolSlabs(void) {
+    pool_t pool = POOL_INITIALIZER("test");
+    void * blocks[1000];
+
+    for (int i = 0; i < 1000; i++) {
+        blocks[i] = Pool_AllocBlock(&pool, 64);
+        *(int *)blocks[i] = i;
+    }
+    for (int i = 0; i < 1000; i++) {
+        assert_int_equal(i, *(int *)blocks[i]);
+    }
+#ifndef POOL_MALLOC
+    // 64000 bytes don't fit in 3 slabs of 16KB
+    assert_int_equal(4, Pool_GetStats(&pool).slabs);
+#endif
+    for (int i = 0; i < 1000; i++) {
+        Pool_FreeBlock(&pool, blocks[i], 64);
+    }
+    assert_int_equal(0, Pool_GetStats(&pool).live_blocks);
+    Pool_Clear(&pool);
+}
+
+/**
+ * Tests that the vectors are allocated from their pool
+ */
+void Test_PoolSubsystems(void) {
+    size_t live_blocks = Pool_GetStats(&vector_pool).live_blocks;
+    vector_t * vector = Vec_New();
+
+    assert_int_equal(live_blocks + 1, Pool_GetStats(&vector_pool).live_blocks);
+    Vec_Free(vector);
+    assert_int_equal(live_blocks, Pool_GetStats(&vector_pool).live_blocks);
+}
+
+/**
+ * Runs all the pool allocator tests
+ */
+void Test_PoolTests(void) {
+    test_fixture_start();
+    run_test(Test_PoolAllocation);
+    run_test(Test_PoolSlabs);
+    run_test(Test_PoolSubsystems);
+    test_fixture_end();
+}
@@ -0,0 +1,96 @@
+/**
+ * @file shape_tests.c
+ * Hidden classes tests
+ */
+#include <stdio.h>
+#include "seatest.h"
+#include "nanbox.h"
+#include "symbol.h"
+#include "object.h"
+#include "shape.h"
+#include "gc.h"
+#include "vector.h"
+
+void Test_ShapeTransitions(void) {
+    shape_t * root = Shape_Root();
+    shape_t * a = Shape_AddField(root, Symbol_Intern("a"));
+    shape_t * ab = Shape_AddField(a, Symbol_Intern("b"));
+    shape_t * a2 = Shape_AddField(root, Symbol_Intern("a"));
+    shape_t * b = Shape_AddField(root, Symbol_Intern("b"));
+
+    // the same fields added in the same order give the same shape
+    assert_true(a == a2);
+    assert_true(a != b);
+    assert_int_equal(0, root->fields_count);
+    assert_int_equal(2, ab->fields_count);
+
+    assert_int_equal(0, Shape_Lookup(ab, Symbol_Intern("a")));
+    assert_int_equal(1, Shape_Lookup(ab, Symbol_Intern("b")));
+    assert_int_equal(-1, Shape_Lookup(ab, Symbol_Intern("c")));
+    assert_int_equal(0, Shape_Lookup(b, Symbol_Intern("b")));
+
+    Shape_DecRef(b);
+    Shape_DecRef(a2);
+    Shape_DecRef(ab);
+    Shape_DecRef(a);
+    // unused shapes leave the transition tree
+    assert_false(HashMap_Contains(root->transitions, Symbol_Intern("a")));
+}
+
+void Test_ShapeLargeObject(void) {
+    nanbox_t object = Object_New(sizeof(object_t), NULL, NULL);
+    object_t * object_ptr = nanbox_to_pointer(object);
+    char name[16];
+    vector_t * names;
+
+    // more fields than the inline slots and than the linear lookup limit
+    for (int i = 0; i < 20; i++) {
+        snprintf(name, 16, "f%d", i);
+        Object_SetField(object, Symbol_Intern(name), nanbox_from_int(i));
+    }
+    assert_int_equal(20, object_ptr->shape->fields_count);
+    assert_true(object_ptr->slots != object_ptr->inline_slots);
+    for (int i = 0; i < 20; i++) {
+        snprintf(name, 16, "f%d", i);
+        assert_int_equal(i, Shape_Lookup(object_ptr->shape, Symbol_Intern(name)));
+        assert_int_equal(i, nanbox_to_int(Object_GetField(object, Symbol_Intern(name))));
+    }
+
+    names = Shape_GetNames(object_ptr->shape);
+    assert_int_equal(20, Vec_GetLength(names));
+    assert_string_equal("f0", nanbox_to_pointer(Vec_GetAt(names, 0)));
+    assert_string_equal("f19", nanbox_to_pointer(Vec_GetAt(names, 19)));
+    Vec_Free(names);
+
+    GC_Collect();
+}
+
+void Test_ShapeSharedByObjects(void) {
+    nanbox_t o1 = Object_New(sizeof(object_t), NULL, NULL);
+    nanbox_t o2 = Object_New(sizeof(object_t), NULL, NULL);
+
+    Object_SetField(o1, Symbol_Intern("x"), nanbox_from_int(1));
+    Object_SetField(o1, Symbol_Intern("y"), nanbox_from_int(2));
+    Object_SetField(o2, Symbol_Intern("x"), nanbox_from_int(3));
+    Object_SetField(o2, Symbol_Intern("y"), nanbox_from_int(4));
+    assert_true(((object_t *)nanbox_to_pointer(o1))->shape == ((object_t *)nanbox_to_pointer(o2))->shape);
+
+    // updating a field keeps the shape
+    Object_SetField(o2, Symbol_Intern("x"), nanbox_from_int(5));
+    assert_true(((object_t *)nanbox_to_pointer(o1))->shape == ((object_t *)nanbox_to_pointer(o2))->shape);
+    assert_int_equal(5, nanbox_to_int(Object_GetField(o2, Symbol_Intern("x"))));
+    assert_int_equal(1, nanbox_to_int(Object_GetField(o1, Symbol_Intern("x"))));
+
+    GC_Collect();
+}
+
+/**
+ * Runs all hidden classes tests
+ */
+void Test_ShapeTests(void) {
+    test_fixture_start();
+    run_test(Test_ShapeTransitions);
+    run_test(Test_ShapeLargeObject);
+    run_test(Test_ShapeSharedByObjects);
+    test_fixture_end();
+}
@@ -0,0 +1,49 @@
+/**
+ * @file symbol_tests.c
+ * Symbols table tests
+ */
+#include <stdio.h>
+#include <string.h>
+#include "seatest.h"
+#include "symbol.h"
+
+void Test_SymbolIntern(void) {
+    char buf[16] = "set:to";
+    char * symbol = Symbol_Intern("set:to");
+    size_t count = Symbol_Count();
+
+    // equal names give the same symbol, even from another buffer
+    assert_true(symbol == Symbol_Intern(buf));
+    assert_true(symbol != buf);
+    assert_string_equal("set:to", symbol);
+    assert_true(symbol != Symbol_Intern("set:"));
+    assert_int_equal(count + 1, Symbol_Count());
+
+    assert_true(Symbol_Hash(symbol) == Symbol_HashString("set:to"));
+}
+
+void Test_SymbolTableGrowth(void) {
+    char name[16];
+    char * symbols[1000];
+
+    // symbols survive the growth of the table
+    for (int i = 0; i < 1000; i++) {
+        snprintf(name, 16, "sym%d", i);
+        symbols[i] = Symbol_Intern(name);
+    }
+    for (int i = 0; i < 1000; i++) {
+        snprintf(name, 16, "sym%d", i);
+        assert_true(symbols[i] == Symbol_Intern(name));
+        assert_string_equal(name, symbols[i]);
+    }
+}
+
+/**
+ * Runs all symbols table tests
+ */
+void Test_SymbolTests(void) {
+    test_fixture_start();
+    run_test(Test_SymbolIntern);
+    run_test(Test_SymbolTableGrowth);
+    test_fixture_end();
+}
@@ -8,10 +8,15 @@
 #include "lexer_tests.h"
 #include "parser_tests.h"
 #include "str_tests.h"
+#include "symbol_tests.h"
 #include "hashmap_tests.h"
+#include "pool_tests.h"
 #include "object_tests.h"
+#include "shape_tests.h"
 #include "arrayobject_tests.h"
-#include "object_tracker_tests.h"
+#include "gc_tests.h"
+#include "compiler_tests.h"
+#include "interpreter_tests.h"
 
 /**
  * Runs all tests
@@ -22,10 +27,15 @@ void Test_AllTests(void) {
     Test_LexerTests();
     Test_ParserTests();
     Test_StringTests();
+    Test_SymbolTests();
     Test_HashMapTests();
+    Test_PoolTests();
     Test_ObjectTests();
+    Test_ShapeTests();
     Test_ArrayObjectTests();
-    Test_ObjectTrackerTests();
+    Test_GCTests();
+    Test_CompilerTests();
+    Test_InterpreterTests();
 }
 
 /**